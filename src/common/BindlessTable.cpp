@@ -0,0 +1,174 @@
+// BindlessTable.cpp
+// Descriptor-indexing table of buffers and textures addressed by integer handles
+
+#include "BindlessTable.h"
+#include "DeviceManager.h"
+#include "FrameTracker.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace common
+{
+
+BindlessTable::BindlessTable(IDeviceManager& deviceManager, uint32_t capacity)
+    : m_deviceManager(deviceManager)
+    , m_device(deviceManager.getDevice())
+    , m_capacity(capacity)
+{
+    if (!m_deviceManager.isBindlessSupported())
+    {
+        std::cerr << "[BindlessTable] The device does not support descriptor indexing" << std::endl;
+        return;
+    }
+
+    nvrhi::BindlessLayoutDesc layoutDesc;
+    layoutDesc.setVisibility(nvrhi::ShaderType::All)
+        .setFirstSlot(0)
+        .setMaxCapacity(capacity)
+        .addRegisterSpace(nvrhi::BindingLayoutItem::RawBuffer_SRV(BufferSpace))
+        .addRegisterSpace(nvrhi::BindingLayoutItem::Texture_SRV(TextureSpace));
+
+    m_layout = m_device->createBindlessLayout(layoutDesc);
+    if (m_layout)
+    {
+        m_table = m_device->createDescriptorTable(m_layout);
+    }
+    if (!m_table)
+    {
+        std::cerr << "[BindlessTable] Failed to create a " << capacity << " entry descriptor table" << std::endl;
+        m_layout = nullptr;
+        return;
+    }
+
+    m_device->resizeDescriptorTable(m_table, capacity, false);
+    m_resources.resize(capacity);
+    m_stats.capacity = capacity;
+}
+
+BindlessTable::~BindlessTable()
+{
+    // Owners wait for the device first
+    clear();
+}
+
+uint32_t BindlessTable::write(nvrhi::IResource* resource, const nvrhi::BindingSetItem& item)
+{
+    uint32_t index;
+    if (!m_freeIndices.empty())
+    {
+        index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+    }
+    else if (m_nextIndex < m_capacity)
+    {
+        index = m_nextIndex++;
+    }
+    else
+    {
+        std::cerr << "[BindlessTable] All " << m_capacity << " entries are in use" << std::endl;
+        return InvalidIndex;
+    }
+
+    nvrhi::BindingSetItem slotItem = item;
+    slotItem.slot = index;
+    if (!m_device->writeDescriptorTable(m_table, slotItem))
+    {
+        std::cerr << "[BindlessTable] Failed to write entry " << index << std::endl;
+        m_freeIndices.push_back(index);
+        return InvalidIndex;
+    }
+
+    m_resources[index] = resource;
+    m_stats.allocated++;
+    m_stats.peakAllocated = std::max(m_stats.peakAllocated, m_stats.allocated);
+    m_stats.writes++;
+    return index;
+}
+
+uint32_t BindlessTable::addBuffer(nvrhi::IBuffer* buffer)
+{
+    if (!buffer || !m_table)
+        return InvalidIndex;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return write(buffer, nvrhi::BindingSetItem::RawBuffer_SRV(0, buffer));
+}
+
+uint32_t BindlessTable::addTexture(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources)
+{
+    if (!texture || !m_table)
+        return InvalidIndex;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return write(texture, nvrhi::BindingSetItem::Texture_SRV(0, texture, nvrhi::Format::UNKNOWN, subresources));
+}
+
+void BindlessTable::release(uint32_t index)
+{
+    if (index >= m_capacity)
+        return;
+
+    uint64_t frameId = m_deviceManager.getFrameTracker().getReleaseFrameId();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_resources[index])
+        return;
+
+    PendingFree pending;
+    pending.frameId = frameId;
+    pending.index = index;
+    pending.resource = std::move(m_resources[index]);
+    m_pendingFrees.push_back(std::move(pending));
+    m_stats.pendingFrees++;
+}
+
+void BindlessTable::recycle(std::vector<PendingFree>& pending)
+{
+    // Final releases can be slow, so they happen outside the lock
+    for (PendingFree& entry : pending)
+    {
+        entry.resource = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const PendingFree& entry : pending)
+    {
+        m_freeIndices.push_back(entry.index);
+    }
+    m_stats.allocated -= static_cast<uint32_t>(pending.size());
+    m_stats.pendingFrees -= static_cast<uint32_t>(pending.size());
+}
+
+void BindlessTable::update()
+{
+    std::vector<PendingFree> retired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_deviceManager.getFrameTracker().collectRetired(m_pendingFrees, retired);
+    }
+
+    if (!retired.empty())
+        recycle(retired);
+}
+
+void BindlessTable::clear()
+{
+    std::vector<PendingFree> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.assign(std::make_move_iterator(m_pendingFrees.begin()), std::make_move_iterator(m_pendingFrees.end()));
+        m_pendingFrees.clear();
+    }
+
+    if (!pending.empty())
+        recycle(pending);
+}
+
+BindlessTable::Stats BindlessTable::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace common
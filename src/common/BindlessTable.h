@@ -0,0 +1,101 @@
+// BindlessTable.h
+// Descriptor-indexing table of buffers and textures addressed by integer handles
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // One large descriptor table that shaders index with integer handles, so draws need
+    // no binding set of their own and can be merged freely. Buffers are raw SRVs in
+    // register space BufferSpace (ByteAddressBuffer[]) and textures SRVs in TextureSpace
+    // (Texture2D[]); both share one index space, so an index names a single resource.
+    // On Vulkan the table is the descriptor set at the layout's position in the pipeline's
+    // binding layouts, with buffers at binding 0 and textures at binding 1.
+    //
+    // The table is created at full capacity and never resized, so descriptors never move
+    // under in-flight frames. Slots come from a free list; a released slot keeps its
+    // resource alive and is not reused until the frame being recorded has retired, since
+    // earlier frames may still read the descriptor. All methods are thread-safe.
+    class BindlessTable
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+        static constexpr uint32_t BufferSpace = 1;
+        static constexpr uint32_t TextureSpace = 2;
+        static constexpr uint32_t DefaultCapacity = 8192;
+
+        struct Stats
+        {
+            uint32_t capacity = 0;
+            uint32_t allocated = 0;         // Live and pending slots
+            uint32_t peakAllocated = 0;
+            uint32_t pendingFrees = 0;
+            uint64_t writes = 0;            // Descriptors written since creation
+        };
+
+        explicit BindlessTable(IDeviceManager& deviceManager, uint32_t capacity = DefaultCapacity);
+        ~BindlessTable();
+
+        BindlessTable(const BindlessTable&) = delete;
+        BindlessTable& operator=(const BindlessTable&) = delete;
+
+        // False if the device has no descriptor indexing or creation failed
+        bool isValid() const { return m_table != nullptr; }
+
+        // Returns the shader index, or InvalidIndex for null resources and a full table.
+        // Buffers need canHaveRawViews.
+        uint32_t addBuffer(nvrhi::IBuffer* buffer);
+        uint32_t addTexture(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources = nvrhi::AllSubresources);
+
+        // The caller may drop its own handle afterwards
+        void release(uint32_t index);
+
+        // Recycle the slots of retired frames; call once per frame
+        void update();
+
+        // Recycle every pending slot immediately; only valid once the device is idle
+        void clear();
+
+        nvrhi::IBindingLayout* getLayout() const { return m_layout; }
+        nvrhi::IDescriptorTable* getDescriptorTable() const { return m_table; }
+        uint32_t getCapacity() const { return m_capacity; }
+        Stats getStats() const;
+
+    private:
+        struct PendingFree
+        {
+            uint64_t frameId = 0;
+            uint32_t index = InvalidIndex;
+            nvrhi::ResourceHandle resource;     // Still referenced by the descriptor
+        };
+
+        uint32_t write(nvrhi::IResource* resource, const nvrhi::BindingSetItem& item);
+        void recycle(std::vector<PendingFree>& pending);
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::DeviceHandle m_device;
+        uint32_t m_capacity = 0;
+        nvrhi::BindingLayoutHandle m_layout;
+        nvrhi::DescriptorTableHandle m_table;
+
+        // Descriptor writes also need the lock: Vulkan requires external synchronization
+        // of the descriptor set for vkUpdateDescriptorSets
+        mutable std::mutex m_mutex;
+        std::vector<nvrhi::ResourceHandle> m_resources;     // Per live slot
+        std::vector<uint32_t> m_freeIndices;                // Most recently freed last
+        uint32_t m_nextIndex = 0;                           // Slots above have never been used
+        std::deque<PendingFree> m_pendingFrees;             // In frame order
+        Stats m_stats;
+    };
+
+} // namespace common
@@ -0,0 +1,62 @@
+// CommandListPool.cpp
+// Per-thread command lists for recording one frame on several threads
+
+#include "CommandListPool.h"
+#include "DeviceManager.h"
+
+namespace common
+{
+
+CommandListPool::CommandListPool(IDeviceManager& deviceManager, nvrhi::CommandQueue queue)
+    : m_deviceManager(deviceManager)
+    , m_queue(queue)
+{
+}
+
+nvrhi::ICommandList* CommandListPool::acquire()
+{
+    ThreadLists* threadLists;
+    {
+        // Map nodes are stable, so the entry can be used after the lock is released;
+        // only the owning thread touches it until reset()
+        std::lock_guard<std::mutex> lock(m_mutex);
+        threadLists = &m_threads[std::this_thread::get_id()];
+    }
+
+    if (threadLists->used == threadLists->commandLists.size())
+    {
+        nvrhi::CommandListParameters params;
+        params.setEnableImmediateExecution(false);
+        params.setQueueType(m_queue);
+
+        nvrhi::CommandListHandle commandList = m_deviceManager.createCommandList(params);
+        if (!commandList)
+            return nullptr;
+
+        threadLists->commandLists.push_back(commandList);
+    }
+
+    return threadLists->commandLists[threadLists->used++].Get();
+}
+
+void CommandListPool::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [threadId, threadLists] : m_threads)
+    {
+        threadLists.used = 0;
+    }
+}
+
+size_t CommandListPool::getCommandListCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto& [threadId, threadLists] : m_threads)
+    {
+        count += threadLists.commandLists.size();
+    }
+    return count;
+}
+
+} // namespace common
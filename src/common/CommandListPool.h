@@ -0,0 +1,51 @@
+// CommandListPool.h
+// Per-thread command lists for recording one frame on several threads
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // Hands out command lists owned by the calling thread. Lists are created with immediate
+    // execution disabled, which NVRHI requires for recording on several threads at once.
+    // Submission order is up to the caller: collect the lists by job index and pass them
+    // to IDeviceManager::executeCommandLists as one batch.
+    class CommandListPool
+    {
+    public:
+        explicit CommandListPool(IDeviceManager& deviceManager,
+            nvrhi::CommandQueue queue = nvrhi::CommandQueue::Graphics);
+
+        // Returns a closed command list for the calling thread, valid until reset()
+        nvrhi::ICommandList* acquire();
+
+        // Make every list available again; call once the frame's lists have been submitted.
+        // NVRHI lets a list be reopened while its previous submission is still in flight.
+        void reset();
+
+        size_t getCommandListCount() const;
+
+    private:
+        struct ThreadLists
+        {
+            std::vector<nvrhi::CommandListHandle> commandLists;
+            size_t used = 0;
+        };
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::CommandQueue m_queue;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::thread::id, ThreadLists> m_threads;
+    };
+
+} // namespace common
@@ -0,0 +1,127 @@
+// DeletionQueue.cpp
+// Deferred resource destruction keyed on GPU completion
+
+#include "DeletionQueue.h"
+#include "FrameTracker.h"
+#include "TextureMemory.h"
+
+#include <iterator>
+#include <iostream>
+
+namespace common
+{
+
+DeletionQueue::DeletionQueue(FrameTracker& frameTracker)
+    : m_frameTracker(frameTracker)
+{
+}
+
+DeletionQueue::~DeletionQueue()
+{
+    // Owners flush or clear before the device goes away; anything left is dropped as is
+    clear();
+}
+
+void DeletionQueue::release(nvrhi::IBuffer* buffer)
+{
+    if (buffer)
+        release(buffer, buffer->getDesc().byteSize);
+}
+
+void DeletionQueue::release(nvrhi::ITexture* texture)
+{
+    if (texture)
+        release(texture, estimateTextureBytes(texture->getDesc()));
+}
+
+void DeletionQueue::release(nvrhi::IResource* resource, uint64_t bytes)
+{
+    if (!resource)
+        return;
+
+    uint64_t frameId = m_frameTracker.getReleaseFrameId();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_batches.empty() || m_batches.back().frameId != frameId)
+    {
+        m_batches.emplace_back();
+        m_batches.back().frameId = frameId;
+    }
+
+    Batch& batch = m_batches.back();
+    batch.resources.push_back(resource);
+    batch.bytes += bytes;
+    m_stats.pendingObjects++;
+    m_stats.pendingBytes += bytes;
+}
+
+void DeletionQueue::freeBatches(std::vector<Batch>& batches)
+{
+    uint64_t objects = 0;
+    uint64_t bytes = 0;
+    for (Batch& batch : batches)
+    {
+        objects += batch.resources.size();
+        bytes += batch.bytes;
+
+        // Final releases can be slow, so they happen outside the lock
+        batch.resources.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.pendingObjects -= objects;
+    m_stats.pendingBytes -= bytes;
+    m_stats.releasedObjects += objects;
+    m_stats.releasedBytes += bytes;
+    m_stats.batches += batches.size();
+}
+
+void DeletionQueue::update()
+{
+    std::vector<Batch> retired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frameTracker.collectRetired(m_batches, retired);
+    }
+
+    if (!retired.empty())
+        freeBatches(retired);
+}
+
+void DeletionQueue::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_batches.empty())
+            return;
+    }
+
+    // Frames that have not ended yet can only have submitted this much so far
+    if (!m_frameTracker.waitForSubmission(m_frameTracker.getLastSubmissionId()))
+    {
+        std::cerr << "[DeletionQueue] No GPU timeline to wait on, keeping pending batches" << std::endl;
+        return;
+    }
+    clear();
+}
+
+void DeletionQueue::clear()
+{
+    std::vector<Batch> batches;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        batches.assign(std::make_move_iterator(m_batches.begin()), std::make_move_iterator(m_batches.end()));
+        m_batches.clear();
+    }
+
+    if (!batches.empty())
+        freeBatches(batches);
+}
+
+DeletionQueue::Stats DeletionQueue::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace common
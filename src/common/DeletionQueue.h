@@ -0,0 +1,80 @@
+// DeletionQueue.h
+// Deferred resource destruction keyed on GPU completion
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace common
+{
+    class FrameTracker;
+
+    // Holds the last reference to released resources until the GPU can no longer be
+    // using them, so a handle can be dropped in the middle of a frame without a device
+    // drain. A release belongs to the frame being recorded (between present() and the
+    // next beginFrame(), the frame about to start), because command lists recorded
+    // earlier in that frame may not have been submitted yet. The frame's final
+    // submission ID is known once it ends; update() frees whole frames in one batch as
+    // soon as the timeline reaches it.
+    //
+    // Byte counts are estimates from the resource descs, for budgeting and statistics.
+    // All methods are thread-safe.
+    class DeletionQueue
+    {
+    public:
+        struct Stats
+        {
+            uint64_t pendingObjects = 0;
+            uint64_t pendingBytes = 0;
+            uint64_t releasedObjects = 0;   // Freed since creation
+            uint64_t releasedBytes = 0;
+            uint64_t batches = 0;           // Frames that freed at least one object
+        };
+
+        explicit DeletionQueue(FrameTracker& frameTracker);
+        ~DeletionQueue();
+
+        DeletionQueue(const DeletionQueue&) = delete;
+        DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+        // The caller drops its own handle afterwards; null resources are ignored
+        void release(nvrhi::IBuffer* buffer);
+        void release(nvrhi::ITexture* texture);
+        void release(nvrhi::IResource* resource, uint64_t bytes = 0);
+
+        // Free every batch whose frame has retired; called by the device manager each frame
+        void update();
+
+        // Block until every pending batch has retired, then free them. Without a GPU
+        // timeline to wait on nothing is freed.
+        void flush();
+
+        // Free everything immediately; only valid once the device is idle
+        void clear();
+
+        Stats getStats() const;
+
+    private:
+        struct Batch
+        {
+            uint64_t frameId = 0;
+            uint64_t bytes = 0;
+            std::vector<nvrhi::ResourceHandle> resources;
+        };
+
+        void freeBatches(std::vector<Batch>& batches);
+
+    private:
+        FrameTracker& m_frameTracker;
+
+        mutable std::mutex m_mutex;
+        std::deque<Batch> m_batches;    // In frame order
+        Stats m_stats;
+    };
+
+} // namespace common
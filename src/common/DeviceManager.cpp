@@ -8,6 +8,9 @@
 #endif
 #include "DeviceManager_VK.h"
 
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
 #include <iostream>
 
 namespace common
@@ -68,4 +71,172 @@ const char* graphicsAPIToString(GraphicsAPI api)
     }
 }
 
+const char* adapterTypeToString(AdapterType type)
+{
+    switch (type)
+    {
+    case AdapterType::Discrete:   return "discrete";
+    case AdapterType::Integrated: return "integrated";
+    case AdapterType::Virtual:    return "virtual";
+    case AdapterType::Software:   return "software";
+    default:                      return "other";
+    }
+}
+
+const char* presentModeToString(PresentMode mode)
+{
+    switch (mode)
+    {
+    case PresentMode::Fifo:        return "FIFO";
+    case PresentMode::FifoRelaxed: return "FIFO_RELAXED";
+    case PresentMode::Mailbox:     return "MAILBOX";
+    case PresentMode::Immediate:   return "IMMEDIATE";
+    default:                       return "Unknown";
+    }
+}
+
+uint64_t MemoryStats::getDeviceLocalBudget() const
+{
+    uint64_t budget = 0;
+    for (const MemoryHeapStats& heap : heaps)
+    {
+        if (heap.deviceLocal)
+            budget += heap.budget;
+    }
+    return budget;
+}
+
+uint64_t MemoryStats::getDeviceLocalUsage() const
+{
+    uint64_t usage = 0;
+    for (const MemoryHeapStats& heap : heaps)
+    {
+        if (heap.deviceLocal)
+            usage += heap.usage;
+    }
+    return usage;
+}
+
+int64_t scoreAdapter(const AdapterInfo& adapter)
+{
+    if (!adapter.unsuitableReason.empty())
+        return -1;
+    
+    // Type dominates; the remaining terms only break ties within a type
+    int64_t score = 0;
+    switch (adapter.type)
+    {
+    case AdapterType::Discrete:   score = 4000; break;
+    case AdapterType::Integrated: score = 3000; break;
+    case AdapterType::Virtual:    score = 2000; break;
+    case AdapterType::Software:   score = 1000; break;
+    default:                      break;
+    }
+    
+    score += std::min<int64_t>(adapter.dedicatedMemory >> 30, 32) * 20;
+    if (adapter.hasComputeQueue)
+        score += 100;
+    if (adapter.hasTransferQueue)
+        score += 100;
+    score += int64_t(adapter.optionalFeatures.size()) * 25;
+    return score;
+}
+
+static std::string toLower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+int selectAdapter(const std::vector<AdapterInfo>& adapters, const DeviceCreationParams& params, GraphicsAPI api)
+{
+    const char* apiName = graphicsAPIToString(api);
+    const std::string preferredName = toLower(params.preferredAdapterName);
+    
+    int selected = -1;
+    for (size_t i = 0; i < adapters.size(); i++)
+    {
+        const AdapterInfo& adapter = adapters[i];
+        std::cout << "[" << apiName << "] Adapter " << adapter.index << ": " << adapter.name
+                  << " (" << adapterTypeToString(adapter.type) << ", " << (adapter.dedicatedMemory >> 20) << " MB, ";
+        if (adapter.unsuitableReason.empty())
+            std::cout << "score " << adapter.score << ")" << std::endl;
+        else
+            std::cout << "unsuitable: " << adapter.unsuitableReason << ")" << std::endl;
+        
+        if (!adapter.unsuitableReason.empty())
+            continue;
+        if (params.preferredAdapterIndex >= 0 && adapter.index != uint32_t(params.preferredAdapterIndex))
+            continue;
+        if (params.preferredAdapterIndex < 0 && !preferredName.empty() &&
+            toLower(adapter.name).find(preferredName) == std::string::npos)
+            continue;
+        
+        // Ties keep enumeration order, which is the platform's own preference
+        if (selected < 0 || adapter.score > adapters[selected].score)
+            selected = int(i);
+    }
+    
+    if (selected < 0)
+    {
+        std::cerr << "[" << apiName << "] No suitable GPU found";
+        if (params.preferredAdapterIndex >= 0)
+            std::cerr << " at adapter index " << params.preferredAdapterIndex;
+        else if (!params.preferredAdapterName.empty())
+            std::cerr << " matching \"" << params.preferredAdapterName << "\"";
+        std::cerr << std::endl;
+    }
+    return selected;
+}
+
+static void writeJsonString(std::ostream& stream, const std::string& text)
+{
+    stream << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+
+void writeAdapterReport(std::ostream& stream, GraphicsAPI api, const std::vector<AdapterInfo>& adapters)
+{
+    stream << "{\"api\": ";
+    writeJsonString(stream, graphicsAPIToString(api));
+    stream << ", \"adapters\": [" << std::endl;
+    for (size_t i = 0; i < adapters.size(); i++)
+    {
+        const AdapterInfo& adapter = adapters[i];
+        stream << "  {\"index\": " << adapter.index << ", \"name\": ";
+        writeJsonString(stream, adapter.name);
+        stream << ", \"type\": \"" << adapterTypeToString(adapter.type) << "\""
+               << ", \"vendorId\": " << adapter.vendorId
+               << ", \"deviceId\": " << adapter.deviceId
+               << ", \"dedicatedMemory\": " << adapter.dedicatedMemory
+               << ", \"computeQueue\": " << (adapter.hasComputeQueue ? "true" : "false")
+               << ", \"transferQueue\": " << (adapter.hasTransferQueue ? "true" : "false")
+               << ", \"features\": [";
+        for (size_t f = 0; f < adapter.optionalFeatures.size(); f++)
+        {
+            if (f > 0)
+                stream << ", ";
+            writeJsonString(stream, adapter.optionalFeatures[f]);
+        }
+        stream << "], \"suitable\": " << (adapter.unsuitableReason.empty() ? "true" : "false");
+        if (!adapter.unsuitableReason.empty())
+        {
+            stream << ", \"reason\": ";
+            writeJsonString(stream, adapter.unsuitableReason);
+        }
+        stream << ", \"score\": " << adapter.score << "}" << (i + 1 < adapters.size() ? "," : "") << std::endl;
+    }
+    stream << "]}" << std::endl;
+}
+
 } // namespace common
@@ -3,11 +3,18 @@
 
 #pragma once
 
+#include "DeletionQueue.h"
+#include "FrameCapture.h"
+#include "FrameLimiter.h"
+#include "FrameTracker.h"
+
 #include <nvrhi/nvrhi.h>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <functional>
 #include <memory>
+#include <span>
 
 struct GLFWwindow;
 
@@ -20,25 +27,152 @@ namespace common
         Vulkan
     };
 
+    // Presentation policy. A mode the surface does not support falls back to the
+    // nearest one that tears no more: IMMEDIATE to MAILBOX, then everything to FIFO.
+    enum class PresentMode
+    {
+        Fifo,         // Vsync; never tears, up to a full queue of latency
+        FifoRelaxed,  // Vsync, but a late frame is shown immediately and may tear
+        Mailbox,      // Newest frame at the next vblank; no tearing, uncapped rendering
+        Immediate     // No vsync; lowest latency, tears
+    };
+
     // Device creation parameters
     struct DeviceCreationParams
     {
-        // Window handle
+        // Window handle (unused in headless mode)
         GLFWwindow* window = nullptr;
         
+        // Render into a ring of offscreen textures instead of a window swap chain.
+        // No window or surface is created, so this runs on display-less machines and
+        // software ICDs such as lavapipe. Vulkan only.
+        bool headless = false;
+        
         // Swap chain settings
         uint32_t swapChainBufferCount = 2;
         uint32_t windowWidth = 1280;
         uint32_t windowHeight = 720;
         nvrhi::Format swapChainFormat = nvrhi::Format::RGBA8_UNORM;
-        bool vsync = true;
+        PresentMode presentMode = PresentMode::Fifo;
+        
+        // Frame rate cap applied at the end of present() (0 = uncapped). Where
+        // VK_KHR_present_wait is available the CPU also waits for the previous frame to
+        // reach the display, so it never queues frames ahead of the screen.
+        uint32_t maxFrameRate = 0;
+        
+        // Frame pacing: number of frames the CPU may queue ahead of the GPU.
+        // beginFrame() blocks only on the frame this many frames back, so 1
+        // reproduces a full stall after every frame.
+        uint32_t maxFramesInFlight = 2;
         
         // Debug settings
         bool enableDebugLayer = true;
         bool enableValidationLayer = true;
         
-        // Device selection (use first suitable device if empty)
+        // Device selection: an index from enumerateAdapters() wins over a name, which
+        // matches any adapter whose name contains it (case-insensitive). With neither,
+        // the highest scoring adapter is used. A preference nothing satisfies fails
+        // device creation rather than silently picking another GPU.
         std::string preferredAdapterName;
+        int preferredAdapterIndex = -1;
+        
+        // Directory for the persistent pipeline cache (disabled if empty). Vulkan only;
+        // the file is keyed on device UUID and driver version.
+        std::string pipelineCacheDirectory;
+    };
+
+    enum class AdapterType
+    {
+        Discrete,
+        Integrated,
+        Virtual,
+        Software,
+        Other
+    };
+
+    // A GPU as seen by a backend, and the score used to choose between several
+    struct AdapterInfo
+    {
+        uint32_t index = 0;  // Enumeration order, as used by preferredAdapterIndex
+        std::string name;
+        AdapterType type = AdapterType::Other;
+        uint32_t vendorId = 0;
+        uint32_t deviceId = 0;
+        uint64_t dedicatedMemory = 0;  // Largest device-local heap in bytes
+        bool hasComputeQueue = false;  // Queues that run asynchronously to graphics
+        bool hasTransferQueue = false;
+        std::vector<std::string> optionalFeatures;
+        std::string unsuitableReason;  // Empty if a device can be created on it
+        int64_t score = -1;
+    };
+
+    // One memory heap. The budget is how much this process can use before the OS starts
+    // evicting or allocations start failing; it shrinks as other applications allocate.
+    struct MemoryHeapStats
+    {
+        uint64_t size = 0;
+        uint64_t budget = 0;
+        uint64_t usage = 0;
+        bool deviceLocal = false;
+    };
+
+    struct MemoryStats
+    {
+        std::vector<MemoryHeapStats> heaps;
+        bool budgetSupported = false;  // Otherwise budgets are heap sizes and usage is unknown (0)
+        
+        // Totals over the device-local heaps
+        uint64_t getDeviceLocalBudget() const;
+        uint64_t getDeviceLocalUsage() const;
+    };
+
+    using MemoryBudgetCallback = std::function<void(const MemoryStats&)>;
+
+    // Application hooks around device recreation. onDeviceLost must drop every handle
+    // created from the old device (NVRHI objects, command lists, services holding them);
+    // onDeviceRestored recreates them on the new device and returns false if it cannot.
+    struct DeviceRecoveryCallbacks
+    {
+        std::function<void()> onDeviceLost;
+        std::function<bool()> onDeviceRestored;
+    };
+
+    struct DeviceRecoveryStats
+    {
+        uint32_t deviceLostCount = 0;
+        uint32_t recoveredCount = 0;
+        double lastRecoveryTimeMs = 0.0;   // Callbacks included
+        double totalRecoveryTimeMs = 0.0;
+    };
+
+    // A window's swap chain. The device manager owns a primary one, which its own getters
+    // forward to; createWindowSwapChain() adds more windows that share the device and
+    // graphics queue. beginFrame() acquires a back buffer on every swap chain and
+    // present() presents them all at once.
+    class ISwapChain
+    {
+    public:
+        virtual ~ISwapChain() = default;
+        
+        virtual GLFWwindow* getWindow() const = 0;
+        
+        // False if no back buffer could be acquired this frame (e.g. a minimized window);
+        // the application skips rendering to it and it is not presented
+        virtual bool isAcquired() const = 0;
+        
+        virtual nvrhi::IFramebuffer* getCurrentFramebuffer() const = 0;
+        virtual nvrhi::ITexture* getCurrentBackBuffer() const = 0;
+        virtual uint32_t getCurrentBackBufferIndex() const = 0;
+        virtual uint32_t getBackBufferCount() const = 0;
+        virtual uint32_t getWidth() const = 0;
+        virtual uint32_t getHeight() const = 0;
+        virtual nvrhi::Format getFormat() const = 0;
+        virtual PresentMode getPresentMode() const = 0;
+        
+        // Swap chains that went out of date are recreated at acquire; this is for
+        // applications that track the window size themselves. Returns false if the swap
+        // chain was left without buffers, after which it is never acquired again.
+        virtual bool resize(uint32_t width, uint32_t height) = 0;
     };
 
     // Message callback for NVRHI errors and warnings
@@ -63,6 +197,12 @@ namespace common
         virtual void destroySwapChain() = 0;
         virtual bool resizeSwapChain(uint32_t width, uint32_t height) = 0;
         
+        // Additional windows rendered with the same device. The swap chain uses the
+        // primary one's present mode and buffer count, survives device recovery, and
+        // must be destroyed before its window. Returns null on failure or in headless mode.
+        virtual ISwapChain* createWindowSwapChain(GLFWwindow* window) = 0;
+        virtual void destroyWindowSwapChain(ISwapChain* swapChain) = 0;
+        
         // Frame management
         virtual void beginFrame() = 0;
         virtual void present() = 0;
@@ -71,11 +211,77 @@ namespace common
         virtual nvrhi::IDevice* getDevice() const = 0;
         virtual nvrhi::IFramebuffer* getCurrentFramebuffer() const = 0;
         virtual nvrhi::ITexture* getCurrentBackBuffer() const = 0;
-        virtual nvrhi::CommandListHandle createCommandList() const = 0;
-        virtual void executeCommandList(nvrhi::ICommandList* commandList) = 0;
+        // False if the primary swap chain could not acquire a back buffer this frame
+        virtual bool isBackBufferAcquired() const = 0;
+        virtual nvrhi::CommandListHandle createCommandList(
+            const nvrhi::CommandListParameters& params = nvrhi::CommandListParameters()) const = 0;
+        virtual uint64_t executeCommandList(nvrhi::ICommandList* commandList) = 0;  // Returns the submission ID
+        
+        // Submit several closed command lists in order as a single queue submission. The lists
+        // must be created for that queue. Graphics submission IDs are FrameTracker values;
+        // other queues return IDs on their own timeline, so a frame only covers compute or
+        // copy work that the graphics queue waited for.
+        virtual uint64_t executeCommandLists(std::span<nvrhi::ICommandList* const> commandLists,
+            nvrhi::CommandQueue queue = nvrhi::CommandQueue::Graphics) = 0;
+        
+        // Later submissions on waitQueue wait on the GPU for a submission on executionQueue
+        virtual void queueWaitForSubmission(nvrhi::CommandQueue waitQueue,
+            nvrhi::CommandQueue executionQueue, uint64_t submissionId) = 0;
+        
+        // Without a dedicated queue, command lists and submissions for that queue are
+        // redirected to the graphics queue and cross-queue waits become no-ops
+        virtual bool hasDedicatedQueue(nvrhi::CommandQueue queue) const = 0;
         virtual void waitForIdle() = 0;
         virtual void runGarbageCollection() = 0;
         
+        // Frame/submission IDs on the GPU timeline; resources keyed on these can be
+        // recycled as soon as their frame retires instead of after a device drain
+        virtual FrameTracker& getFrameTracker() = 0;
+        
+        // Resources released here are freed once the frame being recorded retires;
+        // updated from beginFrame()
+        virtual DeletionQueue& getDeletionQueue() = 0;
+        
+        // Asynchronous back buffer readback to PNG/EXR, recorded at present()
+        virtual FrameCapture& getFrameCapture() = 0;
+        
+        // Frame rate cap, adjustable at runtime
+        virtual FrameLimiter& getFrameLimiter() = 0;
+        
+        // The mode actually in use after fallback
+        virtual PresentMode getPresentMode() const = 0;
+        
+        // Per-heap usage and budget, queried from the driver on each call
+        virtual MemoryStats getMemoryStats() = 0;
+        
+        // Called from beginFrame() with fresh stats, so streaming systems can shed
+        // resources before allocations fail. An empty callback turns the query off.
+        virtual void setMemoryBudgetCallback(MemoryBudgetCallback callback) = 0;
+        
+        // Device loss (VK_ERROR_DEVICE_LOST, DXGI device removal or reset) is detected at
+        // acquire, present and GPU waits. The next beginFrame() destroys and recreates the
+        // device and swap chain with the original params, calling the recovery callbacks
+        // around it. If that fails the device stays lost, beginFrame() returns early and
+        // retries on the next call, so the application should check isDeviceLost() after it.
+        virtual void setDeviceRecoveryCallbacks(DeviceRecoveryCallbacks callbacks) = 0;
+        virtual bool isDeviceLost() const = 0;
+        virtual DeviceRecoveryStats getDeviceRecoveryStats() const = 0;
+        
+        // Fault injection: the next present() reports a device loss, exercising the full
+        // recovery path without a real driver reset
+        virtual void simulateDeviceLost() = 0;
+        
+        // True if pipelines are being created against a cache loaded from disk
+        virtual bool isPipelineCacheWarm() const = 0;
+        
+        // Descriptor indexing for bindless tables: Vulkan 1.2 runtime descriptor arrays with
+        // update-after-bind, or D3D12 resource binding tier 2
+        virtual bool isBindlessSupported() const = 0;
+        
+        // Every adapter the backend can see, scored for the current creation params. Can be
+        // called before createDevice(); presentation support is only checked after it.
+        virtual std::vector<AdapterInfo> enumerateAdapters() = 0;
+        
         virtual uint32_t getCurrentBackBufferIndex() const = 0;
         virtual uint32_t getBackBufferCount() const = 0;
         virtual uint32_t getWindowWidth() const = 0;
@@ -95,5 +301,18 @@ namespace common
     
     // Convert API enum to string
     const char* graphicsAPIToString(GraphicsAPI api);
+    const char* adapterTypeToString(AdapterType type);
+    const char* presentModeToString(PresentMode mode);
+    
+    // Rank an adapter by type, then memory, asynchronous queues and optional features.
+    // Unsuitable adapters score -1.
+    int64_t scoreAdapter(const AdapterInfo& adapter);
+    
+    // Apply the adapter preference in params, logging every candidate. Returns the
+    // position of the chosen adapter in adapters, or -1.
+    int selectAdapter(const std::vector<AdapterInfo>& adapters, const DeviceCreationParams& params, GraphicsAPI api);
+    
+    // One JSON object per adapter inside a JSON document, for scripts and CI logs
+    void writeAdapterReport(std::ostream& stream, GraphicsAPI api, const std::vector<AdapterInfo>& adapters);
 
 } // namespace common
@@ -7,10 +7,10 @@
 #include <nvrhi/common/resource.h>
 
 #include <GLFW/glfw3.h>
-#define GLFW_EXPOSE_NATIVE_WIN32
-#include <GLFW/glfw3native.h>
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 
 namespace common
 {
@@ -20,21 +20,17 @@ DeviceManager_D3D12::DeviceManager_D3D12() = default;
 DeviceManager_D3D12::~DeviceManager_D3D12()
 {
     destroyDevice();
+    m_windowSwapChains.clear();
 }
 
 bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
 {
     m_params = params;
     m_window = params.window;
-    m_windowWidth = params.windowWidth;
-    m_windowHeight = params.windowHeight;
-    m_swapChainFormat = params.swapChainFormat;
     
-    // Get native window handle
-    m_hwnd = glfwGetWin32Window(m_window);
-    if (!m_hwnd)
+    if (params.headless)
     {
-        std::cerr << "[D3D12] Failed to get Win32 window handle" << std::endl;
+        std::cerr << "[D3D12] Headless mode is only supported by the Vulkan backend" << std::endl;
         return false;
     }
     
@@ -60,29 +56,14 @@ bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
     }
     
     // Find a suitable adapter
-    for (UINT i = 0; m_dxgiFactory->EnumAdapterByGpuPreference(i, DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE,
-         IID_PPV_ARGS(&m_adapter)) != DXGI_ERROR_NOT_FOUND; i++)
-    {
-        DXGI_ADAPTER_DESC1 desc;
-        m_adapter->GetDesc1(&desc);
-        
-        // Skip software adapters
-        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
-            continue;
-        
-        // Check if adapter supports D3D12
-        if (SUCCEEDED(D3D12CreateDevice(m_adapter.Get(), D3D_FEATURE_LEVEL_12_0, _uuidof(ID3D12Device), nullptr)))
-        {
-            std::wcout << L"[D3D12] Using GPU: " << desc.Description << std::endl;
-            break;
-        }
-    }
-    
-    if (!m_adapter)
-    {
-        std::cerr << "[D3D12] No suitable GPU adapter found" << std::endl;
+    std::vector<Microsoft::WRL::ComPtr<IDXGIAdapter1>> dxgiAdapters;
+    std::vector<AdapterInfo> adapters = queryAdapters(m_dxgiFactory.Get(), dxgiAdapters);
+    int selected = selectAdapter(adapters, m_params, GraphicsAPI::D3D12);
+    if (selected < 0)
         return false;
-    }
+    
+    m_adapter = dxgiAdapters[selected];
+    std::cout << "[D3D12] Using GPU: " << adapters[selected].name << std::endl;
     
     // Create D3D12 device
     if (FAILED(D3D12CreateDevice(m_adapter.Get(), D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&m_d3d12Device))))
@@ -91,6 +72,11 @@ bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
         return false;
     }
     
+    // Tier 1 caps shader-visible SRVs per stage far below a bindless table
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    m_d3d12Device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+    m_bindlessSupported = options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2;
+    
     // Create command queue
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
@@ -103,6 +89,21 @@ bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
         return false;
     }
     
+    // Async compute and copy queues; every D3D12 device supports both
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    if (FAILED(m_d3d12Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_computeQueue))))
+    {
+        std::cerr << "[D3D12] Failed to create compute queue" << std::endl;
+        return false;
+    }
+    
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    if (FAILED(m_d3d12Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_copyQueue))))
+    {
+        std::cerr << "[D3D12] Failed to create copy queue" << std::endl;
+        return false;
+    }
+    
     // Create fence for synchronization
     if (FAILED(m_d3d12Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
     {
@@ -122,6 +123,8 @@ bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
     deviceDesc.errorCB = &m_messageCallback;
     deviceDesc.pDevice = m_d3d12Device.Get();
     deviceDesc.pGraphicsCommandQueue = m_commandQueue.Get();
+    deviceDesc.pComputeCommandQueue = m_computeQueue.Get();
+    deviceDesc.pCopyCommandQueue = m_copyQueue.Get();
     
     m_nvrhiDevice = nvrhi::d3d12::createDevice(deviceDesc);
     if (!m_nvrhiDevice)
@@ -141,22 +144,154 @@ bool DeviceManager_D3D12::createDevice(const DeviceCreationParams& params)
         m_device = m_nvrhiDevice;
     }
     
+    // Track frames on our own fence; every submission through this manager signals it
+    m_frameTracker.setTimeline({
+        [this]()
+        {
+            return m_fence->GetCompletedValue();
+        },
+        [this](uint64_t value)
+        {
+            // A null event blocks until the fence is reached and is safe from any thread.
+            // A removed device reports every fence as complete (UINT64_MAX).
+            uint64_t completed = m_fence->GetCompletedValue();
+            if (completed == UINT64_MAX)
+                checkDeviceRemoved(DXGI_ERROR_DEVICE_REMOVED, "a fence wait");
+            else if (completed < value)
+                m_fence->SetEventOnCompletion(value, nullptr);
+        }
+    });
+    
+    // Captured frames are mapped once their slot comes around again, so keep one
+    // more slot than frames in flight
+    m_frameCapture.setRingSize(m_params.maxFramesInFlight + 1);
+    m_frameLimiter.setTargetFrameRate(m_params.maxFrameRate);
+    
     // Create swap chain
     if (!createSwapChain())
     {
         return false;
     }
     
+    // Windows that outlived a previous device (recovery) get new swap chains
+    for (const std::unique_ptr<SwapChain_D3D12>& swapChain : m_windowSwapChains)
+    {
+        if (!swapChain->create())
+            return false;
+    }
+    
     std::cout << "[D3D12] Device created successfully" << std::endl;
     return true;
 }
 
+std::vector<AdapterInfo> DeviceManager_D3D12::queryAdapters(IDXGIFactory6* factory,
+    std::vector<Microsoft::WRL::ComPtr<IDXGIAdapter1>>& dxgiAdapters)
+{
+    std::vector<AdapterInfo> adapters;
+    
+    // High-performance order, so equal scores keep the OS preference
+    Microsoft::WRL::ComPtr<IDXGIAdapter1> dxgiAdapter;
+    for (UINT i = 0; factory->EnumAdapterByGpuPreference(i, DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE,
+         IID_PPV_ARGS(&dxgiAdapter)) != DXGI_ERROR_NOT_FOUND; i++)
+    {
+        DXGI_ADAPTER_DESC1 desc;
+        dxgiAdapter->GetDesc1(&desc);
+        
+        AdapterInfo adapter;
+        adapter.index = i;
+        adapter.vendorId = desc.VendorId;
+        adapter.deviceId = desc.DeviceId;
+        adapter.dedicatedMemory = desc.DedicatedVideoMemory;
+        
+        char name[256] = {};
+        WideCharToMultiByte(CP_UTF8, 0, desc.Description, -1, name, sizeof(name) - 1, nullptr, nullptr);
+        adapter.name = name;
+        
+        // Every D3D12 device has compute and copy queues
+        adapter.hasComputeQueue = true;
+        adapter.hasTransferQueue = true;
+        
+        Microsoft::WRL::ComPtr<ID3D12Device> device;
+        if (FAILED(D3D12CreateDevice(dxgiAdapter.Get(), D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&device))))
+        {
+            adapter.unsuitableReason = "feature level 12_0 not supported";
+        }
+        else
+        {
+            D3D12_FEATURE_DATA_ARCHITECTURE architecture = {};
+            device->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE, &architecture, sizeof(architecture));
+            
+            if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
+                adapter.type = AdapterType::Software;
+            else
+                adapter.type = architecture.UMA ? AdapterType::Integrated : AdapterType::Discrete;
+            
+            D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+            device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+            if (options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3)
+                adapter.optionalFeatures.push_back("resourceBindingTier3");
+            if (options.TiledResourcesTier >= D3D12_TILED_RESOURCES_TIER_2)
+                adapter.optionalFeatures.push_back("tiledResourcesTier2");
+            
+            D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = {};
+            device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1));
+            if (options1.WaveOps)
+                adapter.optionalFeatures.push_back("waveOps");
+            if (options1.Int64ShaderOps)
+                adapter.optionalFeatures.push_back("int64ShaderOps");
+        }
+        
+        adapter.score = scoreAdapter(adapter);
+        adapters.push_back(std::move(adapter));
+        dxgiAdapters.push_back(dxgiAdapter);
+    }
+    
+    return adapters;
+}
+
+std::vector<AdapterInfo> DeviceManager_D3D12::enumerateAdapters()
+{
+    std::vector<Microsoft::WRL::ComPtr<IDXGIAdapter1>> dxgiAdapters;
+    if (m_dxgiFactory)
+        return queryAdapters(m_dxgiFactory.Get(), dxgiAdapters);
+    
+    // Before createDevice a factory without the debug flag is enough
+    Microsoft::WRL::ComPtr<IDXGIFactory6> factory;
+    if (FAILED(CreateDXGIFactory2(0, IID_PPV_ARGS(&factory))))
+    {
+        std::cerr << "[D3D12] Failed to create DXGI factory" << std::endl;
+        return {};
+    }
+    return queryAdapters(factory.Get(), dxgiAdapters);
+}
+
 void DeviceManager_D3D12::destroyDevice()
 {
     waitForIdle();
     
+    // Everything has retired; run outstanding callbacks while the device still exists
+    if (m_fence)
+    {
+        waitForGPU();
+        if (m_device)
+        {
+            m_frameCapture.shutdown();
+        }
+        m_frameTracker.update();
+    }
+    m_frameTracker.reset();
+    
+    // Window swap chains only release their DXGI objects, so application pointers stay
+    // valid across device recovery
+    for (const std::unique_ptr<SwapChain_D3D12>& swapChain : m_windowSwapChains)
+    {
+        swapChain->destroy();
+    }
     destroySwapChain();
     
+    // The device is idle, so nothing released so far can still be in use
+    m_deletionQueue.clear();
+    
     m_device = nullptr;
     m_nvrhiDevice = nullptr;
     
@@ -166,6 +301,8 @@ void DeviceManager_D3D12::destroyDevice()
         m_fenceEvent = nullptr;
     }
     m_fence.Reset();
+    m_copyQueue.Reset();
+    m_computeQueue.Reset();
     m_commandQueue.Reset();
     m_d3d12Device.Reset();
     m_adapter.Reset();
@@ -174,133 +311,169 @@ void DeviceManager_D3D12::destroyDevice()
 
 bool DeviceManager_D3D12::createSwapChain()
 {
-    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.Width = m_windowWidth;
-    swapChainDesc.Height = m_windowHeight;
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.SampleDesc.Count = 1;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.BufferCount = m_params.swapChainBufferCount;
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-    swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
-    
-    Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain1;
-    if (FAILED(m_dxgiFactory->CreateSwapChainForHwnd(
-        m_commandQueue.Get(), m_hwnd, &swapChainDesc, nullptr, nullptr, &swapChain1)))
-    {
-        std::cerr << "[D3D12] Failed to create swap chain" << std::endl;
-        return false;
-    }
-    
-    // Disable Alt+Enter fullscreen toggle
-    m_dxgiFactory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_ALT_ENTER);
-    
-    if (FAILED(swapChain1.As(&m_swapChain)))
+    if (!m_swapChain)
     {
-        std::cerr << "[D3D12] Failed to get IDXGISwapChain4 interface" << std::endl;
-        return false;
+        m_swapChain = std::make_unique<SwapChain_D3D12>(*this, m_window, m_params.windowWidth, m_params.windowHeight);
     }
-    
-    return createRenderTargets();
+    return m_swapChain->create();
 }
 
 void DeviceManager_D3D12::destroySwapChain()
 {
-    destroyRenderTargets();
-    m_swapChain.Reset();
+    m_swapChain.reset();
 }
 
 bool DeviceManager_D3D12::resizeSwapChain(uint32_t width, uint32_t height)
 {
-    if (width == 0 || height == 0)
-        return true;
+    return m_swapChain && m_swapChain->resize(width, height);
+}
+
+ISwapChain* DeviceManager_D3D12::createWindowSwapChain(GLFWwindow* window)
+{
+    if (!window)
+        return nullptr;
     
-    m_windowWidth = width;
-    m_windowHeight = height;
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    auto swapChain = std::make_unique<SwapChain_D3D12>(*this, window,
+        static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    if (!swapChain->create())
+        return nullptr;
     
+    m_windowSwapChains.push_back(std::move(swapChain));
+    return m_windowSwapChains.back().get();
+}
+
+void DeviceManager_D3D12::destroyWindowSwapChain(ISwapChain* swapChain)
+{
+    auto it = std::find_if(m_windowSwapChains.begin(), m_windowSwapChains.end(),
+        [swapChain](const std::unique_ptr<SwapChain_D3D12>& candidate) { return candidate.get() == swapChain; });
+    if (it == m_windowSwapChains.end())
+        return;
+    
+    // Its buffers may still be in use by frames in flight
     waitForGPU();
-    destroyRenderTargets();
+    m_windowSwapChains.erase(it);
+}
+
+void DeviceManager_D3D12::beginFrame()
+{
+    // A removed device is rebuilt before anything of this frame is recorded
+    if (m_deviceLost && !recoverDevice())
+        return;
     
-    if (FAILED(m_swapChain->ResizeBuffers(
-        m_params.swapChainBufferCount,
-        width,
-        height,
-        DXGI_FORMAT_R8G8B8A8_UNORM,
-        DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH)))
+    // Block only on the frame maxFramesInFlight frames back instead of draining the GPU
+    uint64_t frameId = m_frameTracker.beginFrame();
+    uint32_t maxFramesInFlight = std::max(m_params.maxFramesInFlight, 1u);
+    if (frameId > maxFramesInFlight)
     {
-        std::cerr << "[D3D12] Failed to resize swap chain" << std::endl;
-        return false;
+        m_frameTracker.waitForFrame(frameId - maxFramesInFlight);
+    }
+    m_frameTracker.update();
+    m_deletionQueue.update();
+    
+    if (m_memoryBudgetCallback)
+    {
+        m_memoryBudgetCallback(getMemoryStats());
     }
     
-    return createRenderTargets();
+    m_swapChain->acquire();
+    for (const std::unique_ptr<SwapChain_D3D12>& swapChain : m_windowSwapChains)
+    {
+        swapChain->acquire();
+    }
 }
 
-bool DeviceManager_D3D12::createRenderTargets()
+void DeviceManager_D3D12::present()
 {
-    m_swapChainBuffers.resize(m_params.swapChainBufferCount);
-    m_swapChainTextures.resize(m_params.swapChainBufferCount);
-    m_framebuffers.resize(m_params.swapChainBufferCount);
+    // Copy the back buffer for capture as part of this frame's submissions, unless the
+    // swap chain was dropped and has nothing acquired
+    if (m_swapChain->isAcquired())
+    {
+        m_frameCapture.recordFrame(getCurrentBackBuffer());
+    }
     
-    for (UINT i = 0; i < m_params.swapChainBufferCount; i++)
+    // DXGI presents one swap chain per call. Only the primary waits for vblank; the
+    // others would otherwise each block on their own flip queue in turn.
+    HRESULT result = m_swapChain->present(true);
+    for (const std::unique_ptr<SwapChain_D3D12>& swapChain : m_windowSwapChains)
     {
-        if (FAILED(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffers[i]))))
-        {
-            std::cerr << "[D3D12] Failed to get swap chain buffer " << i << std::endl;
-            return false;
-        }
-        
-        nvrhi::TextureDesc textureDesc = {};
-        textureDesc.width = m_windowWidth;
-        textureDesc.height = m_windowHeight;
-        textureDesc.format = m_swapChainFormat;
-        textureDesc.dimension = nvrhi::TextureDimension::Texture2D;
-        textureDesc.isRenderTarget = true;
-        textureDesc.initialState = nvrhi::ResourceStates::Present;
-        textureDesc.keepInitialState = true;
-        textureDesc.debugName = "SwapChainBuffer" + std::to_string(i);
-        
-        m_swapChainTextures[i] = m_nvrhiDevice->createHandleForNativeTexture(
-            nvrhi::ObjectTypes::D3D12_Resource,
-            static_cast<nvrhi::Object>(m_swapChainBuffers[i].Get()),
-            textureDesc);
-        
-        if (!m_swapChainTextures[i])
-        {
-            std::cerr << "[D3D12] Failed to create texture handle for swap chain buffer " << i << std::endl;
-            return false;
-        }
-        
-        nvrhi::FramebufferDesc fbDesc = {};
-        fbDesc.addColorAttachment(m_swapChainTextures[i]);
-        
-        m_framebuffers[i] = m_device->createFramebuffer(fbDesc);
-        if (!m_framebuffers[i])
-        {
-            std::cerr << "[D3D12] Failed to create framebuffer " << i << std::endl;
-            return false;
-        }
+        HRESULT windowResult = swapChain->present(false);
+        if (windowResult == DXGI_ERROR_DEVICE_REMOVED || windowResult == DXGI_ERROR_DEVICE_RESET)
+            result = windowResult;
     }
     
-    return true;
-}
-
-void DeviceManager_D3D12::destroyRenderTargets()
-{
-    m_framebuffers.clear();
-    m_swapChainTextures.clear();
-    m_swapChainBuffers.clear();
+    // Fault injection takes the same path as a real removal
+    if (m_simulateDeviceLost)
+    {
+        m_simulateDeviceLost = false;
+        result = DXGI_ERROR_DEVICE_REMOVED;
+    }
+    checkDeviceRemoved(result, "Present");
+    
+    // This frame retires once the fence reaches the value signaled after Present
+    m_fenceValue++;
+    m_commandQueue->Signal(m_fence.Get(), m_fenceValue);
+    m_frameTracker.endFrame(m_fenceValue);
+    m_frameCapture.update();
+    
+    // Releases only resources whose submissions have already completed
+    runGarbageCollection();
+    
+    // There is no present-wait here; the CPU cap alone paces frames
+    m_frameLimiter.waitForNextFrame();
 }
 
-void DeviceManager_D3D12::beginFrame()
+void DeviceManager_D3D12::checkDeviceRemoved(HRESULT result, const char* operation)
 {
-    m_currentBackBuffer = m_swapChain->GetCurrentBackBufferIndex();
+    if (result != DXGI_ERROR_DEVICE_REMOVED && result != DXGI_ERROR_DEVICE_RESET)
+        return;
+    
+    // Only the first report counts; everything after it fails the same way
+    if (!m_deviceLost.exchange(true))
+    {
+        m_recoveryStats.deviceLostCount++;
+        HRESULT reason = m_d3d12Device ? m_d3d12Device->GetDeviceRemovedReason() : result;
+        std::cerr << "[D3D12] Device removed during " << operation << " (reason 0x"
+                  << std::hex << static_cast<uint32_t>(reason) << std::dec << ")" << std::endl;
+    }
 }
 
-void DeviceManager_D3D12::present()
+bool DeviceManager_D3D12::recoverDevice()
 {
-    m_swapChain->Present(m_params.vsync ? 1 : 0, 0);
-    waitForGPU();
-    runGarbageCollection();
+    auto start = std::chrono::steady_clock::now();
+    
+    // The application drops its handles first, so destroyDevice() releases the last references
+    if (m_recoveryCallbacks.onDeviceLost)
+    {
+        m_recoveryCallbacks.onDeviceLost();
+    }
+    
+    // Fences of a removed device read as complete, so the teardown does not hang. The
+    // factory is recreated too, since the adapter list may have changed with the reset.
+    DeviceCreationParams params = m_params;
+    destroyDevice();
+    
+    if (!createDevice(params))
+    {
+        std::cerr << "[D3D12] Failed to recreate the device after device removal" << std::endl;
+        return false;
+    }
+    m_deviceLost = false;
+    
+    if (m_recoveryCallbacks.onDeviceRestored && !m_recoveryCallbacks.onDeviceRestored())
+    {
+        std::cerr << "[D3D12] Application resources could not be restored after device removal" << std::endl;
+        m_deviceLost = true;
+        return false;
+    }
+    
+    double recoveryTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_recoveryStats.recoveredCount++;
+    m_recoveryStats.lastRecoveryTimeMs = recoveryTimeMs;
+    m_recoveryStats.totalRecoveryTimeMs += recoveryTimeMs;
+    std::cout << "[D3D12] Device recovered in " << recoveryTimeMs << " ms" << std::endl;
+    return true;
 }
 
 void DeviceManager_D3D12::waitForGPU()
@@ -315,6 +488,46 @@ void DeviceManager_D3D12::waitForGPU()
     }
 }
 
+MemoryStats DeviceManager_D3D12::getMemoryStats()
+{
+    MemoryStats stats;
+    if (!m_adapter)
+        return stats;
+    
+    DXGI_ADAPTER_DESC1 desc;
+    m_adapter->GetDesc1(&desc);
+    
+    // DXGI reports per segment group: local is VRAM (all of memory on UMA), non-local is
+    // system memory the GPU can reach
+    MemoryHeapStats local;
+    local.size = desc.DedicatedVideoMemory;
+    local.deviceLocal = true;
+    MemoryHeapStats nonLocal;
+    nonLocal.size = desc.SharedSystemMemory;
+    
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter3;
+    DXGI_QUERY_VIDEO_MEMORY_INFO localInfo = {};
+    DXGI_QUERY_VIDEO_MEMORY_INFO nonLocalInfo = {};
+    if (SUCCEEDED(m_adapter.As(&adapter3)) &&
+        SUCCEEDED(adapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &localInfo)) &&
+        SUCCEEDED(adapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonLocalInfo)))
+    {
+        stats.budgetSupported = true;
+        local.budget = localInfo.Budget;
+        local.usage = localInfo.CurrentUsage;
+        nonLocal.budget = nonLocalInfo.Budget;
+        nonLocal.usage = nonLocalInfo.CurrentUsage;
+    }
+    else
+    {
+        local.budget = local.size;
+        nonLocal.budget = nonLocal.size;
+    }
+    
+    stats.heaps = { local, nonLocal };
+    return stats;
+}
+
 void DeviceManager_D3D12::waitForIdle()
 {
     if (m_device)
@@ -338,27 +551,90 @@ nvrhi::IDevice* DeviceManager_D3D12::getDevice() const
 
 nvrhi::IFramebuffer* DeviceManager_D3D12::getCurrentFramebuffer() const
 {
-    return m_framebuffers[m_currentBackBuffer].Get();
+    return m_swapChain->getCurrentFramebuffer();
 }
 
 nvrhi::ITexture* DeviceManager_D3D12::getCurrentBackBuffer() const
 {
-    return m_swapChainTextures[m_currentBackBuffer].Get();
+    return m_swapChain->getCurrentBackBuffer();
+}
+
+bool DeviceManager_D3D12::isBackBufferAcquired() const
+{
+    return m_swapChain->isAcquired();
+}
+
+nvrhi::CommandListHandle DeviceManager_D3D12::createCommandList(const nvrhi::CommandListParameters& params) const
+{
+    if (hasDedicatedQueue(params.queueType))
+        return m_device->createCommandList(params);
+    
+    // Work meant for a missing queue is recorded for the graphics queue instead
+    nvrhi::CommandListParameters graphicsParams = params;
+    graphicsParams.setQueueType(nvrhi::CommandQueue::Graphics);
+    return m_device->createCommandList(graphicsParams);
+}
+
+uint64_t DeviceManager_D3D12::executeCommandList(nvrhi::ICommandList* commandList)
+{
+    return executeCommandLists(std::span<nvrhi::ICommandList* const>(&commandList, 1));
+}
+
+uint64_t DeviceManager_D3D12::executeCommandLists(std::span<nvrhi::ICommandList* const> commandLists,
+    nvrhi::CommandQueue queue)
+{
+    if (!hasDedicatedQueue(queue))
+        queue = nvrhi::CommandQueue::Graphics;
+    
+    // NVRHI submits every list in one ExecuteCommandLists call. Other queues keep
+    // NVRHI's own instance IDs.
+    uint64_t instance = m_device->executeCommandLists(commandLists.data(), commandLists.size(), queue);
+    if (queue != nvrhi::CommandQueue::Graphics)
+        return instance;
+    
+    // Graphics submission IDs are values on our fence so they share a timeline with frames
+    m_fenceValue++;
+    m_commandQueue->Signal(m_fence.Get(), m_fenceValue);
+    m_frameTracker.noteSubmission(m_fenceValue);
+    return m_fenceValue;
 }
 
-nvrhi::CommandListHandle DeviceManager_D3D12::createCommandList() const
+void DeviceManager_D3D12::queueWaitForSubmission(nvrhi::CommandQueue waitQueue,
+    nvrhi::CommandQueue executionQueue, uint64_t submissionId)
 {
-    return m_device->createCommandList();
+    if (!hasDedicatedQueue(waitQueue))
+        waitQueue = nvrhi::CommandQueue::Graphics;
+    if (!hasDedicatedQueue(executionQueue))
+        executionQueue = nvrhi::CommandQueue::Graphics;
+    
+    if (waitQueue == executionQueue || submissionId == 0)
+        return;
+    
+    // Graphics IDs are on our fence, which NVRHI knows nothing about
+    if (executionQueue == nvrhi::CommandQueue::Graphics)
+    {
+        ID3D12CommandQueue* queue = waitQueue == nvrhi::CommandQueue::Compute ? m_computeQueue.Get() : m_copyQueue.Get();
+        queue->Wait(m_fence.Get(), submissionId);
+        return;
+    }
+    
+    m_device->queueWaitForCommandList(waitQueue, executionQueue, submissionId);
 }
 
-void DeviceManager_D3D12::executeCommandList(nvrhi::ICommandList* commandList)
+bool DeviceManager_D3D12::hasDedicatedQueue(nvrhi::CommandQueue queue) const
 {
-    m_device->executeCommandLists(&commandList, 1);
+    switch (queue)
+    {
+    case nvrhi::CommandQueue::Graphics: return true;
+    case nvrhi::CommandQueue::Compute:  return m_computeQueue != nullptr;
+    case nvrhi::CommandQueue::Copy:     return m_copyQueue != nullptr;
+    default:                            return false;
+    }
 }
 
 uint32_t DeviceManager_D3D12::getCurrentBackBufferIndex() const
 {
-    return m_currentBackBuffer;
+    return m_swapChain->getCurrentBackBufferIndex();
 }
 
 uint32_t DeviceManager_D3D12::getBackBufferCount() const
@@ -366,6 +642,11 @@ uint32_t DeviceManager_D3D12::getBackBufferCount() const
     return m_params.swapChainBufferCount;
 }
 
+PresentMode DeviceManager_D3D12::getPresentMode() const
+{
+    return m_swapChain ? m_swapChain->getPresentMode() : PresentMode::Fifo;
+}
+
 } // namespace common
 
 #endif // _WIN32
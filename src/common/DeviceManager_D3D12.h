@@ -6,6 +6,7 @@
 #ifdef _WIN32
 
 #include "DeviceManager.h"
+#include "SwapChain_D3D12.h"
 
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
@@ -17,6 +18,9 @@
 #include <nvrhi/d3d12.h>
 #include <nvrhi/validation.h>
 
+#include <atomic>
+#include <memory>
+
 namespace common
 {
     class DeviceManager_D3D12 : public IDeviceManager
@@ -32,6 +36,8 @@ namespace common
         bool createSwapChain() override;
         void destroySwapChain() override;
         bool resizeSwapChain(uint32_t width, uint32_t height) override;
+        ISwapChain* createWindowSwapChain(GLFWwindow* window) override;
+        void destroyWindowSwapChain(ISwapChain* swapChain) override;
         
         void beginFrame() override;
         void present() override;
@@ -39,53 +45,94 @@ namespace common
         nvrhi::IDevice* getDevice() const override;
         nvrhi::IFramebuffer* getCurrentFramebuffer() const override;
         nvrhi::ITexture* getCurrentBackBuffer() const override;
-        nvrhi::CommandListHandle createCommandList() const override;
-        void executeCommandList(nvrhi::ICommandList* commandList) override;
+        bool isBackBufferAcquired() const override;
+        nvrhi::CommandListHandle createCommandList(
+            const nvrhi::CommandListParameters& params = nvrhi::CommandListParameters()) const override;
+        uint64_t executeCommandList(nvrhi::ICommandList* commandList) override;
+        uint64_t executeCommandLists(std::span<nvrhi::ICommandList* const> commandLists,
+            nvrhi::CommandQueue queue = nvrhi::CommandQueue::Graphics) override;
+        void queueWaitForSubmission(nvrhi::CommandQueue waitQueue,
+            nvrhi::CommandQueue executionQueue, uint64_t submissionId) override;
+        bool hasDedicatedQueue(nvrhi::CommandQueue queue) const override;
         void waitForIdle() override;
         void runGarbageCollection() override;
+        FrameTracker& getFrameTracker() override { return m_frameTracker; }
+        DeletionQueue& getDeletionQueue() override { return m_deletionQueue; }
+        FrameCapture& getFrameCapture() override { return m_frameCapture; }
+        FrameLimiter& getFrameLimiter() override { return m_frameLimiter; }
+        PresentMode getPresentMode() const override;
+        MemoryStats getMemoryStats() override;
+        void setMemoryBudgetCallback(MemoryBudgetCallback callback) override { m_memoryBudgetCallback = std::move(callback); }
+        void setDeviceRecoveryCallbacks(DeviceRecoveryCallbacks callbacks) override { m_recoveryCallbacks = std::move(callbacks); }
+        bool isDeviceLost() const override { return m_deviceLost; }
+        DeviceRecoveryStats getDeviceRecoveryStats() const override { return m_recoveryStats; }
+        void simulateDeviceLost() override { m_simulateDeviceLost = true; }
+        bool isPipelineCacheWarm() const override { return false; }
+        bool isBindlessSupported() const override { return m_bindlessSupported; }
+        std::vector<AdapterInfo> enumerateAdapters() override;
         
         uint32_t getCurrentBackBufferIndex() const override;
         uint32_t getBackBufferCount() const override;
-        uint32_t getWindowWidth() const override { return m_windowWidth; }
-        uint32_t getWindowHeight() const override { return m_windowHeight; }
-        nvrhi::Format getSwapChainFormat() const override { return m_swapChainFormat; }
+        uint32_t getWindowWidth() const override { return m_swapChain ? m_swapChain->getWidth() : m_params.windowWidth; }
+        uint32_t getWindowHeight() const override { return m_swapChain ? m_swapChain->getHeight() : m_params.windowHeight; }
+        nvrhi::Format getSwapChainFormat() const override { return m_params.swapChainFormat; }
         GraphicsAPI getGraphicsAPI() const override { return GraphicsAPI::D3D12; }
         const char* getGraphicsAPIName() const override { return "D3D12"; }
 
     private:
-        bool createRenderTargets();
-        void destroyRenderTargets();
+        // Swap chains reach into the factory, queue and device
+        friend class SwapChain_D3D12;
+        
+        std::vector<AdapterInfo> queryAdapters(IDXGIFactory6* factory,
+            std::vector<Microsoft::WRL::ComPtr<IDXGIAdapter1>>& dxgiAdapters);
         void waitForGPU();
+        
+        // Device-removal handling; recovery runs from beginFrame()
+        void checkDeviceRemoved(HRESULT result, const char* operation);
+        bool recoverDevice();
 
     private:
         // Creation params
         DeviceCreationParams m_params;
         GLFWwindow* m_window = nullptr;
-        HWND m_hwnd = nullptr;
-        uint32_t m_windowWidth = 0;
-        uint32_t m_windowHeight = 0;
-        nvrhi::Format m_swapChainFormat = nvrhi::Format::RGBA8_UNORM;
         
         // D3D12 objects
         Microsoft::WRL::ComPtr<IDXGIFactory6> m_dxgiFactory;
         Microsoft::WRL::ComPtr<IDXGIAdapter1> m_adapter;
         Microsoft::WRL::ComPtr<ID3D12Device> m_d3d12Device;
         Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
-        Microsoft::WRL::ComPtr<IDXGISwapChain4> m_swapChain;
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_computeQueue;
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_copyQueue;
         Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
         HANDLE m_fenceEvent = nullptr;
         uint64_t m_fenceValue = 0;
         
+        // Frame pacing and retirement on the GPU timeline
+        FrameTracker m_frameTracker;
+        DeletionQueue m_deletionQueue{ m_frameTracker };
+        FrameCapture m_frameCapture{ *this };
+        FrameLimiter m_frameLimiter;
+        
+        // The primary window's swap chain, and additional windows. Window swap chains
+        // keep their objects across device recovery.
+        std::unique_ptr<SwapChain_D3D12> m_swapChain;
+        std::vector<std::unique_ptr<SwapChain_D3D12>> m_windowSwapChains;
+        
+        MemoryBudgetCallback m_memoryBudgetCallback;
+        
+        // Resource binding tier 2 or higher, for bindless tables
+        bool m_bindlessSupported = false;
+        
+        // Set from any thread that sees the device removed, including fence waits
+        std::atomic<bool> m_deviceLost = false;
+        bool m_simulateDeviceLost = false;
+        DeviceRecoveryCallbacks m_recoveryCallbacks;
+        DeviceRecoveryStats m_recoveryStats;
+        
         // NVRHI objects
         DefaultMessageCallback m_messageCallback;
         nvrhi::d3d12::DeviceHandle m_nvrhiDevice;
         nvrhi::DeviceHandle m_device;  // May be validation layer or direct device
-        
-        // Swap chain resources
-        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_swapChainBuffers;
-        std::vector<nvrhi::TextureHandle> m_swapChainTextures;
-        std::vector<nvrhi::FramebufferHandle> m_framebuffers;
-        uint32_t m_currentBackBuffer = 0;
     };
 
 } // namespace common
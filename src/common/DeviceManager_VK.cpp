@@ -15,10 +15,17 @@ VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 #include <vector>
 #include <set>
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <dlfcn.h>
 #endif
 
 namespace common
@@ -45,18 +52,95 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
     return VK_FALSE;
 }
 
+// Load vkGetInstanceProcAddr straight from the Vulkan loader, for when GLFW is not
+// initialized (headless mode). The library stays loaded for the process lifetime.
+static PFN_vkGetInstanceProcAddr openVulkanLoader()
+{
+#ifdef _WIN32
+    HMODULE module = LoadLibraryA("vulkan-1.dll");
+    if (!module)
+        return nullptr;
+    return reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetProcAddress(module, "vkGetInstanceProcAddr"));
+#else
+#ifdef __APPLE__
+    void* module = dlopen("libvulkan.1.dylib", RTLD_NOW | RTLD_LOCAL);
+#else
+    void* module = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!module)
+        module = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+#endif
+    if (!module)
+        return nullptr;
+    return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(module, "vkGetInstanceProcAddr"));
+#endif
+}
+
+// The library search is the slow part of loading, and device recreation or adapter
+// enumeration would repeat it, so the result is resolved once per process
+static PFN_vkGetInstanceProcAddr loadVulkanLoader()
+{
+    static const PFN_vkGetInstanceProcAddr getInstanceProcAddr = openVulkanLoader();
+    return getInstanceProcAddr;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Expanded over the VulkanFunctions.h tables inside the load functions, each of which
+// defines getProcAddr for its dispatch level
+#define VK_LOAD_FUNCTION(name) \
+    name = reinterpret_cast<PFN_##name>(getProcAddr(#name)); \
+    (name ? m_loaderStats.functionsLoaded : m_loaderStats.functionsMissing)++;
+
+// NVRHI creates its pipelines without a VkPipelineCache and has no API to supply one.
+// It calls through the vulkan.hpp dispatcher whose storage lives in this file, so the
+// pipeline creation entries are redirected to substitute our cache. One cache per
+// process is enough for a single device manager.
+static VkPipelineCache s_pipelineCache = VK_NULL_HANDLE;
+static PFN_vkCreateGraphicsPipelines s_createGraphicsPipelines = nullptr;
+static PFN_vkCreateComputePipelines s_createComputePipelines = nullptr;
+
+static VKAPI_ATTR VkResult VKAPI_CALL createGraphicsPipelinesWithCache(
+    VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount,
+    const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+    return s_createGraphicsPipelines(device, pipelineCache ? pipelineCache : s_pipelineCache,
+        createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL createComputePipelinesWithCache(
+    VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount,
+    const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+    return s_createComputePipelines(device, pipelineCache ? pipelineCache : s_pipelineCache,
+        createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
 DeviceManager_VK::DeviceManager_VK() = default;
 
 DeviceManager_VK::~DeviceManager_VK()
 {
     destroyDevice();
+    m_windowSwapChains.clear();
 }
 
 void DeviceManager_VK::loadVulkanFunctions()
 {
-    // Get vkGetInstanceProcAddr from GLFW
-    vkGetInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(
-        glfwGetInstanceProcAddress(nullptr, "vkGetInstanceProcAddr"));
+    auto start = std::chrono::steady_clock::now();
+    
+    // Get vkGetInstanceProcAddr from GLFW, or from the loader directly when there is no window
+    if (m_params.headless)
+    {
+        vkGetInstanceProcAddr = loadVulkanLoader();
+    }
+    else
+    {
+        vkGetInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(
+            glfwGetInstanceProcAddress(nullptr, "vkGetInstanceProcAddr"));
+    }
+    m_loaderStats.loaderTimeMs += millisecondsSince(start);
     
     if (!vkGetInstanceProcAddr)
     {
@@ -64,90 +148,62 @@ void DeviceManager_VK::loadVulkanFunctions()
         return;
     }
     
+    start = std::chrono::steady_clock::now();
+    
     // Initialize vulkan.hpp dispatch loader with vkGetInstanceProcAddr
     // This is required for NVRHI which uses vulkan.hpp internally
     VULKAN_HPP_DEFAULT_DISPATCHER.init(vkGetInstanceProcAddr);
     
-    // Load global functions
-    vkCreateInstance = reinterpret_cast<PFN_vkCreateInstance>(
-        vkGetInstanceProcAddr(nullptr, "vkCreateInstance"));
-    vkEnumerateInstanceExtensionProperties = reinterpret_cast<PFN_vkEnumerateInstanceExtensionProperties>(
-        vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceExtensionProperties"));
-    vkEnumerateInstanceLayerProperties = reinterpret_cast<PFN_vkEnumerateInstanceLayerProperties>(
-        vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceLayerProperties"));
+    auto getProcAddr = [this](const char* name) {
+        return vkGetInstanceProcAddr(nullptr, name);
+    };
+    VK_GLOBAL_FUNCTIONS(VK_LOAD_FUNCTION)
+    
+    m_loaderStats.globalTimeMs += millisecondsSince(start);
 }
 
 void DeviceManager_VK::loadInstanceFunctions()
 {
     if (!m_instance) return;
     
+    auto start = std::chrono::steady_clock::now();
+    
     // Initialize vulkan.hpp dispatch loader with instance (load instance-level functions)
     VULKAN_HPP_DEFAULT_DISPATCHER.init(m_instance, vkGetInstanceProcAddr, VK_NULL_HANDLE, nullptr);
     
-    vkDestroyInstance = reinterpret_cast<PFN_vkDestroyInstance>(
-        vkGetInstanceProcAddr(m_instance, "vkDestroyInstance"));
-    vkEnumeratePhysicalDevices = reinterpret_cast<PFN_vkEnumeratePhysicalDevices>(
-        vkGetInstanceProcAddr(m_instance, "vkEnumeratePhysicalDevices"));
-    vkGetPhysicalDeviceProperties = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceProperties"));
-    vkGetPhysicalDeviceFeatures = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceFeatures"));
-    vkGetPhysicalDeviceQueueFamilyProperties = reinterpret_cast<PFN_vkGetPhysicalDeviceQueueFamilyProperties>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceQueueFamilyProperties"));
-    vkCreateDevice = reinterpret_cast<PFN_vkCreateDevice>(
-        vkGetInstanceProcAddr(m_instance, "vkCreateDevice"));
-    vkDestroySurfaceKHR = reinterpret_cast<PFN_vkDestroySurfaceKHR>(
-        vkGetInstanceProcAddr(m_instance, "vkDestroySurfaceKHR"));
-    vkGetPhysicalDeviceSurfaceSupportKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfaceSupportKHR>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfaceSupportKHR"));
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR"));
-    vkGetPhysicalDeviceSurfaceFormatsKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfaceFormatsKHR>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfaceFormatsKHR"));
-    vkGetPhysicalDeviceSurfacePresentModesKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfacePresentModesKHR>(
-        vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceSurfacePresentModesKHR"));
-    vkEnumerateDeviceExtensionProperties = reinterpret_cast<PFN_vkEnumerateDeviceExtensionProperties>(
-        vkGetInstanceProcAddr(m_instance, "vkEnumerateDeviceExtensionProperties"));
-    vkCreateDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
-        vkGetInstanceProcAddr(m_instance, "vkCreateDebugUtilsMessengerEXT"));
-    vkDestroyDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
-        vkGetInstanceProcAddr(m_instance, "vkDestroyDebugUtilsMessengerEXT"));
+    auto getProcAddr = [this](const char* name) {
+        return vkGetInstanceProcAddr(m_instance, name);
+    };
+    VK_INSTANCE_FUNCTIONS(VK_LOAD_FUNCTION)
+    
+    m_loaderStats.instanceTimeMs += millisecondsSince(start);
 }
 
 void DeviceManager_VK::loadDeviceFunctions()
 {
-    if (!m_vkDevice) return;
+    if (!m_vkDevice || !vkGetDeviceProcAddr) return;
     
-    // Get vkGetDeviceProcAddr for device-level function loading
-    PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr = reinterpret_cast<PFN_vkGetDeviceProcAddr>(
-        vkGetInstanceProcAddr(m_instance, "vkGetDeviceProcAddr"));
+    auto start = std::chrono::steady_clock::now();
     
     // Initialize vulkan.hpp dispatch loader with device (load device-level functions)
     VULKAN_HPP_DEFAULT_DISPATCHER.init(m_instance, vkGetInstanceProcAddr, m_vkDevice, vkGetDeviceProcAddr);
     
-    auto getDeviceProc = [this](const char* name) {
-        return vkGetInstanceProcAddr(m_instance, name);
+    // Per-frame calls such as acquire, present and timeline waits go straight to the driver
+    auto getProcAddr = [this](const char* name) {
+        return vkGetDeviceProcAddr(m_vkDevice, name);
     };
+    VK_DEVICE_FUNCTIONS(VK_LOAD_FUNCTION)
     
-    vkDestroyDevice = reinterpret_cast<PFN_vkDestroyDevice>(getDeviceProc("vkDestroyDevice"));
-    vkGetDeviceQueue = reinterpret_cast<PFN_vkGetDeviceQueue>(getDeviceProc("vkGetDeviceQueue"));
-    vkCreateSwapchainKHR = reinterpret_cast<PFN_vkCreateSwapchainKHR>(getDeviceProc("vkCreateSwapchainKHR"));
-    vkDestroySwapchainKHR = reinterpret_cast<PFN_vkDestroySwapchainKHR>(getDeviceProc("vkDestroySwapchainKHR"));
-    vkGetSwapchainImagesKHR = reinterpret_cast<PFN_vkGetSwapchainImagesKHR>(getDeviceProc("vkGetSwapchainImagesKHR"));
-    vkAcquireNextImageKHR = reinterpret_cast<PFN_vkAcquireNextImageKHR>(getDeviceProc("vkAcquireNextImageKHR"));
-    vkQueuePresentKHR = reinterpret_cast<PFN_vkQueuePresentKHR>(getDeviceProc("vkQueuePresentKHR"));
-    vkCreateSemaphore = reinterpret_cast<PFN_vkCreateSemaphore>(getDeviceProc("vkCreateSemaphore"));
-    vkDestroySemaphore = reinterpret_cast<PFN_vkDestroySemaphore>(getDeviceProc("vkDestroySemaphore"));
-    vkDeviceWaitIdle = reinterpret_cast<PFN_vkDeviceWaitIdle>(getDeviceProc("vkDeviceWaitIdle"));
-    vkQueueWaitIdle = reinterpret_cast<PFN_vkQueueWaitIdle>(getDeviceProc("vkQueueWaitIdle"));
+    m_loaderStats.deviceTimeMs += millisecondsSince(start);
 }
 
+#undef VK_LOAD_FUNCTION
+
 bool DeviceManager_VK::createDevice(const DeviceCreationParams& params)
 {
     m_params = params;
     m_window = params.window;
-    m_windowWidth = params.windowWidth;
-    m_windowHeight = params.windowHeight;
+    m_loaderStats = {};
     
     // Load Vulkan functions
     loadVulkanFunctions();
@@ -158,13 +214,14 @@ bool DeviceManager_VK::createDevice(const DeviceCreationParams& params)
     }
     
     if (!createInstance()) return false;
-    loadInstanceFunctions();
     
-    if (!createSurface()) return false;
+    if (!m_params.headless && !createSurface()) return false;
     if (!selectPhysicalDevice()) return false;
     if (!findQueueFamilies()) return false;
     if (!createLogicalDevice()) return false;
-    loadDeviceFunctions();
+    
+    // Must follow the last dispatcher init so the redirection is not overwritten
+    createPipelineCache();
     
     // Create NVRHI Vulkan device
     nvrhi::vulkan::DeviceDesc deviceDesc = {};
@@ -174,6 +231,18 @@ bool DeviceManager_VK::createDevice(const DeviceCreationParams& params)
     deviceDesc.device = m_vkDevice;
     deviceDesc.graphicsQueue = m_graphicsQueue;
     deviceDesc.graphicsQueueIndex = static_cast<int>(m_graphicsQueueFamily);
+    if (m_computeQueue != VK_NULL_HANDLE)
+    {
+        deviceDesc.computeQueue = m_computeQueue;
+        deviceDesc.computeQueueIndex = static_cast<int>(m_computeQueueFamily);
+        std::cout << "[Vulkan] Using queue family " << m_computeQueueFamily << " for async compute" << std::endl;
+    }
+    if (m_transferQueue != VK_NULL_HANDLE)
+    {
+        deviceDesc.transferQueue = m_transferQueue;
+        deviceDesc.transferQueueIndex = static_cast<int>(m_transferQueueFamily);
+        std::cout << "[Vulkan] Using queue family " << m_transferQueueFamily << " for transfers" << std::endl;
+    }
     
     m_nvrhiDevice = nvrhi::vulkan::createDevice(deviceDesc);
     if (!m_nvrhiDevice)
@@ -193,23 +262,67 @@ bool DeviceManager_VK::createDevice(const DeviceCreationParams& params)
         m_device = m_nvrhiDevice;
     }
     
+    // Track frames on NVRHI's graphics queue timeline semaphore; submission IDs
+    // returned by executeCommandLists are values on this timeline
+    VkSemaphore timelineSemaphore = m_nvrhiDevice->getQueueSemaphore(nvrhi::CommandQueue::Graphics);
+    m_frameTracker.setTimeline({
+        [this, timelineSemaphore]()
+        {
+            uint64_t value = 0;
+            vkGetSemaphoreCounterValue(m_vkDevice, timelineSemaphore, &value);
+            return value;
+        },
+        [this, timelineSemaphore](uint64_t value)
+        {
+            VkSemaphoreWaitInfo waitInfo = {};
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores = &timelineSemaphore;
+            waitInfo.pValues = &value;
+            checkDeviceLost(vkWaitSemaphores(m_vkDevice, &waitInfo, UINT64_MAX), "a timeline wait");
+        }
+    });
+    
+    // Captured frames are mapped once their slot comes around again, so keep one
+    // more slot than frames in flight
+    m_frameCapture.setRingSize(m_params.maxFramesInFlight + 1);
+    m_frameLimiter.setTargetFrameRate(m_params.maxFrameRate);
+    
     // Create swap chain
     if (!createSwapChain())
     {
         return false;
     }
     
+    // Windows that outlived a previous device (recovery) get new surfaces and swap chains
+    for (const std::unique_ptr<SwapChain_VK>& swapChain : m_windowSwapChains)
+    {
+        if (!swapChain->create())
+            return false;
+    }
+    
+    const LoaderStats& loader = m_loaderStats;
+    std::cout << "[Vulkan] Loaded " << loader.functionsLoaded << " entry points ("
+              << loader.functionsMissing << " unavailable) in " << std::fixed << std::setprecision(2)
+              << loader.loaderTimeMs + loader.globalTimeMs + loader.instanceTimeMs + loader.deviceTimeMs
+              << " ms: loader " << loader.loaderTimeMs << ", global " << loader.globalTimeMs
+              << ", instance " << loader.instanceTimeMs << ", device " << loader.deviceTimeMs
+              << std::defaultfloat << std::endl;
+    
     std::cout << "[Vulkan] Device created successfully" << std::endl;
     return true;
 }
 
 bool DeviceManager_VK::createInstance()
 {
-    // Get required extensions from GLFW
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Get required extensions from GLFW (headless mode needs no surface extensions)
+    std::vector<const char*> extensions;
+    if (!m_params.headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     
     // Add debug utils extension if debug layer is enabled
     if (m_params.enableDebugLayer)
@@ -271,11 +384,11 @@ bool DeviceManager_VK::createInstance()
         return false;
     }
     
+    loadInstanceFunctions();
+    
     // Create debug messenger if debug layer is enabled
     if (m_params.enableDebugLayer && !validationLayers.empty())
     {
-        loadInstanceFunctions();
-        
         if (vkCreateDebugUtilsMessengerEXT)
         {
             VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = {};
@@ -304,27 +417,66 @@ bool DeviceManager_VK::createSurface()
     return true;
 }
 
-bool DeviceManager_VK::selectPhysicalDevice()
+std::vector<AdapterInfo> DeviceManager_VK::queryAdapters(std::vector<VkPhysicalDevice>& physicalDevices)
 {
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
+    physicalDevices.resize(deviceCount);
+    vkEnumeratePhysicalDevices(m_instance, &deviceCount, physicalDevices.data());
     
-    if (deviceCount == 0)
-    {
-        std::cerr << "[Vulkan] No GPUs with Vulkan support found" << std::endl;
-        return false;
-    }
-    
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
-    
-    // Select the first discrete GPU, or the first available GPU
-    for (const auto& device : devices)
+    std::vector<AdapterInfo> adapters;
+    for (uint32_t i = 0; i < deviceCount; i++)
     {
+        VkPhysicalDevice device = physicalDevices[i];
+        
         VkPhysicalDeviceProperties properties;
         vkGetPhysicalDeviceProperties(device, &properties);
         
-        // Check for required extensions
+        AdapterInfo adapter;
+        adapter.index = i;
+        adapter.name = properties.deviceName;
+        adapter.vendorId = properties.vendorID;
+        adapter.deviceId = properties.deviceID;
+        switch (properties.deviceType)
+        {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   adapter.type = AdapterType::Discrete; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: adapter.type = AdapterType::Integrated; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    adapter.type = AdapterType::Virtual; break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:            adapter.type = AdapterType::Software; break;
+        default:                                     adapter.type = AdapterType::Other; break;
+        }
+        
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+        for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++)
+        {
+            if (memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                adapter.dedicatedMemory = std::max<uint64_t>(adapter.dedicatedMemory, memoryProperties.memoryHeaps[heap].size);
+        }
+        
+        // Same family rules as findQueueFamilies()
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+        
+        bool hasGraphics = false;
+        bool hasPresent = m_surface == VK_NULL_HANDLE;
+        for (uint32_t family = 0; family < queueFamilyCount; family++)
+        {
+            VkQueueFlags flags = queueFamilies[family].queueFlags;
+            hasGraphics |= (flags & VK_QUEUE_GRAPHICS_BIT) != 0;
+            adapter.hasComputeQueue |= (flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT);
+            adapter.hasTransferQueue |= (flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+            
+            if (!hasPresent)
+            {
+                VkBool32 presentSupport = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, family, m_surface, &presentSupport);
+                hasPresent = presentSupport;
+            }
+        }
+        
         uint32_t extensionCount;
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
         std::vector<VkExtensionProperties> extensions(extensionCount);
@@ -340,26 +492,118 @@ bool DeviceManager_VK::selectPhysicalDevice()
             }
         }
         
-        if (!hasSwapchain)
-            continue;
+        // Features enabled unconditionally by createLogicalDevice(), and optional ones
+        // that raise the score
+        VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        vulkan13Features.pNext = &vulkan12Features;
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &vulkan13Features;
         
-        // Prefer discrete GPU
-        if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU || m_physicalDevice == VK_NULL_HANDLE)
+        if (properties.apiVersion < VK_API_VERSION_1_3)
+            adapter.unsuitableReason = "Vulkan 1.3 not supported";
+        else
         {
-            m_physicalDevice = device;
-            std::cout << "[Vulkan] Using GPU: " << properties.deviceName << std::endl;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
             
-            if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-                break;
+            if (!vulkan12Features.timelineSemaphore || !vulkan12Features.bufferDeviceAddress ||
+                !vulkan13Features.dynamicRendering || !vulkan13Features.synchronization2)
+                adapter.unsuitableReason = "missing required features";
+            else if (!hasGraphics)
+                adapter.unsuitableReason = "no graphics queue";
+            else if (!m_params.headless && !hasSwapchain)
+                adapter.unsuitableReason = "no swapchain support";
+            else if (!hasPresent)
+                adapter.unsuitableReason = "cannot present to the window surface";
         }
+        
+        if (adapter.unsuitableReason.empty())
+        {
+            const VkPhysicalDeviceFeatures& features = features2.features;
+            if (features.multiDrawIndirect)
+                adapter.optionalFeatures.push_back("multiDrawIndirect");
+            if (features.drawIndirectFirstInstance)
+                adapter.optionalFeatures.push_back("drawIndirectFirstInstance");
+            if (features.samplerAnisotropy)
+                adapter.optionalFeatures.push_back("samplerAnisotropy");
+            if (features.shaderInt64)
+                adapter.optionalFeatures.push_back("shaderInt64");
+            if (vulkan12Features.descriptorIndexing)
+                adapter.optionalFeatures.push_back("descriptorIndexing");
+        }
+        
+        adapter.score = scoreAdapter(adapter);
+        adapters.push_back(std::move(adapter));
     }
     
-    if (m_physicalDevice == VK_NULL_HANDLE)
+    return adapters;
+}
+
+std::vector<AdapterInfo> DeviceManager_VK::enumerateAdapters()
+{
+    std::vector<VkPhysicalDevice> physicalDevices;
+    if (m_instance != VK_NULL_HANDLE)
+        return queryAdapters(physicalDevices);
+    
+    // Before createDevice a bare instance is enough. The loader is opened directly so
+    // this works without GLFW, and there is no surface to check presentation against.
+    vkGetInstanceProcAddr = loadVulkanLoader();
+    if (!vkGetInstanceProcAddr)
+    {
+        std::cerr << "[Vulkan] Failed to load the Vulkan loader" << std::endl;
+        return {};
+    }
+    vkCreateInstance = reinterpret_cast<PFN_vkCreateInstance>(
+        vkGetInstanceProcAddr(nullptr, "vkCreateInstance"));
+    
+    VkApplicationInfo appInfo = {};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "NVRHI Demo";
+    appInfo.apiVersion = VK_API_VERSION_1_4;
+    
+    VkInstanceCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+    
+    if (!vkCreateInstance || vkCreateInstance(&createInfo, nullptr, &m_instance) != VK_SUCCESS)
+    {
+        std::cerr << "[Vulkan] Failed to create Vulkan instance" << std::endl;
+        m_instance = VK_NULL_HANDLE;
+        return {};
+    }
+    
+    loadInstanceFunctions();
+    std::vector<AdapterInfo> adapters = queryAdapters(physicalDevices);
+    
+    vkDestroyInstance(m_instance, nullptr);
+    m_instance = VK_NULL_HANDLE;
+    
+    // The dispatcher was loaded from the instance just destroyed; start it over with
+    // global functions only, so nothing can call into the dead instance
+    VULKAN_HPP_DEFAULT_DISPATCHER = VULKAN_HPP_DEFAULT_DISPATCHER_TYPE(vkGetInstanceProcAddr);
+    return adapters;
+}
+
+bool DeviceManager_VK::selectPhysicalDevice()
+{
+    std::vector<VkPhysicalDevice> physicalDevices;
+    std::vector<AdapterInfo> adapters = queryAdapters(physicalDevices);
+    
+    if (adapters.empty())
     {
-        std::cerr << "[Vulkan] No suitable GPU found" << std::endl;
+        std::cerr << "[Vulkan] No GPUs with Vulkan support found" << std::endl;
         return false;
     }
     
+    int selected = selectAdapter(adapters, m_params, GraphicsAPI::Vulkan);
+    if (selected < 0)
+        return false;
+    
+    m_physicalDevice = physicalDevices[selected];
+    std::cout << "[Vulkan] Using GPU: " << adapters[selected].name << std::endl;
     return true;
 }
 
@@ -382,6 +626,16 @@ bool DeviceManager_VK::findQueueFamilies()
             foundGraphics = true;
         }
         
+        // Nothing is presented in headless mode; the graphics queue doubles as the present queue
+        if (m_params.headless)
+        {
+            m_presentQueueFamily = m_graphicsQueueFamily;
+            foundPresent = foundGraphics;
+            if (foundGraphics)
+                break;
+            continue;
+        }
+        
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(m_physicalDevice, i, m_surface, &presentSupport);
         if (presentSupport)
@@ -400,12 +654,44 @@ bool DeviceManager_VK::findQueueFamilies()
         return false;
     }
     
+    // A compute-only family runs asynchronously to graphics on most hardware
+    m_computeQueueFamily = UINT32_MAX;
+    for (uint32_t i = 0; i < queueFamilyCount; i++)
+    {
+        VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            m_computeQueueFamily = i;
+            break;
+        }
+    }
+    
+    // A transfer-only family is usually backed by a DMA engine that copies alongside rendering
+    m_transferQueueFamily = UINT32_MAX;
+    for (uint32_t i = 0; i < queueFamilyCount; i++)
+    {
+        VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            m_transferQueueFamily = i;
+            break;
+        }
+    }
+    
     return true;
 }
 
 bool DeviceManager_VK::createLogicalDevice()
 {
     std::set<uint32_t> uniqueQueueFamilies = { m_graphicsQueueFamily, m_presentQueueFamily };
+    if (m_computeQueueFamily != UINT32_MAX)
+    {
+        uniqueQueueFamilies.insert(m_computeQueueFamily);
+    }
+    if (m_transferQueueFamily != UINT32_MAX)
+    {
+        uniqueQueueFamilies.insert(m_transferQueueFamily);
+    }
     
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     float queuePriority = 1.0f;
@@ -426,6 +712,40 @@ bool DeviceManager_VK::createLogicalDevice()
     vulkan12Features.timelineSemaphore = VK_TRUE;
     vulkan12Features.bufferDeviceAddress = VK_TRUE;
     
+    // Descriptor indexing for bindless tables, when every feature NVRHI's bindless layouts
+    // rely on is there: unsized arrays, partially bound and variable-count sets, and
+    // update-after-bind so slots can be written while earlier frames are in flight
+    VkPhysicalDeviceVulkan12Features supported12Features = {};
+    supported12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 featureQuery = {};
+    featureQuery.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    featureQuery.pNext = &supported12Features;
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &featureQuery);
+    
+    m_bindlessSupported = supported12Features.descriptorIndexing &&
+        supported12Features.runtimeDescriptorArray &&
+        supported12Features.descriptorBindingPartiallyBound &&
+        supported12Features.descriptorBindingVariableDescriptorCount &&
+        supported12Features.descriptorBindingSampledImageUpdateAfterBind &&
+        supported12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+        supported12Features.shaderSampledImageArrayNonUniformIndexing &&
+        supported12Features.shaderStorageBufferArrayNonUniformIndexing;
+    if (m_bindlessSupported)
+    {
+        vulkan12Features.descriptorIndexing = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+    }
+    else
+    {
+        std::cout << "[Vulkan] Descriptor indexing not supported, bindless tables disabled" << std::endl;
+    }
+    
     // Enable Vulkan 1.3 features required by NVRHI (dynamic rendering)
     VkPhysicalDeviceVulkan13Features vulkan13Features = {};
     vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
@@ -438,9 +758,59 @@ bool DeviceManager_VK::createLogicalDevice()
     deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     deviceFeatures2.pNext = &vulkan13Features;
     
-    std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    std::vector<const char*> deviceExtensions;
+    if (!m_params.headless)
+    {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+    
+    // Present IDs let the frame limiter wait for a frame to reach the display
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.pNext = &presentIdFeatures;
+    
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, extensions.data());
+    
+    bool hasPresentId = false;
+    bool hasPresentWait = false;
+    bool hasMemoryBudget = false;
+    for (const auto& ext : extensions)
+    {
+        hasPresentId |= strcmp(ext.extensionName, VK_KHR_PRESENT_ID_EXTENSION_NAME) == 0;
+        hasPresentWait |= strcmp(ext.extensionName, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0;
+        hasMemoryBudget |= strcmp(ext.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    }
+    
+    // Per-heap budget and usage from the driver; without it only heap sizes are known
+    m_memoryBudgetSupported = hasMemoryBudget;
+    if (hasMemoryBudget)
+    {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    
+    m_presentWaitSupported = false;
+    if (!m_params.headless && hasPresentId && hasPresentWait)
+    {
+        VkPhysicalDeviceFeatures2 supportedFeatures = {};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &presentWaitFeatures;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
+        
+        if (presentIdFeatures.presentId && presentWaitFeatures.presentWait)
+        {
+            deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            presentIdFeatures.pNext = deviceFeatures2.pNext;
+            deviceFeatures2.pNext = &presentWaitFeatures;
+            m_presentWaitSupported = true;
+            std::cout << "[Vulkan] Present wait enabled" << std::endl;
+        }
+    }
     
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -461,6 +831,14 @@ bool DeviceManager_VK::createLogicalDevice()
     
     vkGetDeviceQueue(m_vkDevice, m_graphicsQueueFamily, 0, &m_graphicsQueue);
     vkGetDeviceQueue(m_vkDevice, m_presentQueueFamily, 0, &m_presentQueue);
+    if (m_computeQueueFamily != UINT32_MAX)
+    {
+        vkGetDeviceQueue(m_vkDevice, m_computeQueueFamily, 0, &m_computeQueue);
+    }
+    if (m_transferQueueFamily != UINT32_MAX)
+    {
+        vkGetDeviceQueue(m_vkDevice, m_transferQueueFamily, 0, &m_transferQueue);
+    }
     
     return true;
 }
@@ -469,16 +847,39 @@ void DeviceManager_VK::destroyDevice()
 {
     waitForIdle();
     
+    // Everything has retired; finish captures and run outstanding callbacks while the device still exists
+    if (m_device)
+    {
+        m_frameCapture.shutdown();
+    }
+    m_frameTracker.update();
+    m_frameTracker.reset();
+    
+    // Window swap chains only release their Vulkan objects, so application pointers stay
+    // valid across device recovery
+    for (const std::unique_ptr<SwapChain_VK>& swapChain : m_windowSwapChains)
+    {
+        swapChain->destroy();
+    }
     destroySwapChain();
     
+    // The device is idle, so nothing released so far can still be in use
+    m_deletionQueue.clear();
+    
     m_device = nullptr;
     m_nvrhiDevice = nullptr;
     
+    destroyPipelineCache();
+    
     if (m_vkDevice != VK_NULL_HANDLE && vkDestroyDevice)
     {
         vkDestroyDevice(m_vkDevice, nullptr);
         m_vkDevice = VK_NULL_HANDLE;
     }
+    m_computeQueue = VK_NULL_HANDLE;
+    m_computeQueueFamily = UINT32_MAX;
+    m_transferQueue = VK_NULL_HANDLE;
+    m_transferQueueFamily = UINT32_MAX;
     
     if (m_surface != VK_NULL_HANDLE && vkDestroySurfaceKHR)
     {
@@ -499,293 +900,449 @@ void DeviceManager_VK::destroyDevice()
     }
 }
 
-bool DeviceManager_VK::createSwapChain()
+void DeviceManager_VK::createPipelineCache()
 {
-    // Get surface capabilities
-    VkSurfaceCapabilitiesKHR capabilities;
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &capabilities);
-    
-    // Get surface formats
-    uint32_t formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount, nullptr);
-    std::vector<VkSurfaceFormatKHR> formats(formatCount);
-    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount, formats.data());
-    
-    // Get present modes
-    uint32_t presentModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, nullptr);
-    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, presentModes.data());
+    m_pipelineCacheWarm = false;
+    if (m_params.pipelineCacheDirectory.empty() || !vkCreatePipelineCache)
+        return;
     
-    // Choose swap surface format
-    VkSurfaceFormatKHR surfaceFormat = formats[0];
-    for (const auto& format : formats)
+    VkPhysicalDeviceIDProperties idProperties = {};
+    idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2 = {};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &idProperties;
+    vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+    const VkPhysicalDeviceProperties& properties = properties2.properties;
+    
+    // A driver update or a different GPU gets a fresh file instead of a rejected blob
+    std::ostringstream fileName;
+    fileName << "vk_pipeline_cache_" << std::hex << std::setfill('0');
+    for (uint8_t byte : idProperties.deviceUUID)
+        fileName << std::setw(2) << uint32_t(byte);
+    fileName << "_" << std::setw(8) << properties.driverVersion << ".bin";
+    m_pipelineCacheFile = (std::filesystem::path(m_params.pipelineCacheDirectory) / fileName.str()).string();
+    
+    std::vector<char> initialData;
+    std::ifstream file(m_pipelineCacheFile, std::ios::binary | std::ios::ate);
+    if (file.is_open())
     {
-        if (format.format == VK_FORMAT_B8G8R8A8_UNORM && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+        initialData.resize(size_t(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(initialData.data(), std::streamsize(initialData.size()));
+        
+        // Only hand the driver data whose header matches this device
+        VkPipelineCacheHeaderVersionOne header = {};
+        bool valid = file.good() && initialData.size() >= sizeof(header);
+        if (valid)
         {
-            surfaceFormat = format;
-            break;
+            std::memcpy(&header, initialData.data(), sizeof(header));
+            valid = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && header.vendorID == properties.vendorID
+                && header.deviceID == properties.deviceID
+                && std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
         }
-    }
-    m_swapChainFormat = nvrhi::Format::BGRA8_UNORM;
-    
-    // Choose present mode
-    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;  // Always available
-    if (!m_params.vsync)
-    {
-        for (const auto& mode : presentModes)
+        
+        if (!valid)
         {
-            if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
-            {
-                presentMode = mode;
-                break;
-            }
-            if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-            {
-                presentMode = mode;
-            }
+            std::cerr << "[Vulkan] Ignoring incompatible pipeline cache " << m_pipelineCacheFile << std::endl;
+            initialData.clear();
         }
     }
     
-    // Choose extent
-    VkExtent2D extent;
-    if (capabilities.currentExtent.width != UINT32_MAX)
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    
+    if (vkCreatePipelineCache(m_vkDevice, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
     {
-        extent = capabilities.currentExtent;
+        std::cerr << "[Vulkan] Failed to create pipeline cache" << std::endl;
+        m_pipelineCache = VK_NULL_HANDLE;
+        return;
     }
-    else
+    
+    m_pipelineCacheWarm = !initialData.empty();
+    if (m_pipelineCacheWarm)
     {
-        extent.width = std::clamp(m_windowWidth, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-        extent.height = std::clamp(m_windowHeight, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+        std::cout << "[Vulkan] Loaded pipeline cache (" << initialData.size() << " bytes)" << std::endl;
     }
-    m_windowWidth = extent.width;
-    m_windowHeight = extent.height;
-    
-    // Choose image count
-    uint32_t imageCount = m_params.swapChainBufferCount;
-    if (imageCount < capabilities.minImageCount)
-        imageCount = capabilities.minImageCount;
-    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
-        imageCount = capabilities.maxImageCount;
     
-    VkSwapchainCreateInfoKHR createInfo = {};
-    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-    createInfo.surface = m_surface;
-    createInfo.minImageCount = imageCount;
-    createInfo.imageFormat = surfaceFormat.format;
-    createInfo.imageColorSpace = surfaceFormat.colorSpace;
-    createInfo.imageExtent = extent;
-    createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-    
-    uint32_t queueFamilyIndices[] = { m_graphicsQueueFamily, m_presentQueueFamily };
-    if (m_graphicsQueueFamily != m_presentQueueFamily)
+    // Route NVRHI's pipeline creation through the cache
+    s_pipelineCache = m_pipelineCache;
+    if (VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateGraphicsPipelines != createGraphicsPipelinesWithCache)
     {
-        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-        createInfo.queueFamilyIndexCount = 2;
-        createInfo.pQueueFamilyIndices = queueFamilyIndices;
+        s_createGraphicsPipelines = VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateGraphicsPipelines;
+        VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateGraphicsPipelines = createGraphicsPipelinesWithCache;
     }
-    else
+    if (VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateComputePipelines != createComputePipelinesWithCache)
     {
-        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        s_createComputePipelines = VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateComputePipelines;
+        VULKAN_HPP_DEFAULT_DISPATCHER.vkCreateComputePipelines = createComputePipelinesWithCache;
     }
+}
+
+void DeviceManager_VK::savePipelineCache()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE || m_pipelineCacheFile.empty())
+        return;
     
-    createInfo.preTransform = capabilities.currentTransform;
-    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = presentMode;
-    createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
-    
-    if (vkCreateSwapchainKHR(m_vkDevice, &createInfo, nullptr, &m_swapChain) != VK_SUCCESS)
-    {
-        std::cerr << "[Vulkan] Failed to create swap chain" << std::endl;
-        return false;
-    }
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_vkDevice, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
     
-    // Get swap chain images
-    vkGetSwapchainImagesKHR(m_vkDevice, m_swapChain, &imageCount, nullptr);
-    m_swapChainImages.resize(imageCount);
-    vkGetSwapchainImagesKHR(m_vkDevice, m_swapChain, &imageCount, m_swapChainImages.data());
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_vkDevice, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
     
-    // Create synchronization semaphores
-    VkSemaphoreCreateInfo semaphoreInfo = {};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    // Write to a temporary file and rename so a crash never leaves a truncated cache
+    std::filesystem::path path(m_pipelineCacheFile);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
     
-    // Create present semaphores (one per swap chain image)
-    m_presentSemaphores.resize(imageCount);
-    for (uint32_t i = 0; i < imageCount; i++)
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
     {
-        if (vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &m_presentSemaphores[i]) != VK_SUCCESS)
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
         {
-            std::cerr << "[Vulkan] Failed to create present semaphore " << i << std::endl;
-            return false;
+            std::cerr << "[Vulkan] Failed to write pipeline cache " << tempPath.string() << std::endl;
+            return;
         }
+        file.write(data.data(), std::streamsize(dataSize));
     }
     
-    // Create acquire semaphores (need more than swap chain images for proper frame pipelining)
-    uint32_t acquireSemaphoreCount = std::max(imageCount, m_params.swapChainBufferCount + 1);
-    m_acquireSemaphores.resize(acquireSemaphoreCount);
-    for (uint32_t i = 0; i < acquireSemaphoreCount; i++)
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
     {
-        if (vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &m_acquireSemaphores[i]) != VK_SUCCESS)
-        {
-            std::cerr << "[Vulkan] Failed to create acquire semaphore " << i << std::endl;
-            return false;
-        }
+        std::cerr << "[Vulkan] Failed to write pipeline cache " << path.string() << std::endl;
     }
-    m_acquireSemaphoreIndex = 0;
+}
+
+void DeviceManager_VK::destroyPipelineCache()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE)
+        return;
+    
+    savePipelineCache();
     
-    return createRenderTargets();
+    // Pipelines created after this point (there should be none) go uncached
+    s_pipelineCache = VK_NULL_HANDLE;
+    vkDestroyPipelineCache(m_vkDevice, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+    m_pipelineCacheWarm = false;
+}
+
+bool DeviceManager_VK::createSwapChain()
+{
+    // Headless mode gets a swap chain without a window, which renders into an offscreen ring
+    if (!m_swapChain)
+    {
+        m_swapChain = std::make_unique<SwapChain_VK>(*this, m_params.headless ? nullptr : m_window,
+            m_surface, m_params.windowWidth, m_params.windowHeight);
+    }
+    return m_swapChain->create();
 }
 
 void DeviceManager_VK::destroySwapChain()
 {
-    destroyRenderTargets();
+    m_swapChain.reset();
+}
+
+bool DeviceManager_VK::resizeSwapChain(uint32_t width, uint32_t height)
+{
+    return m_swapChain && m_swapChain->resize(width, height);
+}
+
+ISwapChain* DeviceManager_VK::createWindowSwapChain(GLFWwindow* window)
+{
+    if (m_params.headless || !window)
+    {
+        std::cerr << "[Vulkan] Window swap chains need a window and are not available in headless mode" << std::endl;
+        return nullptr;
+    }
+    
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    auto swapChain = std::make_unique<SwapChain_VK>(*this, window, VK_NULL_HANDLE,
+        static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    if (!swapChain->create())
+        return nullptr;
+    
+    m_windowSwapChains.push_back(std::move(swapChain));
+    return m_windowSwapChains.back().get();
+}
+
+void DeviceManager_VK::destroyWindowSwapChain(ISwapChain* swapChain)
+{
+    auto it = std::find_if(m_windowSwapChains.begin(), m_windowSwapChains.end(),
+        [swapChain](const std::unique_ptr<SwapChain_VK>& candidate) { return candidate.get() == swapChain; });
+    if (it == m_windowSwapChains.end())
+        return;
     
-    // Destroy semaphores
-    for (auto semaphore : m_presentSemaphores)
+    // Its images may still be in use by frames in flight, and retired swap chains
+    // are released with it
+    waitForIdle();
+    m_windowSwapChains.erase(it);
+}
+
+void DeviceManager_VK::beginFrame()
+{
+    // A lost device is rebuilt before anything of this frame is recorded
+    if (m_deviceLost && !recoverDevice())
+        return;
+    
+    // Block only on the frame maxFramesInFlight frames back instead of draining the GPU,
+    // so recording this frame overlaps execution of the previous ones
+    uint64_t frameId = m_frameTracker.beginFrame();
+    uint32_t maxFramesInFlight = std::max(m_params.maxFramesInFlight, 1u);
+    if (frameId > maxFramesInFlight)
     {
-        if (semaphore != VK_NULL_HANDLE && vkDestroySemaphore)
-        {
-            vkDestroySemaphore(m_vkDevice, semaphore, nullptr);
-        }
+        m_frameTracker.waitForFrame(frameId - maxFramesInFlight);
+    }
+    m_frameTracker.update();
+    m_deletionQueue.update();
+    m_swapChain->releaseRetired(false);
+    for (const std::unique_ptr<SwapChain_VK>& swapChain : m_windowSwapChains)
+    {
+        swapChain->releaseRetired(false);
     }
-    m_presentSemaphores.clear();
     
-    for (auto semaphore : m_acquireSemaphores)
+    if (m_memoryBudgetCallback)
     {
-        if (semaphore != VK_NULL_HANDLE && vkDestroySemaphore)
-        {
-            vkDestroySemaphore(m_vkDevice, semaphore, nullptr);
-        }
+        m_memoryBudgetCallback(getMemoryStats());
+    }
+    
+    // Every acquire adds a wait to the frame's first submission. A window that cannot
+    // acquire (minimized, or a failed recreation) just skips this frame.
+    for (const std::unique_ptr<SwapChain_VK>& swapChain : m_windowSwapChains)
+    {
+        swapChain->acquire(frameId);
     }
-    m_acquireSemaphores.clear();
     
-    if (m_swapChain != VK_NULL_HANDLE && vkDestroySwapchainKHR)
+    if (!m_swapChain->acquire(frameId))
     {
-        vkDestroySwapchainKHR(m_vkDevice, m_swapChain, nullptr);
-        m_swapChain = VK_NULL_HANDLE;
+        std::cerr << "[Vulkan] Failed to acquire swap chain image" << std::endl;
     }
-    m_swapChainImages.clear();
 }
 
-bool DeviceManager_VK::resizeSwapChain(uint32_t width, uint32_t height)
+void DeviceManager_VK::present()
 {
-    if (width == 0 || height == 0)
-        return true;
+    // Copy the back buffer for capture as part of this frame's submissions. An image that
+    // was not acquired this frame is stale and must not be read.
+    if (m_swapChain->isAcquired())
+    {
+        m_frameCapture.recordFrame(getCurrentBackBuffer());
+    }
     
-    m_windowWidth = width;
-    m_windowHeight = height;
+    // Headless frames end with their last submission; there is no presentation engine
+    if (m_params.headless)
+    {
+        if (m_simulateDeviceLost)
+        {
+            m_simulateDeviceLost = false;
+            checkDeviceLost(VK_ERROR_DEVICE_LOST, "a simulated present");
+        }
+        
+        m_frameTracker.endFrame(m_frameTracker.getLastSubmissionId());
+        m_frameCapture.update();
+        runGarbageCollection();
+        limitFrameRate();
+        return;
+    }
     
-    waitForIdle();
-    destroySwapChain();
+    // Gather every acquired swap chain, primary first, so all windows go out in one
+    // vkQueuePresentKHR
+    m_presentSources.clear();
+    m_presentSwapChains.clear();
+    m_presentImageIndices.clear();
+    m_presentWaitSemaphores.clear();
+    m_presentIds.clear();
     
-    return createSwapChain();
-}
-
-bool DeviceManager_VK::createRenderTargets()
-{
-    uint32_t imageCount = static_cast<uint32_t>(m_swapChainImages.size());
-    m_swapChainTextures.resize(imageCount);
-    m_framebuffers.resize(imageCount);
+    auto addPresent = [this](SwapChain_VK* swapChain)
+    {
+        if (!swapChain->isAcquired())
+            return;
+        
+        // NVRHI signals the present semaphore once all commands are done
+        VkSemaphore presentSemaphore = swapChain->getPresentSemaphore();
+        m_nvrhiDevice->queueSignalSemaphore(nvrhi::CommandQueue::Graphics, presentSemaphore, 0);
+        
+        m_presentSources.push_back(swapChain);
+        m_presentSwapChains.push_back(swapChain->getHandle());
+        m_presentImageIndices.push_back(swapChain->getCurrentBackBufferIndex());
+        m_presentWaitSemaphores.push_back(presentSemaphore);
+        if (m_presentWaitSupported)
+        {
+            m_presentIds.push_back(swapChain->nextPresentId());
+        }
+    };
+    addPresent(m_swapChain.get());
+    for (const std::unique_ptr<SwapChain_VK>& swapChain : m_windowSwapChains)
+    {
+        addPresent(swapChain.get());
+    }
+    
+    // Execute any pending commands to actually signal the semaphores
+    uint64_t submissionId = m_nvrhiDevice->executeCommandLists(nullptr, 0);
     
-    for (uint32_t i = 0; i < imageCount; i++)
+    VkResult result = VK_SUCCESS;
+    if (!m_presentSources.empty())
     {
-        nvrhi::TextureDesc textureDesc = {};
-        textureDesc.width = m_windowWidth;
-        textureDesc.height = m_windowHeight;
-        textureDesc.format = m_swapChainFormat;
-        textureDesc.dimension = nvrhi::TextureDimension::Texture2D;
-        textureDesc.isRenderTarget = true;
-        textureDesc.initialState = nvrhi::ResourceStates::Present;
-        textureDesc.keepInitialState = true;
-        textureDesc.debugName = "SwapChainBuffer" + std::to_string(i);
+        uint32_t swapChainCount = static_cast<uint32_t>(m_presentSources.size());
+        m_presentResults.assign(swapChainCount, VK_SUCCESS);
         
-        m_swapChainTextures[i] = m_nvrhiDevice->createHandleForNativeTexture(
-            nvrhi::ObjectTypes::VK_Image,
-            nvrhi::Object(m_swapChainImages[i]),
-            textureDesc);
+        // Each swap chain waits on all of the frame's present semaphores, which are
+        // signalled by the same submission anyway
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = swapChainCount;
+        presentInfo.pWaitSemaphores = m_presentWaitSemaphores.data();
+        presentInfo.swapchainCount = swapChainCount;
+        presentInfo.pSwapchains = m_presentSwapChains.data();
+        presentInfo.pImageIndices = m_presentImageIndices.data();
+        presentInfo.pResults = m_presentResults.data();
         
-        if (!m_swapChainTextures[i])
+        VkPresentIdKHR presentIdInfo = {};
+        if (m_presentWaitSupported)
         {
-            std::cerr << "[Vulkan] Failed to create texture handle for swap chain buffer " << i << std::endl;
-            return false;
+            presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentIdInfo.swapchainCount = swapChainCount;
+            presentIdInfo.pPresentIds = m_presentIds.data();
+            presentInfo.pNext = &presentIdInfo;
         }
         
-        nvrhi::FramebufferDesc fbDesc = {};
-        fbDesc.addColorAttachment(m_swapChainTextures[i]);
+        result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
         
-        m_framebuffers[i] = m_device->createFramebuffer(fbDesc);
-        if (!m_framebuffers[i])
+        // The call returns the worst result; an out-of-date window must not hide a lost device
+        for (uint32_t i = 0; i < swapChainCount; i++)
         {
-            std::cerr << "[Vulkan] Failed to create framebuffer " << i << std::endl;
-            return false;
+            m_presentSources[i]->markPresented();
+            if (m_presentResults[i] == VK_ERROR_DEVICE_LOST)
+                result = VK_ERROR_DEVICE_LOST;
         }
     }
     
-    return true;
+    // Fault injection takes the same path as a real loss
+    if (m_simulateDeviceLost)
+    {
+        m_simulateDeviceLost = false;
+        result = VK_ERROR_DEVICE_LOST;
+    }
+    
+    // Out-of-date and suboptimal swap chains are recreated at the next acquire
+    checkDeviceLost(result, "vkQueuePresentKHR");
+    
+    // This frame retires once the timeline reaches its final submission; beginFrame()
+    // waits on it once maxFramesInFlight newer frames have been started
+    m_frameTracker.endFrame(submissionId);
+    m_frameCapture.update();
+    
+    // Releases only resources whose submissions have already completed
+    runGarbageCollection();
+    
+    limitFrameRate();
 }
 
-void DeviceManager_VK::destroyRenderTargets()
+void DeviceManager_VK::checkDeviceLost(VkResult result, const char* operation)
 {
-    m_framebuffers.clear();
-    m_swapChainTextures.clear();
+    if (result != VK_ERROR_DEVICE_LOST)
+        return;
+    
+    // Only the first report counts; everything after it fails the same way
+    if (!m_deviceLost.exchange(true))
+    {
+        m_recoveryStats.deviceLostCount++;
+        std::cerr << "[Vulkan] Device lost during " << operation << std::endl;
+    }
 }
 
-void DeviceManager_VK::beginFrame()
+bool DeviceManager_VK::recoverDevice()
 {
-    // Get the acquire semaphore for this frame
-    VkSemaphore acquireSemaphore = m_acquireSemaphores[m_acquireSemaphoreIndex];
+    auto start = std::chrono::steady_clock::now();
+    
+    // The application drops its handles first, so destroyDevice() releases the last references
+    if (m_recoveryCallbacks.onDeviceLost)
+    {
+        m_recoveryCallbacks.onDeviceLost();
+    }
     
-    // Acquire next image with semaphore
-    VkResult result = vkAcquireNextImageKHR(m_vkDevice, m_swapChain, UINT64_MAX,
-        acquireSemaphore, VK_NULL_HANDLE, &m_currentBackBuffer);
+    // Waits on a lost device return immediately, so the teardown does not hang
+    DeviceCreationParams params = m_params;
+    destroyDevice();
     
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    if (!createDevice(params))
     {
-        // Handle resize
-        int width, height;
-        glfwGetFramebufferSize(m_window, &width, &height);
-        resizeSwapChain(width, height);
-        return;
+        std::cerr << "[Vulkan] Failed to recreate the device after device loss" << std::endl;
+        return false;
     }
+    m_deviceLost = false;
     
-    // Advance acquire semaphore index for next frame
-    m_acquireSemaphoreIndex = (m_acquireSemaphoreIndex + 1) % static_cast<uint32_t>(m_acquireSemaphores.size());
+    if (m_recoveryCallbacks.onDeviceRestored && !m_recoveryCallbacks.onDeviceRestored())
+    {
+        std::cerr << "[Vulkan] Application resources could not be restored after device loss" << std::endl;
+        m_deviceLost = true;
+        return false;
+    }
     
-    // Tell NVRHI to wait on the acquire semaphore before executing any commands
-    // The semaphore will be waited on when the first command list is submitted
-    m_nvrhiDevice->queueWaitForSemaphore(nvrhi::CommandQueue::Graphics, acquireSemaphore, 0);
+    double recoveryTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_recoveryStats.recoveredCount++;
+    m_recoveryStats.lastRecoveryTimeMs = recoveryTimeMs;
+    m_recoveryStats.totalRecoveryTimeMs += recoveryTimeMs;
+    std::cout << "[Vulkan] Device recovered in " << recoveryTimeMs << " ms" << std::endl;
+    return true;
 }
 
-void DeviceManager_VK::present()
+void DeviceManager_VK::limitFrameRate()
 {
-    // Get the present semaphore for this swap chain image
-    VkSemaphore presentSemaphore = m_presentSemaphores[m_currentBackBuffer];
-    
-    // Tell NVRHI to signal the present semaphore when all commands are done
-    m_nvrhiDevice->queueSignalSemaphore(nvrhi::CommandQueue::Graphics, presentSemaphore, 0);
+    // Hold the CPU until the previous frame is on screen, so it never runs more than one
+    // frame ahead of the display, with or without a target rate. Windows present
+    // together, so the primary one paces them all.
+    if (m_presentWaitSupported && !m_params.headless)
+    {
+        const uint64_t timeoutNs = 100000000ull;
+        m_swapChain->waitForPreviousPresent(timeoutNs);
+    }
     
-    // Execute any pending commands to actually signal the semaphore
-    m_nvrhiDevice->executeCommandLists(nullptr, 0);
+    // Caps the rate below the refresh rate, and is the only limiter without present wait
+    if (m_frameLimiter.getTargetFrameRate() != 0)
+    {
+        m_frameLimiter.waitForNextFrame();
+    }
+}
+
+MemoryStats DeviceManager_VK::getMemoryStats()
+{
+    MemoryStats stats;
+    if (m_physicalDevice == VK_NULL_HANDLE)
+        return stats;
     
-    // Present with wait on the present semaphore
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &presentSemaphore;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &m_swapChain;
-    presentInfo.pImageIndices = &m_currentBackBuffer;
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
     
-    vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {};
+    memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    if (m_memoryBudgetSupported)
+    {
+        memoryProperties2.pNext = &budgetProperties;
+    }
+    vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memoryProperties2);
     
-    // Wait for GPU to finish all operations to ensure semaphores are available for reuse
-    // This is a simple approach - a more sophisticated implementation would use event queries
-    // to track frames in flight and only wait when necessary
-    m_nvrhiDevice->waitForIdle();
+    const VkPhysicalDeviceMemoryProperties& memoryProperties = memoryProperties2.memoryProperties;
+    stats.budgetSupported = m_memoryBudgetSupported;
+    stats.heaps.resize(memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        MemoryHeapStats& heap = stats.heaps[i];
+        heap.size = memoryProperties.memoryHeaps[i].size;
+        heap.deviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        
+        // The budget can exceed the heap size on some drivers; usage includes other
+        // allocations made by this process, not just NVRHI's
+        heap.budget = m_memoryBudgetSupported ? std::min(budgetProperties.heapBudget[i], heap.size) : heap.size;
+        heap.usage = m_memoryBudgetSupported ? budgetProperties.heapUsage[i] : 0;
+    }
     
-    runGarbageCollection();
+    return stats;
 }
 
 void DeviceManager_VK::waitForIdle()
@@ -815,32 +1372,96 @@ nvrhi::IDevice* DeviceManager_VK::getDevice() const
 
 nvrhi::IFramebuffer* DeviceManager_VK::getCurrentFramebuffer() const
 {
-    return m_framebuffers[m_currentBackBuffer].Get();
+    return m_swapChain->getCurrentFramebuffer();
 }
 
 nvrhi::ITexture* DeviceManager_VK::getCurrentBackBuffer() const
 {
-    return m_swapChainTextures[m_currentBackBuffer].Get();
+    return m_swapChain->getCurrentBackBuffer();
 }
 
-nvrhi::CommandListHandle DeviceManager_VK::createCommandList() const
+bool DeviceManager_VK::isBackBufferAcquired() const
 {
-    return m_device->createCommandList();
+    return m_swapChain->isAcquired();
 }
 
-void DeviceManager_VK::executeCommandList(nvrhi::ICommandList* commandList)
+nvrhi::CommandListHandle DeviceManager_VK::createCommandList(const nvrhi::CommandListParameters& params) const
 {
-    m_device->executeCommandLists(&commandList, 1);
+    if (hasDedicatedQueue(params.queueType))
+        return m_device->createCommandList(params);
+    
+    // Work meant for a missing queue is recorded for the graphics queue instead
+    nvrhi::CommandListParameters graphicsParams = params;
+    graphicsParams.setQueueType(nvrhi::CommandQueue::Graphics);
+    return m_device->createCommandList(graphicsParams);
+}
+
+uint64_t DeviceManager_VK::executeCommandList(nvrhi::ICommandList* commandList)
+{
+    return executeCommandLists(std::span<nvrhi::ICommandList* const>(&commandList, 1));
+}
+
+uint64_t DeviceManager_VK::executeCommandLists(std::span<nvrhi::ICommandList* const> commandLists,
+    nvrhi::CommandQueue queue)
+{
+    if (!hasDedicatedQueue(queue))
+        queue = nvrhi::CommandQueue::Graphics;
+    
+    // NVRHI records every list's command buffers into one vkQueueSubmit; the ID is a
+    // value on that queue's timeline semaphore
+    uint64_t submissionId = m_device->executeCommandLists(commandLists.data(), commandLists.size(), queue);
+    if (queue == nvrhi::CommandQueue::Graphics)
+    {
+        m_frameTracker.noteSubmission(submissionId);
+    }
+    return submissionId;
+}
+
+void DeviceManager_VK::queueWaitForSubmission(nvrhi::CommandQueue waitQueue,
+    nvrhi::CommandQueue executionQueue, uint64_t submissionId)
+{
+    if (!hasDedicatedQueue(waitQueue))
+        waitQueue = nvrhi::CommandQueue::Graphics;
+    if (!hasDedicatedQueue(executionQueue))
+        executionQueue = nvrhi::CommandQueue::Graphics;
+    
+    // Submissions on one queue already execute in order
+    if (waitQueue == executionQueue || submissionId == 0)
+        return;
+    
+    // Added to the wait semaphores of the next submission on waitQueue
+    m_device->queueWaitForCommandList(waitQueue, executionQueue, submissionId);
+}
+
+bool DeviceManager_VK::hasDedicatedQueue(nvrhi::CommandQueue queue) const
+{
+    switch (queue)
+    {
+    case nvrhi::CommandQueue::Graphics: return true;
+    case nvrhi::CommandQueue::Compute:  return m_computeQueue != VK_NULL_HANDLE;
+    case nvrhi::CommandQueue::Copy:     return m_transferQueue != VK_NULL_HANDLE;
+    default:                            return false;
+    }
 }
 
 uint32_t DeviceManager_VK::getCurrentBackBufferIndex() const
 {
-    return m_currentBackBuffer;
+    return m_swapChain->getCurrentBackBufferIndex();
 }
 
 uint32_t DeviceManager_VK::getBackBufferCount() const
 {
-    return static_cast<uint32_t>(m_swapChainImages.size());
+    return m_swapChain->getBackBufferCount();
+}
+
+PresentMode DeviceManager_VK::getPresentMode() const
+{
+    return m_swapChain ? m_swapChain->getPresentMode() : PresentMode::Fifo;
+}
+
+nvrhi::Format DeviceManager_VK::getSwapChainFormat() const
+{
+    return m_swapChain ? m_swapChain->getFormat() : nvrhi::Format::BGRA8_UNORM;
 }
 
 } // namespace common
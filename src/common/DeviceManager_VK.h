@@ -4,6 +4,8 @@
 #pragma once
 
 #include "DeviceManager.h"
+#include "SwapChain_VK.h"
+#include "VulkanFunctions.h"
 
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
@@ -11,6 +13,9 @@
 #include <nvrhi/vulkan.h>
 #include <nvrhi/validation.h>
 
+#include <atomic>
+#include <memory>
+
 namespace common
 {
     class DeviceManager_VK : public IDeviceManager
@@ -26,6 +31,8 @@ namespace common
         bool createSwapChain() override;
         void destroySwapChain() override;
         bool resizeSwapChain(uint32_t width, uint32_t height) override;
+        ISwapChain* createWindowSwapChain(GLFWwindow* window) override;
+        void destroyWindowSwapChain(ISwapChain* swapChain) override;
         
         void beginFrame() override;
         void present() override;
@@ -33,27 +40,62 @@ namespace common
         nvrhi::IDevice* getDevice() const override;
         nvrhi::IFramebuffer* getCurrentFramebuffer() const override;
         nvrhi::ITexture* getCurrentBackBuffer() const override;
-        nvrhi::CommandListHandle createCommandList() const override;
-        void executeCommandList(nvrhi::ICommandList* commandList) override;
+        bool isBackBufferAcquired() const override;
+        nvrhi::CommandListHandle createCommandList(
+            const nvrhi::CommandListParameters& params = nvrhi::CommandListParameters()) const override;
+        uint64_t executeCommandList(nvrhi::ICommandList* commandList) override;
+        uint64_t executeCommandLists(std::span<nvrhi::ICommandList* const> commandLists,
+            nvrhi::CommandQueue queue = nvrhi::CommandQueue::Graphics) override;
+        void queueWaitForSubmission(nvrhi::CommandQueue waitQueue,
+            nvrhi::CommandQueue executionQueue, uint64_t submissionId) override;
+        bool hasDedicatedQueue(nvrhi::CommandQueue queue) const override;
         void waitForIdle() override;
         void runGarbageCollection() override;
+        FrameTracker& getFrameTracker() override { return m_frameTracker; }
+        DeletionQueue& getDeletionQueue() override { return m_deletionQueue; }
+        FrameCapture& getFrameCapture() override { return m_frameCapture; }
+        FrameLimiter& getFrameLimiter() override { return m_frameLimiter; }
+        PresentMode getPresentMode() const override;
+        MemoryStats getMemoryStats() override;
+        void setMemoryBudgetCallback(MemoryBudgetCallback callback) override { m_memoryBudgetCallback = std::move(callback); }
+        void setDeviceRecoveryCallbacks(DeviceRecoveryCallbacks callbacks) override { m_recoveryCallbacks = std::move(callbacks); }
+        bool isDeviceLost() const override { return m_deviceLost; }
+        DeviceRecoveryStats getDeviceRecoveryStats() const override { return m_recoveryStats; }
+        void simulateDeviceLost() override { m_simulateDeviceLost = true; }
+        bool isPipelineCacheWarm() const override { return m_pipelineCacheWarm; }
+        bool isBindlessSupported() const override { return m_bindlessSupported; }
+        std::vector<AdapterInfo> enumerateAdapters() override;
         
         uint32_t getCurrentBackBufferIndex() const override;
         uint32_t getBackBufferCount() const override;
-        uint32_t getWindowWidth() const override { return m_windowWidth; }
-        uint32_t getWindowHeight() const override { return m_windowHeight; }
-        nvrhi::Format getSwapChainFormat() const override { return m_swapChainFormat; }
+        uint32_t getWindowWidth() const override { return m_swapChain ? m_swapChain->getWidth() : m_params.windowWidth; }
+        uint32_t getWindowHeight() const override { return m_swapChain ? m_swapChain->getHeight() : m_params.windowHeight; }
+        nvrhi::Format getSwapChainFormat() const override;
         GraphicsAPI getGraphicsAPI() const override { return GraphicsAPI::Vulkan; }
         const char* getGraphicsAPIName() const override { return "Vulkan"; }
 
     private:
+        // Swap chains reach into the device, queues and function pointers
+        friend class SwapChain_VK;
+        
         bool createInstance();
         bool createSurface();
         bool selectPhysicalDevice();
+        std::vector<AdapterInfo> queryAdapters(std::vector<VkPhysicalDevice>& physicalDevices);
         bool findQueueFamilies();
         bool createLogicalDevice();
-        bool createRenderTargets();
-        void destroyRenderTargets();
+        
+        // Present-wait and CPU frame rate cap, at the end of present()
+        void limitFrameRate();
+        
+        // Device-loss handling; recovery runs from beginFrame()
+        void checkDeviceLost(VkResult result, const char* operation);
+        bool recoverDevice();
+        
+        // Persistent pipeline cache
+        void createPipelineCache();
+        void savePipelineCache();
+        void destroyPipelineCache();
         
         // Vulkan function loading
         void loadVulkanFunctions();
@@ -64,9 +106,6 @@ namespace common
         // Creation params
         DeviceCreationParams m_params;
         GLFWwindow* m_window = nullptr;
-        uint32_t m_windowWidth = 0;
-        uint32_t m_windowHeight = 0;
-        nvrhi::Format m_swapChainFormat = nvrhi::Format::BGRA8_UNORM;
         
         // Vulkan objects
         VkInstance m_instance = VK_NULL_HANDLE;
@@ -76,63 +115,77 @@ namespace common
         VkDevice m_vkDevice = VK_NULL_HANDLE;
         VkQueue m_graphicsQueue = VK_NULL_HANDLE;
         VkQueue m_presentQueue = VK_NULL_HANDLE;
-        VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
+        VkQueue m_computeQueue = VK_NULL_HANDLE;
+        VkQueue m_transferQueue = VK_NULL_HANDLE;
+        
+        // Pipeline cache shared with NVRHI's pipeline creation, persisted across runs
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+        std::string m_pipelineCacheFile;
+        bool m_pipelineCacheWarm = false;
+        
+        // The primary window's swap chain (or headless ring), and additional windows.
+        // Window swap chains keep their objects across device recovery.
+        std::unique_ptr<SwapChain_VK> m_swapChain;
+        std::vector<std::unique_ptr<SwapChain_VK>> m_windowSwapChains;
         
-        // Synchronization semaphores
-        std::vector<VkSemaphore> m_acquireSemaphores;
-        std::vector<VkSemaphore> m_presentSemaphores;
-        uint32_t m_acquireSemaphoreIndex = 0;
+        // Scratch arrays for the batched vkQueuePresentKHR, reused every frame
+        std::vector<SwapChain_VK*> m_presentSources;
+        std::vector<VkSwapchainKHR> m_presentSwapChains;
+        std::vector<uint32_t> m_presentImageIndices;
+        std::vector<VkSemaphore> m_presentWaitSemaphores;
+        std::vector<uint64_t> m_presentIds;
+        std::vector<VkResult> m_presentResults;
+        
+        // Frame pacing and retirement on the GPU timeline
+        FrameTracker m_frameTracker;
+        DeletionQueue m_deletionQueue{ m_frameTracker };
+        FrameCapture m_frameCapture{ *this };
+        FrameLimiter m_frameLimiter;
+        
+        // VK_KHR_present_id/present_wait; present IDs are tracked per swap chain
+        bool m_presentWaitSupported = false;
+        
+        // VK_EXT_memory_budget, and the per-frame budget hook
+        bool m_memoryBudgetSupported = false;
+        MemoryBudgetCallback m_memoryBudgetCallback;
+        
+        // Descriptor indexing features enabled for bindless tables
+        bool m_bindlessSupported = false;
+        
+        // Set from any thread that sees VK_ERROR_DEVICE_LOST, including timeline waits
+        std::atomic<bool> m_deviceLost = false;
+        bool m_simulateDeviceLost = false;
+        DeviceRecoveryCallbacks m_recoveryCallbacks;
+        DeviceRecoveryStats m_recoveryStats;
         
         uint32_t m_graphicsQueueFamily = 0;
         uint32_t m_presentQueueFamily = 0;
+        uint32_t m_computeQueueFamily = UINT32_MAX;  // Compute-only family, if the device has one
+        uint32_t m_transferQueueFamily = UINT32_MAX;  // Transfer-only family, if the device has one
         
         // NVRHI objects
         DefaultMessageCallback m_messageCallback;
         nvrhi::vulkan::DeviceHandle m_nvrhiDevice;
         nvrhi::DeviceHandle m_device;  // May be validation layer or direct device
         
-        // Swap chain resources
-        std::vector<VkImage> m_swapChainImages;
-        std::vector<nvrhi::TextureHandle> m_swapChainTextures;
-        std::vector<nvrhi::FramebufferHandle> m_framebuffers;
-        uint32_t m_currentBackBuffer = 0;
-        
-        // Vulkan function pointers
+        // Vulkan function pointers, one member per entry in the VulkanFunctions.h tables
         PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+        VK_GLOBAL_FUNCTIONS(VK_DECLARE_FUNCTION)
+        VK_INSTANCE_FUNCTIONS(VK_DECLARE_FUNCTION)
+        VK_DEVICE_FUNCTIONS(VK_DECLARE_FUNCTION)
         
-        // Global functions
-        PFN_vkCreateInstance vkCreateInstance = nullptr;
-        PFN_vkEnumerateInstanceExtensionProperties vkEnumerateInstanceExtensionProperties = nullptr;
-        PFN_vkEnumerateInstanceLayerProperties vkEnumerateInstanceLayerProperties = nullptr;
-        
-        // Instance functions
-        PFN_vkDestroyInstance vkDestroyInstance = nullptr;
-        PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices = nullptr;
-        PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties = nullptr;
-        PFN_vkGetPhysicalDeviceFeatures vkGetPhysicalDeviceFeatures = nullptr;
-        PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties = nullptr;
-        PFN_vkCreateDevice vkCreateDevice = nullptr;
-        PFN_vkDestroySurfaceKHR vkDestroySurfaceKHR = nullptr;
-        PFN_vkGetPhysicalDeviceSurfaceSupportKHR vkGetPhysicalDeviceSurfaceSupportKHR = nullptr;
-        PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR vkGetPhysicalDeviceSurfaceCapabilitiesKHR = nullptr;
-        PFN_vkGetPhysicalDeviceSurfaceFormatsKHR vkGetPhysicalDeviceSurfaceFormatsKHR = nullptr;
-        PFN_vkGetPhysicalDeviceSurfacePresentModesKHR vkGetPhysicalDeviceSurfacePresentModesKHR = nullptr;
-        PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties = nullptr;
-        PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT = nullptr;
-        PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXT = nullptr;
-        
-        // Device functions
-        PFN_vkDestroyDevice vkDestroyDevice = nullptr;
-        PFN_vkGetDeviceQueue vkGetDeviceQueue = nullptr;
-        PFN_vkCreateSwapchainKHR vkCreateSwapchainKHR = nullptr;
-        PFN_vkDestroySwapchainKHR vkDestroySwapchainKHR = nullptr;
-        PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR = nullptr;
-        PFN_vkAcquireNextImageKHR vkAcquireNextImageKHR = nullptr;
-        PFN_vkQueuePresentKHR vkQueuePresentKHR = nullptr;
-        PFN_vkCreateSemaphore vkCreateSemaphore = nullptr;
-        PFN_vkDestroySemaphore vkDestroySemaphore = nullptr;
-        PFN_vkDeviceWaitIdle vkDeviceWaitIdle = nullptr;
-        PFN_vkQueueWaitIdle vkQueueWaitIdle = nullptr;
+        // Time spent resolving entry points during createDevice(), logged once it succeeds.
+        // Instance and device times include initializing the vulkan.hpp dispatcher.
+        struct LoaderStats
+        {
+            double loaderTimeMs = 0.0;  // Opening the loader library, cached after the first call
+            double globalTimeMs = 0.0;
+            double instanceTimeMs = 0.0;
+            double deviceTimeMs = 0.0;
+            uint32_t functionsLoaded = 0;
+            uint32_t functionsMissing = 0;  // Extension functions the implementation does not expose
+        };
+        LoaderStats m_loaderStats;
     };
 
 } // namespace common
@@ -0,0 +1,560 @@
+// FrameCapture.cpp
+// Asynchronous back buffer readback to PNG/EXR files
+
+#include "FrameCapture.h"
+#include "DeviceManager.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace common
+{
+
+static constexpr uint32_t EncoderThreadCount = 2;
+
+static float halfToFloat(uint16_t value)
+{
+    uint32_t sign = (value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Denormal: renormalize into a float exponent
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+        }
+    }
+    else if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+static uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = int32_t((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (((bits >> 23) & 0xffu) == 0xffu)
+        return uint16_t(sign | 0x7c00u | (mantissa ? 0x200u : 0u));  // Inf / NaN
+    if (exponent >= 0x1f)
+        return uint16_t(sign | 0x7c00u);  // Overflow to infinity
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return uint16_t(sign);
+        mantissa = (mantissa | 0x800000u) >> (1 - exponent);
+        return uint16_t(sign | ((mantissa + 0x1000u) >> 13));
+    }
+
+    // Round to nearest; a carry out of the mantissa correctly bumps the exponent
+    return uint16_t(sign | ((uint32_t(exponent) << 10) + ((mantissa + 0x1000u) >> 13)));
+}
+
+// Write an uncompressed scanline OpenEXR file with half-float RGBA channels.
+// The vendored tinyexr header is missing its exr_reader.hh dependency, and an
+// uncompressed writer is all a capture path needs.
+static bool writeEXR(const std::string& path, const std::vector<float>& rgba, uint32_t width, uint32_t height)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::vector<uint8_t> header;
+    auto put = [&header](const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        header.insert(header.end(), bytes, bytes + size);
+    };
+    auto putInt = [&put](int32_t value) { put(&value, sizeof(value)); };
+    auto putFloat = [&put](float value) { put(&value, sizeof(value)); };
+    auto putString = [&put](const char* text) { put(text, std::strlen(text) + 1); };
+    auto putAttribute = [&](const char* name, const char* type, int32_t size)
+    {
+        putString(name);
+        putString(type);
+        putInt(size);
+    };
+
+    const uint32_t magic = 20000630;
+    const int32_t version = 2;
+    put(&magic, sizeof(magic));
+    putInt(version);
+
+    // Channels must be listed alphabetically; this is also their order within a scanline
+    static const char* channelNames[] = { "A", "B", "G", "R" };
+    static const int channelSource[] = { 3, 2, 1, 0 };
+    const int32_t halfPixelType = 1;
+
+    putAttribute("channels", "chlist", 4 * (2 + 16) + 1);
+    for (const char* channel : channelNames)
+    {
+        putString(channel);
+        putInt(halfPixelType);
+        const uint8_t linearAndReserved[4] = {};
+        put(linearAndReserved, sizeof(linearAndReserved));
+        putInt(1);  // xSampling
+        putInt(1);  // ySampling
+    }
+    header.push_back(0);
+
+    const uint8_t noCompression = 0;
+    putAttribute("compression", "compression", 1);
+    put(&noCompression, 1);
+
+    int32_t window[4] = { 0, 0, int32_t(width) - 1, int32_t(height) - 1 };
+    putAttribute("dataWindow", "box2i", sizeof(window));
+    put(window, sizeof(window));
+    putAttribute("displayWindow", "box2i", sizeof(window));
+    put(window, sizeof(window));
+
+    const uint8_t increasingY = 0;
+    putAttribute("lineOrder", "lineOrder", 1);
+    put(&increasingY, 1);
+
+    putAttribute("pixelAspectRatio", "float", 4);
+    putFloat(1.0f);
+    putAttribute("screenWindowCenter", "v2f", 8);
+    putFloat(0.0f);
+    putFloat(0.0f);
+    putAttribute("screenWindowWidth", "float", 4);
+    putFloat(1.0f);
+    header.push_back(0);
+
+    // Offset table: one uncompressed scanline per block
+    const uint32_t lineBytes = width * 4 * sizeof(uint16_t);
+    const uint64_t blockBytes = 2 * sizeof(int32_t) + lineBytes;
+    uint64_t firstBlock = header.size() + uint64_t(height) * sizeof(uint64_t);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint64_t offset = firstBlock + y * blockBytes;
+        put(&offset, sizeof(offset));
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+
+    std::vector<uint16_t> line(size_t(width) * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (int channel = 0; channel < 4; channel++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                line[channel * width + x] = floatToHalf(rgba[(size_t(y) * width + x) * 4 + channelSource[channel]]);
+            }
+        }
+
+        int32_t blockHeader[2] = { int32_t(y), int32_t(lineBytes) };
+        file.write(reinterpret_cast<const char*>(blockHeader), sizeof(blockHeader));
+        file.write(reinterpret_cast<const char*>(line.data()), lineBytes);
+    }
+
+    return file.good();
+}
+
+// Expand a packed image to RGBA float; returns false for formats we cannot encode
+static bool convertToFloatRGBA(const uint8_t* pixels, uint32_t pixelCount, nvrhi::Format format, std::vector<float>& out)
+{
+    out.resize(size_t(pixelCount) * 4);
+
+    switch (format)
+    {
+    case nvrhi::Format::RGBA8_UNORM:
+    case nvrhi::Format::SRGBA8_UNORM:
+    case nvrhi::Format::BGRA8_UNORM:
+    case nvrhi::Format::SBGRA8_UNORM:
+    {
+        bool bgra = format == nvrhi::Format::BGRA8_UNORM || format == nvrhi::Format::SBGRA8_UNORM;
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            const uint8_t* src = pixels + i * 4;
+            out[i * 4 + 0] = src[bgra ? 2 : 0] / 255.0f;
+            out[i * 4 + 1] = src[1] / 255.0f;
+            out[i * 4 + 2] = src[bgra ? 0 : 2] / 255.0f;
+            out[i * 4 + 3] = src[3] / 255.0f;
+        }
+        return true;
+    }
+    case nvrhi::Format::RGBA16_FLOAT:
+    {
+        const uint16_t* src = reinterpret_cast<const uint16_t*>(pixels);
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            out[i] = halfToFloat(src[i]);
+        }
+        return true;
+    }
+    case nvrhi::Format::RGBA32_FLOAT:
+        std::memcpy(out.data(), pixels, out.size() * sizeof(float));
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Convert a packed image to RGBA8; returns false for formats we cannot encode
+static bool convertToRGBA8(const uint8_t* pixels, uint32_t pixelCount, nvrhi::Format format, std::vector<uint8_t>& out)
+{
+    out.resize(size_t(pixelCount) * 4);
+
+    switch (format)
+    {
+    case nvrhi::Format::RGBA8_UNORM:
+    case nvrhi::Format::SRGBA8_UNORM:
+        std::memcpy(out.data(), pixels, out.size());
+        return true;
+    case nvrhi::Format::BGRA8_UNORM:
+    case nvrhi::Format::SBGRA8_UNORM:
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            out[i * 4 + 0] = pixels[i * 4 + 2];
+            out[i * 4 + 1] = pixels[i * 4 + 1];
+            out[i * 4 + 2] = pixels[i * 4 + 0];
+            out[i * 4 + 3] = pixels[i * 4 + 3];
+        }
+        return true;
+    default:
+    {
+        std::vector<float> floats;
+        if (!convertToFloatRGBA(pixels, pixelCount, format, floats))
+            return false;
+
+        for (size_t i = 0; i < floats.size(); i++)
+        {
+            out[i] = static_cast<uint8_t>(std::clamp(floats[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+        return true;
+    }
+    }
+}
+
+FrameCapture::FrameCapture(IDeviceManager& deviceManager)
+    : m_deviceManager(deviceManager)
+{
+    // Constructed as a member of the device manager, so do not call back into it here
+    m_slots.resize(3);
+}
+
+FrameCapture::~FrameCapture()
+{
+    // Encoders may still be writing; the pool destructor drains its queue
+    m_encoders.reset();
+}
+
+void FrameCapture::setRingSize(uint32_t ringSize)
+{
+    // Pending slots keep their own staging texture until they are read back
+    flush();
+    m_slots.clear();
+    m_slots.resize(std::max(ringSize, 1u));
+    m_nextSlot = 0;
+}
+
+void FrameCapture::captureNextFrame(const std::string& path)
+{
+    m_singleFramePath = path;
+}
+
+bool FrameCapture::startSequence(const std::string& pattern)
+{
+    std::string path;
+    if (!formatSequencePath(pattern, 0, path))
+    {
+        std::cerr << "[FrameCapture] Sequence pattern needs exactly one %u or %d conversion: " << pattern << std::endl;
+        return false;
+    }
+
+    m_sequencePattern = pattern;
+    m_sequenceIndex = 0;
+    return true;
+}
+
+void FrameCapture::stopSequence()
+{
+    m_sequencePattern.clear();
+}
+
+bool FrameCapture::isCapturing() const
+{
+    return !m_singleFramePath.empty() || !m_sequencePattern.empty();
+}
+
+bool FrameCapture::formatSequencePath(const std::string& pattern, uint32_t index, std::string& path)
+{
+    path.clear();
+    bool converted = false;
+
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%')
+        {
+            path += pattern[i];
+            continue;
+        }
+
+        if (++i >= pattern.size())
+            return false;
+
+        if (pattern[i] == '%')
+        {
+            path += '%';
+            continue;
+        }
+
+        // %[0][width](u|d), nothing else
+        bool zeroPad = pattern[i] == '0';
+        if (zeroPad)
+            i++;
+
+        size_t width = 0;
+        while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i])) && width < 100)
+        {
+            width = width * 10 + static_cast<size_t>(pattern[i] - '0');
+            i++;
+        }
+
+        if (converted || i >= pattern.size() || (pattern[i] != 'u' && pattern[i] != 'd'))
+            return false;
+
+        std::string number = std::to_string(index);
+        if (number.size() < width)
+            path.append(width - number.size(), zeroPad ? '0' : ' ');
+        path += number;
+        converted = true;
+    }
+
+    return converted;
+}
+
+void FrameCapture::recordFrame(nvrhi::ITexture* backBuffer)
+{
+    if (!isCapturing() || !backBuffer)
+        return;
+
+    std::string path;
+    if (!m_singleFramePath.empty())
+    {
+        path = std::move(m_singleFramePath);
+        m_singleFramePath.clear();
+    }
+    else
+    {
+        formatSequencePath(m_sequencePattern, m_sequenceIndex++, path);
+    }
+
+    nvrhi::IDevice* device = m_deviceManager.getDevice();
+    if (!m_commandList)
+    {
+        m_commandList = m_deviceManager.createCommandList();
+    }
+
+    // With the ring sized above the frames in flight this slot has already retired;
+    // otherwise wait for its copy only, never for the whole device
+    Slot& slot = m_slots[m_nextSlot];
+    m_nextSlot = (m_nextSlot + 1) % static_cast<uint32_t>(m_slots.size());
+
+    if (slot.pending)
+    {
+        if (!m_deviceManager.getFrameTracker().waitForSubmission(slot.submissionId))
+        {
+            std::cerr << "[FrameCapture] Previous copy in slot cannot be waited on, skipping " << path << std::endl;
+            m_framesFailed++;
+            return;
+        }
+        readback(slot);
+    }
+
+    const nvrhi::TextureDesc& backBufferDesc = backBuffer->getDesc();
+    if (!slot.stagingTexture
+        || slot.stagingTexture->getDesc().width != backBufferDesc.width
+        || slot.stagingTexture->getDesc().height != backBufferDesc.height
+        || slot.stagingTexture->getDesc().format != backBufferDesc.format)
+    {
+        nvrhi::TextureDesc stagingDesc = {};
+        stagingDesc.width = backBufferDesc.width;
+        stagingDesc.height = backBufferDesc.height;
+        stagingDesc.format = backBufferDesc.format;
+        stagingDesc.dimension = nvrhi::TextureDimension::Texture2D;
+        stagingDesc.debugName = "FrameCaptureStaging";
+
+        slot.stagingTexture = device->createStagingTexture(stagingDesc, nvrhi::CpuAccessMode::Read);
+        if (!slot.stagingTexture)
+        {
+            std::cerr << "[FrameCapture] Failed to create staging texture" << std::endl;
+            m_framesFailed++;
+            return;
+        }
+    }
+
+    m_commandList->open();
+    m_commandList->copyTexture(slot.stagingTexture, nvrhi::TextureSlice(), backBuffer, nvrhi::TextureSlice());
+    m_commandList->close();
+
+    slot.submissionId = m_deviceManager.executeCommandList(m_commandList);
+    slot.path = std::move(path);
+    slot.pending = true;
+}
+
+void FrameCapture::update()
+{
+    FrameTracker& frameTracker = m_deviceManager.getFrameTracker();
+
+    for (Slot& slot : m_slots)
+    {
+        if (slot.pending && frameTracker.isSubmissionRetired(slot.submissionId))
+        {
+            readback(slot);
+        }
+    }
+}
+
+void FrameCapture::flush()
+{
+    for (Slot& slot : m_slots)
+    {
+        if (slot.pending && m_deviceManager.getFrameTracker().waitForSubmission(slot.submissionId))
+        {
+            readback(slot);
+        }
+    }
+
+    if (m_encoders)
+    {
+        m_encoders->waitIdle();
+    }
+}
+
+void FrameCapture::shutdown()
+{
+    flush();
+
+    for (Slot& slot : m_slots)
+    {
+        slot.stagingTexture = nullptr;
+    }
+    m_commandList = nullptr;
+    m_singleFramePath.clear();
+    m_sequencePattern.clear();
+}
+
+void FrameCapture::readback(Slot& slot)
+{
+    slot.pending = false;
+
+    nvrhi::IDevice* device = m_deviceManager.getDevice();
+    const nvrhi::TextureDesc& desc = slot.stagingTexture->getDesc();
+
+    size_t rowPitch = 0;
+    const uint8_t* mapped = static_cast<const uint8_t*>(device->mapStagingTexture(
+        slot.stagingTexture, nvrhi::TextureSlice(), nvrhi::CpuAccessMode::Read, &rowPitch));
+
+    if (!mapped)
+    {
+        std::cerr << "[FrameCapture] Failed to map staging texture for " << slot.path << std::endl;
+        m_framesFailed++;
+        return;
+    }
+
+    // Only the copy out of the mapped memory happens on the render thread
+    auto image = std::make_shared<CapturedImage>();
+    image->width = desc.width;
+    image->height = desc.height;
+    image->format = desc.format;
+
+    size_t rowBytes = size_t(desc.width) * nvrhi::getFormatInfo(desc.format).bytesPerBlock;
+    image->pixels.resize(rowBytes * desc.height);
+    for (uint32_t y = 0; y < desc.height; y++)
+    {
+        std::memcpy(image->pixels.data() + y * rowBytes, mapped + y * rowPitch, rowBytes);
+    }
+
+    device->unmapStagingTexture(slot.stagingTexture);
+
+    if (!m_encoders)
+    {
+        m_encoders = std::make_unique<ThreadPool>(EncoderThreadCount);
+    }
+
+    m_encoders->submit([this, image, path = slot.path]()
+    {
+        encode(*image, path);
+    });
+}
+
+void FrameCapture::encode(const CapturedImage& image, const std::string& path)
+{
+    std::filesystem::path filePath(path);
+    if (filePath.has_parent_path())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(filePath.parent_path(), ec);
+    }
+
+    std::string extension = filePath.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    uint32_t pixelCount = image.width * image.height;
+    bool success = false;
+
+    if (extension == ".exr")
+    {
+        std::vector<float> rgba;
+        if (convertToFloatRGBA(image.pixels.data(), pixelCount, image.format, rgba))
+        {
+            success = writeEXR(path, rgba, image.width, image.height);
+        }
+    }
+    else
+    {
+        std::vector<uint8_t> rgba;
+        if (convertToRGBA8(image.pixels.data(), pixelCount, image.format, rgba))
+        {
+            success = stbi_write_png(path.c_str(), int(image.width), int(image.height), 4,
+                rgba.data(), int(image.width * 4)) != 0;
+        }
+    }
+
+    if (success)
+    {
+        m_framesWritten++;
+    }
+    else
+    {
+        std::cerr << "[FrameCapture] Failed to write " << path << std::endl;
+        m_framesFailed++;
+    }
+}
+
+} // namespace common
@@ -0,0 +1,101 @@
+// FrameCapture.h
+// Asynchronous back buffer readback to PNG/EXR files
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // Copies the back buffer into a ring of CPU-readable staging textures and maps each one
+    // only after the GPU has retired its copy, so capturing every frame never stalls the
+    // render loop. Encoding and file I/O happen on worker threads.
+    //
+    // The file format follows the path extension: ".exr" writes half-float OpenEXR,
+    // anything else writes PNG. All methods are called from the render thread.
+    class FrameCapture
+    {
+    public:
+        explicit FrameCapture(IDeviceManager& deviceManager);
+        ~FrameCapture();
+
+        // Ring size should exceed the number of frames in flight so a slot has always
+        // retired by the time it is reused
+        void setRingSize(uint32_t ringSize);
+
+        // Capture requests
+        void captureNextFrame(const std::string& path);
+        // Capture every frame; pattern is a path with exactly one %u or %d conversion,
+        // optionally zero-padded, for the sequence number, e.g. "capture/frame_%05u.png".
+        // "%%" is a literal percent sign. Returns false for any other pattern.
+        bool startSequence(const std::string& pattern);
+        void stopSequence();
+        bool isCapturing() const;
+
+        // Expands a sequence pattern without handing it to printf, so any text is safe
+        static bool formatSequencePath(const std::string& pattern, uint32_t index, std::string& path);
+
+        // Called by the device manager before the frame's final submission
+        void recordFrame(nvrhi::ITexture* backBuffer);
+
+        // Map readbacks whose copy has retired and hand them to the encoder threads
+        void update();
+
+        // Block until every outstanding capture is written to disk
+        void flush();
+
+        // Flush and release GPU resources before the device is destroyed
+        void shutdown();
+
+        uint64_t getFramesWritten() const { return m_framesWritten; }
+        uint64_t getFramesFailed() const { return m_framesFailed; }
+
+    private:
+        struct Slot
+        {
+            nvrhi::StagingTextureHandle stagingTexture;
+            uint64_t submissionId = 0;
+            std::string path;
+            bool pending = false;
+        };
+
+        // Tightly packed copy of a mapped staging texture
+        struct CapturedImage
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            nvrhi::Format format = nvrhi::Format::UNKNOWN;
+            std::vector<uint8_t> pixels;
+        };
+
+        void readback(Slot& slot);
+        void encode(const CapturedImage& image, const std::string& path);
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::CommandListHandle m_commandList;
+
+        std::vector<Slot> m_slots;
+        uint32_t m_nextSlot = 0;
+
+        std::string m_singleFramePath;
+        std::string m_sequencePattern;
+        uint32_t m_sequenceIndex = 0;
+
+        // Created on first capture so idle managers do not own encoder threads
+        std::unique_ptr<ThreadPool> m_encoders;
+
+        std::atomic<uint64_t> m_framesWritten = 0;
+        std::atomic<uint64_t> m_framesFailed = 0;
+    };
+
+} // namespace common
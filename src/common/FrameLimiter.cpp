@@ -0,0 +1,92 @@
+// FrameLimiter.cpp
+// CPU-side frame rate cap with high-resolution sleeping
+
+#include "FrameLimiter.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace common
+{
+
+// Sleeps are cut short by this much and the rest is spun out, since schedulers can
+// oversleep by about a timer tick
+static constexpr std::chrono::microseconds SpinThreshold(1500);
+
+FrameLimiter::FrameLimiter()
+{
+#ifdef _WIN32
+    // Without the high-resolution flag waitable timers tick at 15.6 ms
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+    if (m_timer)
+        CloseHandle(m_timer);
+#endif
+}
+
+void FrameLimiter::setTargetFrameRate(uint32_t framesPerSecond)
+{
+    m_targetFrameRate = framesPerSecond;
+    m_frameInterval = framesPerSecond > 0
+        ? std::chrono::nanoseconds(1000000000ull / framesPerSecond)
+        : std::chrono::nanoseconds(0);
+    m_nextFrameTime = {};
+}
+
+std::chrono::nanoseconds FrameLimiter::waitForNextFrame()
+{
+    if (m_targetFrameRate == 0)
+        return std::chrono::nanoseconds(0);
+
+    auto now = std::chrono::steady_clock::now();
+
+    // First frame, or more than a frame late: start a new schedule from now
+    if (m_nextFrameTime.time_since_epoch().count() == 0 || now - m_nextFrameTime > m_frameInterval)
+    {
+        m_nextFrameTime = now + m_frameInterval;
+        return std::chrono::nanoseconds(0);
+    }
+
+    sleepUntil(m_nextFrameTime);
+    m_nextFrameTime += m_frameInterval;
+    return std::chrono::steady_clock::now() - now;
+}
+
+void FrameLimiter::sleepUntil(std::chrono::steady_clock::time_point deadline)
+{
+    auto coarseDeadline = deadline - SpinThreshold;
+    auto now = std::chrono::steady_clock::now();
+    if (now < coarseDeadline)
+    {
+#ifdef _WIN32
+        if (m_timer)
+        {
+            // Relative due time in 100 ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(coarseDeadline - now).count() / 100);
+            if (SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE))
+                WaitForSingleObject(m_timer, INFINITE);
+        }
+        else
+#endif
+        {
+            std::this_thread::sleep_until(coarseDeadline);
+        }
+    }
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace common
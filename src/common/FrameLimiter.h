@@ -0,0 +1,46 @@
+// FrameLimiter.h
+// CPU-side frame rate cap with high-resolution sleeping
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace common
+{
+    // Paces frame starts to a target rate against absolute deadlines, so sleep overshoot
+    // does not accumulate. A frame that misses its deadline by more than a whole interval
+    // restarts the schedule instead of rushing the following frames to catch up.
+    //
+    // Called right after present, the wait happens before the application samples input
+    // for the next frame, which keeps input-to-photon latency at one frame of work.
+    class FrameLimiter
+    {
+    public:
+        FrameLimiter();
+        ~FrameLimiter();
+
+        FrameLimiter(const FrameLimiter&) = delete;
+        FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+        // 0 disables the limiter
+        void setTargetFrameRate(uint32_t framesPerSecond);
+        uint32_t getTargetFrameRate() const { return m_targetFrameRate; }
+
+        // Block until the next frame is due; returns the time slept
+        std::chrono::nanoseconds waitForNextFrame();
+
+    private:
+        void sleepUntil(std::chrono::steady_clock::time_point deadline);
+
+    private:
+        uint32_t m_targetFrameRate = 0;
+        std::chrono::nanoseconds m_frameInterval{ 0 };
+        std::chrono::steady_clock::time_point m_nextFrameTime;
+
+#ifdef _WIN32
+        void* m_timer = nullptr;  // High-resolution waitable timer
+#endif
+    };
+
+} // namespace common
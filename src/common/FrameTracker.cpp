@@ -0,0 +1,250 @@
+// FrameTracker.cpp
+// Backend-neutral frame and submission tracking on a monotonic GPU timeline
+
+#include "FrameTracker.h"
+
+#include <algorithm>
+
+namespace common
+{
+
+void FrameTracker::setTimeline(Timeline timeline)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timeline = std::move(timeline);
+}
+
+void FrameTracker::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timeline = {};
+    m_currentFrameId = 0;
+    m_frameOpen = false;
+    m_lastSubmissionId = 0;
+    m_completedSubmissionId = 0;
+    m_frameSubmissions.clear();
+    m_lastRetiredFrameId = 0;
+    m_submissionCallbacks.clear();
+    m_frameCallbacks.clear();
+    m_readyCallbacks.clear();
+}
+
+uint64_t FrameTracker::beginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A frame that was never presented still owns whatever was submitted during it
+    if (m_frameOpen)
+    {
+        endFrameLocked(m_lastSubmissionId);
+    }
+
+    m_currentFrameId++;
+    m_frameOpen = true;
+    return m_currentFrameId;
+}
+
+void FrameTracker::endFrame(uint64_t submissionId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_frameOpen)
+    {
+        endFrameLocked(submissionId);
+    }
+}
+
+void FrameTracker::endFrameLocked(uint64_t submissionId)
+{
+    m_lastSubmissionId = std::max(m_lastSubmissionId, submissionId);
+    m_frameSubmissions.emplace_back(m_currentFrameId, m_lastSubmissionId);
+    m_frameOpen = false;
+
+    // Frame callbacks now know which submission they are waiting for
+    auto end = m_frameCallbacks.upper_bound(m_currentFrameId);
+    for (auto it = m_frameCallbacks.begin(); it != end; ++it)
+    {
+        m_submissionCallbacks.emplace(m_lastSubmissionId, std::move(it->second));
+    }
+    m_frameCallbacks.erase(m_frameCallbacks.begin(), end);
+}
+
+void FrameTracker::noteSubmission(uint64_t submissionId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastSubmissionId = std::max(m_lastSubmissionId, submissionId);
+}
+
+uint64_t FrameTracker::getCurrentFrameId() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentFrameId;
+}
+
+bool FrameTracker::isFrameOpen() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameOpen;
+}
+
+uint64_t FrameTracker::getReleaseFrameId() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameOpen ? m_currentFrameId : m_currentFrameId + 1;
+}
+
+uint64_t FrameTracker::getLastSubmissionId() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastSubmissionId;
+}
+
+uint64_t FrameTracker::pollCompleted()
+{
+    std::function<uint64_t()> getCompletedValue;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        getCompletedValue = m_timeline.getCompletedValue;
+    }
+
+    // Query the timeline without holding the lock; it is a cheap counter read
+    uint64_t completed = getCompletedValue ? getCompletedValue() : 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_completedSubmissionId = std::max(m_completedSubmissionId, completed);
+    return m_completedSubmissionId;
+}
+
+uint64_t FrameTracker::getCompletedSubmissionId()
+{
+    return pollCompleted();
+}
+
+bool FrameTracker::isSubmissionRetired(uint64_t submissionId)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (submissionId <= m_completedSubmissionId)
+            return true;
+    }
+    return submissionId <= pollCompleted();
+}
+
+uint64_t FrameTracker::frameSubmissionLocked(uint64_t frameId) const
+{
+    if (frameId <= m_lastRetiredFrameId)
+        return 0;
+
+    if (!m_frameSubmissions.empty() && frameId >= m_frameSubmissions.front().first
+        && frameId <= m_frameSubmissions.back().first)
+    {
+        return m_frameSubmissions[frameId - m_frameSubmissions.front().first].second;
+    }
+
+    // The frame is still being recorded (or has not started)
+    return UINT64_MAX;
+}
+
+bool FrameTracker::isFrameRetired(uint64_t frameId)
+{
+    uint64_t submissionId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        submissionId = frameSubmissionLocked(frameId);
+    }
+
+    if (submissionId == UINT64_MAX)
+        return false;
+
+    return isSubmissionRetired(submissionId);
+}
+
+bool FrameTracker::waitForSubmission(uint64_t submissionId)
+{
+    std::function<void(uint64_t)> waitForValue;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (submissionId <= m_completedSubmissionId)
+            return true;
+        waitForValue = m_timeline.waitForValue;
+    }
+
+    // Nothing to wait on, e.g. during device recovery; the work must not count as done
+    if (!waitForValue)
+        return false;
+
+    waitForValue(submissionId);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_completedSubmissionId = std::max(m_completedSubmissionId, submissionId);
+    return true;
+}
+
+bool FrameTracker::waitForFrame(uint64_t frameId)
+{
+    uint64_t submissionId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        submissionId = frameSubmissionLocked(frameId);
+
+        // Waiting on a frame that has not ended can only mean "everything so far"
+        if (submissionId == UINT64_MAX)
+            submissionId = m_lastSubmissionId;
+    }
+
+    return waitForSubmission(submissionId);
+}
+
+void FrameTracker::onSubmissionRetired(uint64_t submissionId, RetireCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (submissionId <= m_completedSubmissionId)
+        m_readyCallbacks.push_back(std::move(callback));
+    else
+        m_submissionCallbacks.emplace(submissionId, std::move(callback));
+}
+
+void FrameTracker::onFrameRetired(uint64_t frameId, RetireCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint64_t submissionId = frameSubmissionLocked(frameId);
+    if (submissionId == UINT64_MAX)
+        m_frameCallbacks.emplace(frameId, std::move(callback));
+    else if (submissionId <= m_completedSubmissionId)
+        m_readyCallbacks.push_back(std::move(callback));
+    else
+        m_submissionCallbacks.emplace(submissionId, std::move(callback));
+}
+
+void FrameTracker::update()
+{
+    uint64_t completed = pollCompleted();
+
+    std::vector<RetireCallback> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        while (!m_frameSubmissions.empty() && m_frameSubmissions.front().second <= completed)
+        {
+            m_lastRetiredFrameId = m_frameSubmissions.front().first;
+            m_frameSubmissions.pop_front();
+        }
+
+        ready.swap(m_readyCallbacks);
+
+        auto end = m_submissionCallbacks.upper_bound(completed);
+        for (auto it = m_submissionCallbacks.begin(); it != end; ++it)
+        {
+            ready.push_back(std::move(it->second));
+        }
+        m_submissionCallbacks.erase(m_submissionCallbacks.begin(), end);
+    }
+
+    // Callbacks may register further callbacks, so run them without the lock
+    for (auto& callback : ready)
+    {
+        callback();
+    }
+}
+
+} // namespace common
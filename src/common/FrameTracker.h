@@ -0,0 +1,105 @@
+// FrameTracker.h
+// Backend-neutral frame and submission tracking on a monotonic GPU timeline
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace common
+{
+    // Tracks GPU progress through a single monotonically increasing counter.
+    //
+    // Submission IDs are values on the backend's GPU timeline (the NVRHI graphics queue
+    // timeline semaphore on Vulkan, a fence on D3D12): a submission is retired once the
+    // timeline has reached its ID. Frame IDs are handed out by beginFrame() and map to the
+    // last submission of that frame, so anything used during frame N can be released once
+    // frame N is retired without draining the device.
+    class FrameTracker
+    {
+    public:
+        using RetireCallback = std::function<void()>;
+
+        // Access to the GPU timeline, provided by the device manager
+        struct Timeline
+        {
+            std::function<uint64_t()> getCompletedValue;
+            std::function<void(uint64_t)> waitForValue;
+        };
+
+        void setTimeline(Timeline timeline);
+        void reset();
+
+        // Frame management (called by the device manager)
+        uint64_t beginFrame();
+        void endFrame(uint64_t submissionId);
+        void noteSubmission(uint64_t submissionId);
+
+        // Frame IDs start at 1; 0 means "no frame yet"
+        uint64_t getCurrentFrameId() const;
+        bool isFrameOpen() const;  // Between beginFrame() and endFrame()
+        uint64_t getLastSubmissionId() const;
+
+        // The frame that a resource released now belongs to: work recorded from here on is
+        // submitted as part of the open frame, or between frames, the one about to start
+        uint64_t getReleaseFrameId() const;
+
+        // Non-blocking queries
+        uint64_t getCompletedSubmissionId();
+        bool isSubmissionRetired(uint64_t submissionId);
+        bool isFrameRetired(uint64_t frameId);
+
+        // Move entries from the front of a queue in frame order, each with a frameId, until
+        // the first whose frame has not retired. The caller synchronizes the queue.
+        template<typename Entry>
+        void collectRetired(std::deque<Entry>& queue, std::vector<Entry>& retired)
+        {
+            while (!queue.empty() && isFrameRetired(queue.front().frameId))
+            {
+                retired.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        // Blocking waits. Return false, leaving the submission unretired, if there is no
+        // timeline to wait on (before setTimeline() or after reset()).
+        bool waitForSubmission(uint64_t submissionId);
+        bool waitForFrame(uint64_t frameId);
+
+        // Callbacks run from update() on the thread driving the frame loop, once the
+        // frame or submission has retired. Registration is thread-safe.
+        void onSubmissionRetired(uint64_t submissionId, RetireCallback callback);
+        void onFrameRetired(uint64_t frameId, RetireCallback callback);
+
+        // Poll the timeline and run callbacks for everything that has retired
+        void update();
+
+    private:
+        void endFrameLocked(uint64_t submissionId);
+        uint64_t pollCompleted();
+        uint64_t frameSubmissionLocked(uint64_t frameId) const;
+
+    private:
+        Timeline m_timeline;
+
+        mutable std::mutex m_mutex;
+        uint64_t m_currentFrameId = 0;
+        bool m_frameOpen = false;
+        uint64_t m_lastSubmissionId = 0;
+        uint64_t m_completedSubmissionId = 0;
+
+        // Last submission of each ended, not yet retired frame (frame IDs are consecutive)
+        std::deque<std::pair<uint64_t, uint64_t>> m_frameSubmissions;
+        uint64_t m_lastRetiredFrameId = 0;
+
+        std::multimap<uint64_t, RetireCallback> m_submissionCallbacks;
+        std::multimap<uint64_t, RetireCallback> m_frameCallbacks;  // frames not yet ended
+        std::vector<RetireCallback> m_readyCallbacks;
+    };
+
+} // namespace common
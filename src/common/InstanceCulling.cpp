@@ -0,0 +1,185 @@
+// InstanceCulling.cpp
+// CPU reference of GPU instance culling: frustum and hierarchical depth occlusion tests
+//
+// The tests mirror csCullInstances and csBuildHiZ in src/triangle/shaders/culling.slang
+// step for step, so that both agree on everything but rounding; keep them in sync.
+
+#include "InstanceCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace common
+{
+
+static void transform(const float* matrix, const float* position, float* clip)
+{
+    for (int row = 0; row < 4; row++)
+    {
+        const float* m = matrix + row * 4;
+        clip[row] = m[0] * position[0] + m[1] * position[1] + m[2] * position[2] + m[3];
+    }
+}
+
+void CullingView::setMatrices(const float* currentViewProj, const float* previousViewProj)
+{
+    std::copy(currentViewProj, currentViewProj + 16, viewProj);
+    std::copy(previousViewProj, previousViewProj + 16, prevViewProj);
+
+    // Gribb-Hartmann: each plane is the last row plus or minus another
+    const float* rows[4] = { viewProj, viewProj + 4, viewProj + 8, viewProj + 12 };
+    for (int i = 0; i < 4; i++)
+    {
+        frustumPlanes[0][i] = rows[3][i] + rows[0][i];     // Left
+        frustumPlanes[1][i] = rows[3][i] - rows[0][i];     // Right
+        frustumPlanes[2][i] = rows[3][i] + rows[1][i];     // Bottom
+        frustumPlanes[3][i] = rows[3][i] - rows[1][i];     // Top
+        frustumPlanes[4][i] = rows[2][i];                  // Near, at depth 0
+        frustumPlanes[5][i] = rows[3][i] - rows[2][i];     // Far
+    }
+
+    for (float* plane : frustumPlanes)
+    {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (int i = 0; i < 4; i++)
+                plane[i] /= length;
+        }
+    }
+}
+
+void HiZPyramid::build(const float* depth, uint32_t width, uint32_t height)
+{
+    m_levels.clear();
+    if (width == 0 || height == 0)
+        return;
+
+    Level base;
+    base.width = width;
+    base.height = height;
+    base.texels.assign(depth, depth + size_t(width) * height);
+    m_levels.push_back(std::move(base));
+
+    while (m_levels.back().width > 1 || m_levels.back().height > 1)
+    {
+        const Level& source = m_levels.back();
+        Level level;
+        level.width = std::max(1u, source.width / 2);
+        level.height = std::max(1u, source.height / 2);
+        level.texels.resize(size_t(level.width) * level.height);
+
+        uint32_t ratioX = source.width / level.width;
+        uint32_t ratioY = source.height / level.height;
+        for (uint32_t y = 0; y < level.height; y++)
+        {
+            uint32_t lastY = y == level.height - 1 ? source.height - 1 : y * ratioY + ratioY - 1;
+            for (uint32_t x = 0; x < level.width; x++)
+            {
+                uint32_t lastX = x == level.width - 1 ? source.width - 1 : x * ratioX + ratioX - 1;
+
+                float farthest = 0.0f;
+                for (uint32_t sy = y * ratioY; sy <= lastY; sy++)
+                {
+                    for (uint32_t sx = x * ratioX; sx <= lastX; sx++)
+                        farthest = std::max(farthest, source.texels[sy * source.width + sx]);
+                }
+                level.texels[y * level.width + x] = farthest;
+            }
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+bool isInFrustum(const CullingView& view, const BoundingSphere& sphere)
+{
+    for (const float* plane : view.frustumPlanes)
+    {
+        float distance = plane[0] * sphere.center[0] + plane[1] * sphere.center[1] + plane[2] * sphere.center[2] + plane[3];
+        if (distance < -sphere.radius)
+            return false;
+    }
+    return true;
+}
+
+bool isOccluded(const CullingView& view, const HiZPyramid& hiZ, const BoundingSphere& sphere)
+{
+    if (hiZ.getMipCount() == 0)
+        return false;
+
+    // Screen rectangle and nearest depth of the sphere's bounding box in the previous frame
+    float ndcMin[2] = { FLT_MAX, FLT_MAX };
+    float ndcMax[2] = { -FLT_MAX, -FLT_MAX };
+    float minDepth = FLT_MAX;
+    for (uint32_t corner = 0; corner < 8; corner++)
+    {
+        float position[3];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            position[axis] = sphere.center[axis] + ((corner >> axis) & 1 ? sphere.radius : -sphere.radius);
+        }
+
+        float clip[4];
+        transform(view.prevViewProj, position, clip);
+        if (clip[3] <= 0.0f)
+            return false;
+
+        for (uint32_t axis = 0; axis < 2; axis++)
+        {
+            ndcMin[axis] = std::min(ndcMin[axis], clip[axis] / clip[3]);
+            ndcMax[axis] = std::max(ndcMax[axis], clip[axis] / clip[3]);
+        }
+        minDepth = std::min(minDepth, clip[2] / clip[3]);
+    }
+
+    for (uint32_t axis = 0; axis < 2; axis++)
+    {
+        ndcMin[axis] = std::max(ndcMin[axis], -1.0f);
+        ndcMax[axis] = std::min(ndcMax[axis], 1.0f);
+        if (ndcMin[axis] >= ndcMax[axis])
+            return false;
+    }
+
+    // Mip 0 pixels, with y down
+    float width = float(hiZ.getWidth(0));
+    float height = float(hiZ.getHeight(0));
+    float pixelMinX = (ndcMin[0] * 0.5f + 0.5f) * width;
+    float pixelMaxX = (ndcMax[0] * 0.5f + 0.5f) * width;
+    float pixelMinY = (0.5f - ndcMax[1] * 0.5f) * height;
+    float pixelMaxY = (0.5f - ndcMin[1] * 0.5f) * height;
+
+    // The level where the rectangle spans at most 2x2 texels
+    float extent = std::max(pixelMaxX - pixelMinX, pixelMaxY - pixelMinY);
+    uint32_t mip = std::min(static_cast<uint32_t>(std::ceil(std::log2(std::max(extent, 1.0f)))), hiZ.getMipCount() - 1);
+    uint32_t mipWidth = hiZ.getWidth(mip);
+    uint32_t mipHeight = hiZ.getHeight(mip);
+    uint32_t texelMinX = std::min(static_cast<uint32_t>(pixelMinX) >> mip, mipWidth - 1);
+    uint32_t texelMaxX = std::min(static_cast<uint32_t>(pixelMaxX) >> mip, mipWidth - 1);
+    uint32_t texelMinY = std::min(static_cast<uint32_t>(pixelMinY) >> mip, mipHeight - 1);
+    uint32_t texelMaxY = std::min(static_cast<uint32_t>(pixelMaxY) >> mip, mipHeight - 1);
+
+    float maxDepth = 0.0f;
+    for (uint32_t y = texelMinY; y <= texelMaxY; y++)
+    {
+        for (uint32_t x = texelMinX; x <= texelMaxX; x++)
+            maxDepth = std::max(maxDepth, hiZ.load(x, y, mip));
+    }
+    return minDepth > maxDepth;
+}
+
+void cullInstances(const CullingView& view, const HiZPyramid* hiZ, std::span<const BoundingSphere> spheres,
+    std::vector<uint32_t>& visible)
+{
+    for (uint32_t index = 0; index < spheres.size(); index++)
+    {
+        const BoundingSphere& sphere = spheres[index];
+        if (!isInFrustum(view, sphere))
+            continue;
+        if (hiZ && isOccluded(view, *hiZ, sphere))
+            continue;
+        visible.push_back(index);
+    }
+}
+
+} // namespace common
@@ -0,0 +1,67 @@
+// InstanceCulling.h
+// CPU reference of GPU instance culling: frustum and hierarchical depth occlusion tests
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace common
+{
+    // World-space bounds of an instance
+    struct BoundingSphere
+    {
+        float center[3] = {};
+        float radius = 0.0f;
+    };
+
+    // Matrices are row-major and transform column vectors: clip = m * float4(position, 1).
+    // Clip space is D3D's: x and y in [-1, 1] with y up, depth in [0, 1] with 0 nearest.
+    struct CullingView
+    {
+        float viewProj[16] = {};
+        float prevViewProj[16] = {};        // The frame the depth pyramid was built from
+        float frustumPlanes[6][4] = {};     // Normalized; inside where dot(xyz, p) + w >= 0
+
+        // Copy the matrices and extract the planes of viewProj's frustum
+        void setMatrices(const float* currentViewProj, const float* previousViewProj);
+    };
+
+    // Hierarchical depth: mip 0 is the depth buffer and every texel above it holds the
+    // farthest depth of its 2x2 footprint in the level below. The last row and column also
+    // take the leftover row or column of an odd-sized level, so each texel bounds every
+    // pixel under it. Rows run top to bottom, as in the depth buffer.
+    class HiZPyramid
+    {
+    public:
+        void build(const float* depth, uint32_t width, uint32_t height);
+
+        uint32_t getMipCount() const { return static_cast<uint32_t>(m_levels.size()); }
+        uint32_t getWidth(uint32_t mip) const { return m_levels[mip].width; }
+        uint32_t getHeight(uint32_t mip) const { return m_levels[mip].height; }
+        float load(uint32_t x, uint32_t y, uint32_t mip) const { return m_levels[mip].texels[y * m_levels[mip].width + x]; }
+
+    private:
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float> texels;
+        };
+
+        std::vector<Level> m_levels;
+    };
+
+    bool isInFrustum(const CullingView& view, const BoundingSphere& sphere);
+
+    // True if the sphere, projected with prevViewProj, lies entirely behind the depth in
+    // the pyramid. Conservative: spheres crossing the camera plane or off screen are visible.
+    bool isOccluded(const CullingView& view, const HiZPyramid& hiZ, const BoundingSphere& sphere);
+
+    // Append the indices of the visible spheres in ascending order; the GPU pass compacts
+    // the same set in arbitrary order. A null pyramid skips the occlusion test.
+    void cullInstances(const CullingView& view, const HiZPyramid* hiZ, std::span<const BoundingSphere> spheres,
+        std::vector<uint32_t>& visible);
+
+} // namespace common
@@ -0,0 +1,236 @@
+// PipelineCache.cpp
+// Graphics pipelines deduplicated by a hash of their full state
+
+#include "PipelineCache.h"
+#include "DeviceManager.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <type_traits>
+
+namespace common
+{
+
+// Appends individual fields, never whole structs, so padding bytes stay out of the key
+class PipelineKeyWriter
+{
+public:
+    template<typename T>
+    void add(const T& value)
+    {
+        static_assert(std::is_scalar_v<T>, "pack fields one at a time");
+        m_key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T, size_t N>
+    void add(const T (&values)[N])
+    {
+        for (const T& value : values)
+            add(value);
+    }
+
+    void addStencilOp(const nvrhi::DepthStencilState::StencilOpDesc& op)
+    {
+        add(op.failOp);
+        add(op.depthFailOp);
+        add(op.passOp);
+        add(op.stencilFunc);
+    }
+
+    std::string take() { return std::move(m_key); }
+
+private:
+    std::string m_key;
+};
+
+static std::string makePipelineKey(const nvrhi::GraphicsPipelineDesc& desc, const nvrhi::FramebufferInfo& framebufferInfo)
+{
+    PipelineKeyWriter key;
+
+    key.add(desc.primType);
+    key.add(desc.patchControlPoints);
+    key.add(desc.inputLayout.Get());
+    key.add(desc.VS.Get());
+    key.add(desc.HS.Get());
+    key.add(desc.DS.Get());
+    key.add(desc.GS.Get());
+    key.add(desc.PS.Get());
+
+    key.add(uint32_t(desc.bindingLayouts.size()));
+    for (const nvrhi::BindingLayoutHandle& layout : desc.bindingLayouts)
+        key.add(layout.Get());
+
+    const nvrhi::BlendState& blend = desc.renderState.blendState;
+    for (const nvrhi::BlendState::RenderTarget& target : blend.targets)
+    {
+        key.add(target.blendEnable);
+        key.add(target.srcBlend);
+        key.add(target.destBlend);
+        key.add(target.blendOp);
+        key.add(target.srcBlendAlpha);
+        key.add(target.destBlendAlpha);
+        key.add(target.blendOpAlpha);
+        key.add(target.colorWriteMask);
+    }
+    key.add(blend.alphaToCoverageEnable);
+
+    const nvrhi::DepthStencilState& depthStencil = desc.renderState.depthStencilState;
+    key.add(depthStencil.depthTestEnable);
+    key.add(depthStencil.depthWriteEnable);
+    key.add(depthStencil.depthFunc);
+    key.add(depthStencil.stencilEnable);
+    key.add(depthStencil.stencilReadMask);
+    key.add(depthStencil.stencilWriteMask);
+    key.add(depthStencil.stencilRefValue);
+    key.add(depthStencil.dynamicStencilRef);
+    key.addStencilOp(depthStencil.frontFaceStencil);
+    key.addStencilOp(depthStencil.backFaceStencil);
+
+    const nvrhi::RasterState& raster = desc.renderState.rasterState;
+    key.add(raster.fillMode);
+    key.add(raster.cullMode);
+    key.add(raster.frontCounterClockwise);
+    key.add(raster.depthClipEnable);
+    key.add(raster.scissorEnable);
+    key.add(raster.multisampleEnable);
+    key.add(raster.antialiasedLineEnable);
+    key.add(raster.depthBias);
+    key.add(raster.depthBiasClamp);
+    key.add(raster.slopeScaledDepthBias);
+    key.add(raster.forcedSampleCount);
+    key.add(raster.programmableSamplePositionsEnable);
+    key.add(raster.conservativeRasterEnable);
+    key.add(raster.quadFillEnable);
+    key.add(raster.samplePositionsX);
+    key.add(raster.samplePositionsY);
+
+    const nvrhi::SinglePassStereoState& stereo = desc.renderState.singlePassStereo;
+    key.add(stereo.enabled);
+    key.add(stereo.independentViewportMask);
+    key.add(stereo.renderTargetIndexOffset);
+
+    key.add(desc.shadingRateState.enabled);
+    key.add(desc.shadingRateState.shadingRate);
+    key.add(desc.shadingRateState.pipelinePrimitiveCombiner);
+    key.add(desc.shadingRateState.imageCombiner);
+
+    key.add(uint32_t(framebufferInfo.colorFormats.size()));
+    for (nvrhi::Format format : framebufferInfo.colorFormats)
+        key.add(format);
+    key.add(framebufferInfo.depthFormat);
+    key.add(framebufferInfo.sampleCount);
+    key.add(framebufferInfo.sampleQuality);
+
+    return key.take();
+}
+
+PipelineCache::PipelineCache(IDeviceManager& deviceManager)
+    : m_deviceManager(deviceManager)
+{
+}
+
+nvrhi::GraphicsPipelineHandle PipelineCache::getGraphicsPipeline(const nvrhi::GraphicsPipelineDesc& desc,
+    const nvrhi::FramebufferInfo& framebufferInfo)
+{
+    return getOrCreate(desc, framebufferInfo, false);
+}
+
+void PipelineCache::prewarm(ThreadPool& pool, const nvrhi::GraphicsPipelineDesc& desc,
+    const nvrhi::FramebufferInfo& framebufferInfo)
+{
+    pool.submit([this, desc, framebufferInfo]()
+    {
+        getOrCreate(desc, framebufferInfo, true);
+    });
+}
+
+nvrhi::GraphicsPipelineHandle PipelineCache::getOrCreate(const nvrhi::GraphicsPipelineDesc& desc,
+    const nvrhi::FramebufferInfo& framebufferInfo, bool prewarming)
+{
+    std::string key = makePipelineKey(desc, framebufferInfo);
+
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::shared_ptr<Entry>& slot = m_pipelines[key];
+        if (!slot)
+            slot = std::make_shared<Entry>();
+        entry = slot;
+    }
+
+    // Whoever runs the once_flag creates the pipeline; everyone else waits for it
+    bool created = false;
+    std::call_once(entry->created, [&]()
+    {
+        auto start = std::chrono::steady_clock::now();
+        entry->pipeline = m_deviceManager.getDevice()->createGraphicsPipeline(desc, framebufferInfo);
+        created = true;
+
+        if (prewarming)
+        {
+            m_total.prewarmed++;
+            m_frame.prewarmed++;
+        }
+        else
+        {
+            uint64_t elapsedNs = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            m_total.misses++;
+            m_frame.misses++;
+            m_total.missTimeNs += elapsedNs;
+            m_frame.missTimeNs += elapsedNs;
+        }
+    });
+
+    if (!created && !prewarming)
+    {
+        m_total.hits++;
+        m_frame.hits++;
+    }
+
+    // Threads already waiting on a failed creation get null too, but the entry goes, so
+    // the next request retries (e.g. after a shader reload or device recreation)
+    if (created && !entry->pipeline)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pipelines.find(key);
+        if (it != m_pipelines.end() && it->second == entry)
+            m_pipelines.erase(it);
+    }
+
+    return entry->pipeline;
+}
+
+void PipelineCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pipelines.clear();
+}
+
+size_t PipelineCache::getPipelineCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pipelines.size();
+}
+
+PipelineCache::Stats PipelineCache::getStats() const
+{
+    Stats stats;
+    stats.hits = m_total.hits;
+    stats.misses = m_total.misses;
+    stats.prewarmed = m_total.prewarmed;
+    stats.missTimeMs = double(m_total.missTimeNs) / 1e6;
+    return stats;
+}
+
+PipelineCache::Stats PipelineCache::takeFrameStats()
+{
+    Stats stats;
+    stats.hits = m_frame.hits.exchange(0);
+    stats.misses = m_frame.misses.exchange(0);
+    stats.prewarmed = m_frame.prewarmed.exchange(0);
+    stats.missTimeMs = double(m_frame.missTimeNs.exchange(0)) / 1e6;
+    return stats;
+}
+
+} // namespace common
@@ -0,0 +1,87 @@
+// PipelineCache.h
+// Graphics pipelines deduplicated by a hash of their full state
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace common
+{
+    class IDeviceManager;
+    class ThreadPool;
+
+    // Returns one pipeline per distinct GraphicsPipelineDesc + FramebufferInfo. The key
+    // packs every field of both (shaders, input layout and binding layouts by identity),
+    // so equal states share a pipeline and nothing is compared approximately.
+    //
+    // prewarm() creates pipelines on worker threads ahead of their first use; a render
+    // thread that asks for one still being created waits for it rather than building a
+    // duplicate. Misses on the render thread are hitches, so they are counted per frame.
+    // A pipeline that fails to create is returned as null and not cached, so it is retried
+    // on the next request. All methods are thread-safe.
+    class PipelineCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;        // Created on the calling thread
+            uint64_t prewarmed = 0;     // Created by prewarm()
+            double missTimeMs = 0.0;    // Time spent creating pipelines on misses
+        };
+
+        explicit PipelineCache(IDeviceManager& deviceManager);
+
+        nvrhi::GraphicsPipelineHandle getGraphicsPipeline(const nvrhi::GraphicsPipelineDesc& desc,
+            const nvrhi::FramebufferInfo& framebufferInfo);
+
+        // Queue creation on the pool; returns immediately
+        void prewarm(ThreadPool& pool, const nvrhi::GraphicsPipelineDesc& desc,
+            const nvrhi::FramebufferInfo& framebufferInfo);
+
+        // Release every pipeline (e.g. before the device is destroyed)
+        void clear();
+
+        size_t getPipelineCount() const;
+
+        // Totals since creation, and the counts since the previous takeFrameStats() call
+        Stats getStats() const;
+        Stats takeFrameStats();
+
+    private:
+        struct Entry
+        {
+            std::once_flag created;
+            nvrhi::GraphicsPipelineHandle pipeline;
+        };
+
+        struct Counters
+        {
+            std::atomic<uint64_t> hits = 0;
+            std::atomic<uint64_t> misses = 0;
+            std::atomic<uint64_t> prewarmed = 0;
+            std::atomic<uint64_t> missTimeNs = 0;
+        };
+
+        nvrhi::GraphicsPipelineHandle getOrCreate(const nvrhi::GraphicsPipelineDesc& desc,
+            const nvrhi::FramebufferInfo& framebufferInfo, bool prewarming);
+
+    private:
+        IDeviceManager& m_deviceManager;
+
+        // Entries are shared so a prewarm task keeps its entry alive across clear()
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, std::shared_ptr<Entry>> m_pipelines;
+
+        Counters m_total;
+        Counters m_frame;
+    };
+
+} // namespace common
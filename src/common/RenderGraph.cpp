@@ -0,0 +1,444 @@
+// RenderGraph.cpp
+// Frame graph of passes that declare the textures they read and write
+
+#include "RenderGraph.h"
+#include "TextureMemory.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+namespace common
+{
+
+static constexpr uint64_t EstimatedAlignment = 64 * 1024;
+
+static bool hasUnorderedAccess(nvrhi::ResourceStates state)
+{
+    return (state & nvrhi::ResourceStates::UnorderedAccess) != 0;
+}
+
+void RenderGraph::clear()
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_barriers.clear();
+    m_batchOffsets.clear();
+    m_aliases.clear();
+    std::fill(std::begin(m_heapSizes), std::end(m_heapSizes), 0);
+    m_stats = {};
+}
+
+RenderGraph::ResourceId RenderGraph::importTexture(nvrhi::ITexture* texture, nvrhi::ResourceStates initialState,
+    nvrhi::ResourceStates finalState)
+{
+    Resource resource;
+    if (texture)
+        resource.desc = texture->getDesc();
+    resource.texture = texture;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    resource.imported = true;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::createTexture(const nvrhi::TextureDesc& desc)
+{
+    Resource resource;
+    resource.desc = desc;
+    resource.heapKind = desc.isRenderTarget ? HeapKind::RenderTarget : HeapKind::Texture;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+RenderGraph::PassId RenderGraph::addPass(std::string name, ExecuteCallback execute)
+{
+    Pass pass;
+    pass.name = std::move(name);
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return static_cast<PassId>(m_passes.size() - 1);
+}
+
+void RenderGraph::addAccess(PassId pass, ResourceId resource, nvrhi::ResourceStates state, bool write)
+{
+    if (pass >= m_passes.size() || resource >= m_resources.size())
+    {
+        std::cerr << "[RenderGraph] Ignoring an access of resource " << resource << " by pass " << pass
+                  << ", one of them does not exist" << std::endl;
+        return;
+    }
+
+    Access access;
+    access.resource = resource;
+    access.state = state;
+    access.write = write;
+    m_passes[pass].accesses.push_back(access);
+}
+
+void RenderGraph::read(PassId pass, ResourceId resource, nvrhi::ResourceStates state)
+{
+    addAccess(pass, resource, state, false);
+}
+
+void RenderGraph::write(PassId pass, ResourceId resource, nvrhi::ResourceStates state)
+{
+    addAccess(pass, resource, state, true);
+}
+
+void RenderGraph::setSideEffects(PassId pass)
+{
+    if (pass < m_passes.size())
+        m_passes[pass].sideEffects = true;
+}
+
+bool RenderGraph::compile(const RequirementsCallback& getRequirements)
+{
+    m_order.clear();
+    m_barriers.clear();
+    m_batchOffsets.clear();
+    m_aliases.clear();
+    std::fill(std::begin(m_heapSizes), std::end(m_heapSizes), 0);
+    m_stats = {};
+    m_stats.passCount = static_cast<uint32_t>(m_passes.size());
+
+    for (Resource& resource : m_resources)
+    {
+        resource.requirements = {};
+        resource.offset = InvalidOffset;
+        resource.firstUse = InvalidId;
+        resource.lastUse = InvalidId;
+    }
+
+    cullPasses();
+    m_stats.culledPassCount = m_stats.passCount - static_cast<uint32_t>(m_order.size());
+    if (m_order.empty())
+        return false;
+
+    if (!placeTransients(getRequirements))
+        return false;
+
+    computeBarriers();
+    return true;
+}
+
+void RenderGraph::cullPasses()
+{
+    // The producer of each read is the last earlier pass writing that resource. Reads are
+    // resolved before the pass's own writes, so read-modify-write depends on the previous
+    // writer.
+    const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+    m_lastWriter.assign(m_resources.size(), InvalidId);
+    m_dependencies.clear();
+    m_dependencyOffsets.resize(passCount + 1);
+
+    for (PassId passId = 0; passId < passCount; passId++)
+    {
+        Pass& pass = m_passes[passId];
+        pass.kept = false;
+        m_dependencyOffsets[passId] = static_cast<uint32_t>(m_dependencies.size());
+
+        for (const Access& access : pass.accesses)
+        {
+            if (!access.write && m_lastWriter[access.resource] != InvalidId)
+                m_dependencies.push_back(m_lastWriter[access.resource]);
+        }
+        for (const Access& access : pass.accesses)
+        {
+            if (access.write)
+                m_lastWriter[access.resource] = passId;
+        }
+    }
+    m_dependencyOffsets[passCount] = static_cast<uint32_t>(m_dependencies.size());
+
+    // Producers come before their readers, so one walk back from the end reaches every
+    // pass that a root needs
+    for (PassId passId = passCount; passId-- > 0;)
+    {
+        Pass& pass = m_passes[passId];
+        if (!pass.kept)
+        {
+            pass.kept = pass.sideEffects || std::any_of(pass.accesses.begin(), pass.accesses.end(),
+                [this](const Access& access) { return access.write && m_resources[access.resource].imported; });
+        }
+        if (!pass.kept)
+            continue;
+
+        for (uint32_t i = m_dependencyOffsets[passId]; i < m_dependencyOffsets[passId + 1]; i++)
+        {
+            m_passes[m_dependencies[i]].kept = true;
+        }
+    }
+
+    for (PassId passId = 0; passId < passCount; passId++)
+    {
+        if (!m_passes[passId].kept)
+            continue;
+
+        uint32_t orderIndex = static_cast<uint32_t>(m_order.size());
+        m_order.push_back(passId);
+        for (const Access& access : m_passes[passId].accesses)
+        {
+            Resource& resource = m_resources[access.resource];
+            if (resource.firstUse == InvalidId)
+                resource.firstUse = orderIndex;
+            resource.lastUse = orderIndex;
+        }
+    }
+}
+
+bool RenderGraph::placeTransients(const RequirementsCallback& getRequirements)
+{
+    constexpr int HeapKindCount = static_cast<int>(HeapKind::Count);
+
+    // Used transients in the order they start, and in the order they end; ties go by ID
+    std::vector<ResourceId>& starts = m_transientStarts;
+    std::vector<ResourceId>& ends = m_transientEnds;
+    starts.clear();
+    uint64_t capacities[HeapKindCount] = {};
+    for (ResourceId id = 0; id < m_resources.size(); id++)
+    {
+        Resource& resource = m_resources[id];
+        if (resource.imported || resource.firstUse == InvalidId)
+            continue;
+
+        resource.requirements = getRequirements(resource.desc);
+        if (resource.requirements.size == 0)
+        {
+            std::cerr << "[RenderGraph] No memory requirements for texture " << resource.desc.debugName << std::endl;
+            return false;
+        }
+
+        // Room for every transient at once with its worst-case padding, doubled so that
+        // fragmentation never fails an allocation; the block is only metadata
+        uint64_t alignment = std::max<uint64_t>(resource.requirements.alignment, 1);
+        capacities[static_cast<int>(resource.heapKind)] += 2 * (resource.requirements.size + alignment);
+        m_stats.transientBytes += resource.requirements.size;
+        starts.push_back(id);
+    }
+    m_stats.transientCount = static_cast<uint32_t>(starts.size());
+
+    ends = starts;
+    std::stable_sort(starts.begin(), starts.end(), [this](ResourceId a, ResourceId b)
+    {
+        return m_resources[a].firstUse < m_resources[b].firstUse;
+    });
+    std::stable_sort(ends.begin(), ends.end(), [this](ResourceId a, ResourceId b)
+    {
+        return m_resources[a].lastUse < m_resources[b].lastUse;
+    });
+
+    std::unique_ptr<TlsfAllocator> allocators[HeapKindCount];
+    for (int kind = 0; kind < HeapKindCount; kind++)
+    {
+        if (capacities[kind] > 0)
+            allocators[kind] = std::make_unique<TlsfAllocator>(capacities[kind]);
+    }
+
+    // Transients whose memory is free again, per heap. One that a later transient covers
+    // completely is dropped, because that transient will alias whatever comes after it.
+    std::vector<ResourceId> retired[HeapKindCount];
+    m_allocationHandles.assign(m_resources.size(), TlsfAllocator::InvalidHandle);
+
+    size_t startIndex = 0;
+    size_t endIndex = 0;
+    for (uint32_t orderIndex = 0; orderIndex < m_order.size(); orderIndex++)
+    {
+        for (; startIndex < starts.size() && m_resources[starts[startIndex]].firstUse == orderIndex; startIndex++)
+        {
+            ResourceId id = starts[startIndex];
+            Resource& resource = m_resources[id];
+            int kind = static_cast<int>(resource.heapKind);
+
+            TlsfAllocator::Allocation allocation = allocators[kind]->allocate(resource.requirements.size,
+                std::max<uint64_t>(resource.requirements.alignment, 1));
+            if (!allocation)
+            {
+                std::cerr << "[RenderGraph] Cannot place " << resource.requirements.size << " bytes for texture "
+                          << resource.desc.debugName << std::endl;
+                return false;
+            }
+            resource.offset = allocation.offset;
+            m_allocationHandles[id] = allocation.handle;
+            m_heapSizes[kind] = std::max(m_heapSizes[kind], allocation.offset + resource.requirements.size);
+
+            uint64_t begin = allocation.offset;
+            uint64_t end = allocation.offset + resource.requirements.size;
+            auto overlaps = [&](ResourceId other)
+            {
+                const Resource& previous = m_resources[other];
+                return previous.offset < end && begin < previous.offset + previous.requirements.size;
+            };
+            auto covers = [&](ResourceId other)
+            {
+                const Resource& previous = m_resources[other];
+                return begin <= previous.offset && previous.offset + previous.requirements.size <= end;
+            };
+
+            for (ResourceId previous : retired[kind])
+            {
+                if (overlaps(previous))
+                    m_aliases.push_back({ orderIndex, previous });
+            }
+            std::erase_if(retired[kind], covers);
+        }
+
+        for (; endIndex < ends.size() && m_resources[ends[endIndex]].lastUse == orderIndex; endIndex++)
+        {
+            ResourceId id = ends[endIndex];
+            int kind = static_cast<int>(m_resources[id].heapKind);
+            allocators[kind]->free(m_allocationHandles[id]);
+            retired[kind].push_back(id);
+        }
+    }
+
+    for (uint64_t heapSize : m_heapSizes)
+    {
+        m_stats.heapBytes += heapSize;
+    }
+    return true;
+}
+
+void RenderGraph::computeBarriers()
+{
+    m_states.resize(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        m_states[i] = m_resources[i].imported ? m_resources[i].initialState : nvrhi::ResourceStates::Unknown;
+    }
+    m_batchSlots.assign(m_resources.size(), InvalidId);
+
+    // Returns the resource's barrier in the batch starting at batchStart, adding one if
+    // the resource has none yet; a resource gets one barrier per batch
+    auto getBarrier = [this](ResourceId id, uint32_t batchStart) -> Barrier&
+    {
+        uint32_t slot = m_batchSlots[id];
+        if (slot != InvalidId && slot >= batchStart && slot < m_barriers.size() && m_barriers[slot].resource == id)
+            return m_barriers[slot];
+
+        Barrier barrier;
+        barrier.resource = id;
+        barrier.before = m_states[id];
+        m_batchSlots[id] = static_cast<uint32_t>(m_barriers.size());
+        m_barriers.push_back(barrier);
+        return m_barriers.back();
+    };
+
+    size_t aliasIndex = 0;
+    for (uint32_t orderIndex = 0; orderIndex < m_order.size(); orderIndex++)
+    {
+        uint32_t batchStart = static_cast<uint32_t>(m_barriers.size());
+        m_batchOffsets.push_back(batchStart);
+
+        // Previous occupants of the memory of transients starting here leave first
+        for (; aliasIndex < m_aliases.size() && m_aliases[aliasIndex].orderIndex == orderIndex; aliasIndex++)
+        {
+            Barrier& barrier = getBarrier(m_aliases[aliasIndex].previous, batchStart);
+            barrier.after = m_transientState;
+            barrier.aliasing = true;
+        }
+
+        // One transition per resource to every state the pass needs it in
+        for (const Access& access : m_passes[m_order[orderIndex]].accesses)
+        {
+            Barrier& barrier = getBarrier(access.resource, batchStart);
+            barrier.after = barrier.after | access.state;
+        }
+
+        // Drop what is already in the right state; UAV to UAV stays, to order the accesses
+        uint32_t kept = batchStart;
+        for (uint32_t i = batchStart; i < m_barriers.size(); i++)
+        {
+            const Barrier& barrier = m_barriers[i];
+            m_states[barrier.resource] = barrier.after;
+            if (barrier.before != barrier.after || hasUnorderedAccess(barrier.after))
+                m_barriers[kept++] = barrier;
+        }
+        m_barriers.resize(kept);
+    }
+
+    // Imported textures go back to their final state
+    m_batchOffsets.push_back(static_cast<uint32_t>(m_barriers.size()));
+    for (ResourceId id = 0; id < m_resources.size(); id++)
+    {
+        const Resource& resource = m_resources[id];
+        if (!resource.imported || resource.firstUse == InvalidId || resource.finalState == nvrhi::ResourceStates::Unknown)
+            continue;
+        if (m_states[id] == resource.finalState)
+            continue;
+
+        Barrier barrier;
+        barrier.resource = id;
+        barrier.before = m_states[id];
+        barrier.after = resource.finalState;
+        m_barriers.push_back(barrier);
+    }
+    m_batchOffsets.push_back(static_cast<uint32_t>(m_barriers.size()));
+
+    m_stats.barrierCount = static_cast<uint32_t>(m_barriers.size());
+    for (const Barrier& barrier : m_barriers)
+    {
+        m_stats.aliasingBarrierCount += barrier.aliasing ? 1 : 0;
+    }
+    for (size_t batch = 0; batch + 1 < m_batchOffsets.size(); batch++)
+    {
+        m_stats.barrierBatchCount += m_batchOffsets[batch + 1] > m_batchOffsets[batch] ? 1 : 0;
+    }
+}
+
+std::span<const RenderGraph::Barrier> RenderGraph::getBarriers(uint32_t orderIndex) const
+{
+    return std::span<const Barrier>(m_barriers).subspan(m_batchOffsets[orderIndex],
+        m_batchOffsets[orderIndex + 1] - m_batchOffsets[orderIndex]);
+}
+
+std::span<const RenderGraph::Barrier> RenderGraph::getFinalBarriers() const
+{
+    return getBarriers(static_cast<uint32_t>(m_order.size()));
+}
+
+static void applyBarriers(nvrhi::ICommandList* commandList, const RenderGraph& graph,
+    std::span<const RenderGraph::Barrier> barriers)
+{
+    if (barriers.empty())
+        return;
+
+    for (const RenderGraph::Barrier& barrier : barriers)
+    {
+        nvrhi::ITexture* texture = graph.getTexture(barrier.resource);
+        if (texture)
+            commandList->setTextureState(texture, nvrhi::AllSubresources, barrier.after);
+    }
+    commandList->commitBarriers();
+}
+
+void RenderGraph::execute(nvrhi::ICommandList* commandList) const
+{
+    // NVRHI tracks the states too and skips transitions that are already done; issuing
+    // them here puts each pass's transitions in one batch
+    for (uint32_t orderIndex = 0; orderIndex < m_order.size(); orderIndex++)
+    {
+        const Pass& pass = m_passes[m_order[orderIndex]];
+        commandList->beginMarker(pass.name.c_str());
+        applyBarriers(commandList, *this, getBarriers(orderIndex));
+        if (pass.execute)
+            pass.execute(commandList, *this);
+        commandList->endMarker();
+    }
+    applyBarriers(commandList, *this, getFinalBarriers());
+}
+
+nvrhi::MemoryRequirements RenderGraph::estimateRequirements(const nvrhi::TextureDesc& desc)
+{
+    uint64_t bytes = estimateTextureBytes(desc);
+
+    nvrhi::MemoryRequirements requirements;
+    requirements.size = std::max<uint64_t>((bytes + EstimatedAlignment - 1) / EstimatedAlignment, 1) * EstimatedAlignment;
+    requirements.alignment = EstimatedAlignment;
+    return requirements;
+}
+
+} // namespace common
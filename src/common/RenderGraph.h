@@ -0,0 +1,201 @@
+// RenderGraph.h
+// Frame graph of passes that declare the textures they read and write
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace common
+{
+    // A frame described as passes, added in submission order, that each declare the
+    // textures they access and the state they need them in. compile() then:
+    //  - culls passes nothing needs: a pass is kept if it writes an imported texture, has
+    //    side effects, or writes a texture that a later kept pass reads
+    //  - computes the batch of transitions to issue before each kept pass, and a final
+    //    batch returning imported textures to their final state
+    //  - places transient textures in heaps, sharing memory between textures whose
+    //    lifetimes (first to last kept pass using them) do not overlap
+    //
+    // Compilation is CPU only and deterministic: the same graph gives the same order,
+    // barriers and offsets, so it runs in tests and benchmarks without a device.
+    // TransientTexturePool binds memory to the transients before execute().
+    //
+    // A transient's content is undefined at its first use, because its memory may have
+    // held another texture; the first pass writing it must clear or fully overwrite it.
+    // Not thread-safe; build and compile a graph on one thread.
+    class RenderGraph
+    {
+    public:
+        using ResourceId = uint32_t;
+        using PassId = uint32_t;
+        static constexpr uint32_t InvalidId = UINT32_MAX;
+        static constexpr uint64_t InvalidOffset = UINT64_MAX;
+
+        // Transients that may share memory: D3D12 resource heap tier 1 cannot put render
+        // targets and other textures in the same heap
+        enum class HeapKind : uint8_t
+        {
+            RenderTarget,
+            Texture,
+            Count
+        };
+
+        using ExecuteCallback = std::function<void(nvrhi::ICommandList* commandList, const RenderGraph& graph)>;
+        using RequirementsCallback = std::function<nvrhi::MemoryRequirements(const nvrhi::TextureDesc& desc)>;
+
+        struct Access
+        {
+            ResourceId resource = InvalidId;
+            nvrhi::ResourceStates state = nvrhi::ResourceStates::Unknown;
+            bool write = false;
+        };
+
+        // An aliasing barrier ends the previous occupant's use of memory that a transient
+        // is about to take over; it moves that texture to the transient state.
+        struct Barrier
+        {
+            ResourceId resource = InvalidId;
+            nvrhi::ResourceStates before = nvrhi::ResourceStates::Unknown;
+            nvrhi::ResourceStates after = nvrhi::ResourceStates::Unknown;
+            bool aliasing = false;
+        };
+
+        struct Stats
+        {
+            uint32_t passCount = 0;
+            uint32_t culledPassCount = 0;
+            uint32_t transientCount = 0;        // Used by kept passes
+            uint32_t barrierCount = 0;          // Including aliasing barriers
+            uint32_t aliasingBarrierCount = 0;
+            uint32_t barrierBatchCount = 0;     // Non-empty batches
+            uint64_t transientBytes = 0;        // Sum of the transients' sizes
+            uint64_t heapBytes = 0;             // What they take with aliasing
+        };
+
+        // Start the next frame's graph; keeps the capacity of the internal arrays
+        void clear();
+
+        // The state transient textures are created in and rest in between command lists,
+        // which aliasing barriers return them to; see TransientTexturePool::getTransientState().
+        // Defaults to Common and is kept across clear().
+        void setTransientState(nvrhi::ResourceStates state) { m_transientState = state; }
+        nvrhi::ResourceStates getTransientState() const { return m_transientState; }
+
+        // The graph does not own imported textures. A final state of Unknown leaves the
+        // texture in whatever state its last pass needed.
+        ResourceId importTexture(nvrhi::ITexture* texture, nvrhi::ResourceStates initialState,
+            nvrhi::ResourceStates finalState = nvrhi::ResourceStates::Unknown);
+        ResourceId createTexture(const nvrhi::TextureDesc& desc);
+
+        PassId addPass(std::string name, ExecuteCallback execute = nullptr);
+        void read(PassId pass, ResourceId resource, nvrhi::ResourceStates state);
+
+        // A pass that keeps what was there, e.g. by blending or loading, also reads it
+        void write(PassId pass, ResourceId resource, nvrhi::ResourceStates state);
+
+        // Never cull the pass, e.g. for readbacks or queries that the graph cannot see
+        void setSideEffects(PassId pass);
+
+        // Memory requirements come from the callback, once per used transient; returns false
+        // if the graph declared nothing valid to run
+        bool compile(const RequirementsCallback& getRequirements = estimateRequirements);
+
+        // Record the kept passes with their barriers. Transients need a texture from
+        // setTexture(), done by TransientTexturePool::realize().
+        void execute(nvrhi::ICommandList* commandList) const;
+
+        // Results of compile()
+        const std::vector<PassId>& getExecutionOrder() const { return m_order; }
+        std::span<const Barrier> getBarriers(uint32_t orderIndex) const;   // Before the pass
+        std::span<const Barrier> getFinalBarriers() const;
+        bool isPassCulled(PassId pass) const { return !m_passes[pass].kept; }
+        bool isResourceUsed(ResourceId resource) const { return m_resources[resource].firstUse != InvalidId; }
+        uint64_t getTransientOffset(ResourceId resource) const { return m_resources[resource].offset; }
+        const nvrhi::MemoryRequirements& getRequirements(ResourceId resource) const { return m_resources[resource].requirements; }
+        uint64_t getHeapSize(HeapKind kind) const { return m_heapSizes[static_cast<int>(kind)]; }
+        Stats getStats() const { return m_stats; }
+
+        // Resources
+        uint32_t getResourceCount() const { return static_cast<uint32_t>(m_resources.size()); }
+        bool isTransient(ResourceId resource) const { return !m_resources[resource].imported; }
+        HeapKind getHeapKind(ResourceId resource) const { return m_resources[resource].heapKind; }
+        const nvrhi::TextureDesc& getTextureDesc(ResourceId resource) const { return m_resources[resource].desc; }
+        nvrhi::ITexture* getTexture(ResourceId resource) const { return m_resources[resource].texture; }
+        void setTexture(ResourceId resource, nvrhi::ITexture* texture) { m_resources[resource].texture = texture; }
+
+        const std::string& getPassName(PassId pass) const { return m_passes[pass].name; }
+        std::span<const Access> getAccesses(PassId pass) const { return m_passes[pass].accesses; }
+        uint32_t getPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+
+        // estimateTextureBytes() rounded up to 64 KB pages; for compiling without a device
+        static nvrhi::MemoryRequirements estimateRequirements(const nvrhi::TextureDesc& desc);
+
+    private:
+        struct Resource
+        {
+            nvrhi::TextureDesc desc;
+            nvrhi::ITexture* texture = nullptr;
+            nvrhi::ResourceStates initialState = nvrhi::ResourceStates::Unknown;
+            nvrhi::ResourceStates finalState = nvrhi::ResourceStates::Unknown;
+            bool imported = false;
+            HeapKind heapKind = HeapKind::Texture;
+
+            // Compiled
+            nvrhi::MemoryRequirements requirements;
+            uint64_t offset = InvalidOffset;
+            uint32_t firstUse = InvalidId;     // Execution order indices
+            uint32_t lastUse = InvalidId;
+        };
+
+        // A transient starting at orderIndex takes over memory that previous used
+        struct Alias
+        {
+            uint32_t orderIndex = 0;
+            ResourceId previous = InvalidId;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            ExecuteCallback execute;
+            std::vector<Access> accesses;
+            bool sideEffects = false;
+            bool kept = false;
+        };
+
+        void addAccess(PassId pass, ResourceId resource, nvrhi::ResourceStates state, bool write);
+        void cullPasses();
+        void computeBarriers();
+        bool placeTransients(const RequirementsCallback& getRequirements);
+
+    private:
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+
+        // Compiled
+        std::vector<PassId> m_order;
+        std::vector<Barrier> m_barriers;
+        std::vector<uint32_t> m_batchOffsets;  // Into m_barriers; one per kept pass, then the final batch and the end
+        std::vector<Alias> m_aliases;           // In execution order
+        uint64_t m_heapSizes[static_cast<int>(HeapKind::Count)] = {};
+        Stats m_stats;
+        nvrhi::ResourceStates m_transientState = nvrhi::ResourceStates::Common;
+
+        // Scratch, kept between compiles
+        std::vector<PassId> m_dependencies;     // Producers of what each pass reads, flattened
+        std::vector<uint32_t> m_dependencyOffsets;
+        std::vector<uint32_t> m_lastWriter;
+        std::vector<nvrhi::ResourceStates> m_states;
+        std::vector<uint32_t> m_batchSlots;
+        std::vector<ResourceId> m_transientStarts;
+        std::vector<ResourceId> m_transientEnds;
+        std::vector<uint32_t> m_allocationHandles;
+    };
+
+} // namespace common
@@ -0,0 +1,388 @@
+// ResourceAllocator.cpp
+// Placed buffers and textures sub-allocated from large device heaps
+
+#include "ResourceAllocator.h"
+#include "DeviceManager.h"
+#include "FrameTracker.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace common
+{
+
+static const char* heapTypeToString(nvrhi::HeapType type)
+{
+    switch (type)
+    {
+    case nvrhi::HeapType::Upload: return "Upload";
+    case nvrhi::HeapType::Readback: return "Readback";
+    default: return "DeviceLocal";
+    }
+}
+
+ResourceAllocator::ResourceAllocator(IDeviceManager& deviceManager, uint64_t blockSize)
+    : m_deviceManager(deviceManager)
+    , m_device(deviceManager.getDevice())
+    , m_blockSize(blockSize)
+{
+}
+
+ResourceAllocator::~ResourceAllocator()
+{
+    // Owners wait for the device first; live resources keep their own references
+    clear();
+    m_placements.clear();
+    m_heaps.clear();
+}
+
+ResourceAllocator::Heap* ResourceAllocator::createHeapLocked(nvrhi::HeapType type, Category category, uint64_t capacity, bool dedicated)
+{
+    static const char* const categoryNames[] = { "Buffers", "Textures", "RenderTargets" };
+
+    nvrhi::HeapDesc heapDesc;
+    heapDesc.capacity = capacity;
+    heapDesc.type = type;
+    heapDesc.debugName = std::string("ResourceAllocator.") + heapTypeToString(type) + "." +
+        categoryNames[static_cast<int>(category)] + (dedicated ? ".Dedicated" : "");
+
+    nvrhi::HeapHandle heap = m_device->createHeap(heapDesc);
+    if (!heap)
+    {
+        std::cerr << "[ResourceAllocator] Failed to create a " << capacity << " byte heap ("
+                  << heapDesc.debugName << ")" << std::endl;
+        return nullptr;
+    }
+
+    auto entry = std::make_unique<Heap>();
+    entry->heap = heap;
+    entry->allocator = std::make_unique<TlsfAllocator>(capacity);
+    entry->type = type;
+    entry->category = category;
+    entry->dedicated = dedicated;
+    m_heaps.push_back(std::move(entry));
+    return m_heaps.back().get();
+}
+
+ResourceAllocator::Heap* ResourceAllocator::allocateLocked(nvrhi::HeapType type, Category category,
+    const nvrhi::MemoryRequirements& requirements, const Heap* exclude, TlsfAllocator::Allocation& allocation)
+{
+    if (requirements.size == 0)
+        return nullptr;
+
+    const uint64_t alignment = std::max<uint64_t>(requirements.alignment, 1);
+
+    // Large resources would fragment the shared heaps more than they save
+    if (requirements.size > m_blockSize / 2)
+    {
+        if (exclude)
+            return nullptr;
+
+        // Whole allocator granules, or the range would not fit after rounding
+        uint64_t granule = std::max<uint64_t>(alignment, 256);
+        uint64_t capacity = (requirements.size + granule - 1) & ~(granule - 1);
+        Heap* heap = createHeapLocked(type, category, capacity, true);
+        if (!heap)
+            return nullptr;
+        allocation = heap->allocator->allocate(requirements.size, alignment);
+        return allocation ? heap : nullptr;
+    }
+
+    for (const auto& heap : m_heaps)
+    {
+        if (heap->dedicated || heap->type != type || heap->category != category || heap.get() == exclude)
+            continue;
+
+        allocation = heap->allocator->allocate(requirements.size, alignment);
+        if (allocation)
+            return heap.get();
+    }
+
+    // Moves only go into space that already exists
+    if (exclude)
+        return nullptr;
+
+    Heap* heap = createHeapLocked(type, category, m_blockSize, false);
+    if (!heap)
+        return nullptr;
+    allocation = heap->allocator->allocate(requirements.size, alignment);
+    return allocation ? heap : nullptr;
+}
+
+nvrhi::BufferHandle ResourceAllocator::createBuffer(nvrhi::BufferDesc desc, nvrhi::HeapType heapType)
+{
+    desc.isVirtual = true;
+    nvrhi::BufferHandle buffer = m_device->createBuffer(desc);
+    if (!buffer)
+    {
+        std::cerr << "[ResourceAllocator] Failed to create buffer " << desc.debugName << std::endl;
+        return nullptr;
+    }
+
+    nvrhi::MemoryRequirements requirements = m_device->getBufferMemoryRequirements(buffer);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TlsfAllocator::Allocation allocation;
+    Heap* heap = allocateLocked(heapType, Category::Buffer, requirements, nullptr, allocation);
+    if (!heap)
+    {
+        std::cerr << "[ResourceAllocator] Cannot place " << requirements.size << " bytes for buffer "
+                  << desc.debugName << std::endl;
+        return nullptr;
+    }
+
+    if (!m_device->bindBufferMemory(buffer, heap->heap, allocation.offset))
+    {
+        std::cerr << "[ResourceAllocator] Failed to bind buffer " << desc.debugName << std::endl;
+        heap->allocator->free(allocation.handle);
+        return nullptr;
+    }
+
+    Placement& placement = m_placements[buffer.Get()];
+    placement.heap = heap;
+    placement.handle = allocation.handle;
+    placement.size = allocation.size;
+    placement.resource = buffer.Get();
+    placement.buffer = buffer;
+    return buffer;
+}
+
+nvrhi::TextureHandle ResourceAllocator::createTexture(nvrhi::TextureDesc desc)
+{
+    desc.isVirtual = true;
+    nvrhi::TextureHandle texture = m_device->createTexture(desc);
+    if (!texture)
+    {
+        std::cerr << "[ResourceAllocator] Failed to create texture " << desc.debugName << std::endl;
+        return nullptr;
+    }
+
+    nvrhi::MemoryRequirements requirements = m_device->getTextureMemoryRequirements(texture);
+    Category category = desc.isRenderTarget ? Category::RenderTarget : Category::Texture;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TlsfAllocator::Allocation allocation;
+    Heap* heap = allocateLocked(nvrhi::HeapType::DeviceLocal, category, requirements, nullptr, allocation);
+    if (!heap)
+    {
+        std::cerr << "[ResourceAllocator] Cannot place " << requirements.size << " bytes for texture "
+                  << desc.debugName << std::endl;
+        return nullptr;
+    }
+
+    if (!m_device->bindTextureMemory(texture, heap->heap, allocation.offset))
+    {
+        std::cerr << "[ResourceAllocator] Failed to bind texture " << desc.debugName << std::endl;
+        heap->allocator->free(allocation.handle);
+        return nullptr;
+    }
+
+    Placement& placement = m_placements[texture.Get()];
+    placement.heap = heap;
+    placement.handle = allocation.handle;
+    placement.size = allocation.size;
+    placement.resource = texture.Get();
+    return texture;
+}
+
+void ResourceAllocator::releaseLocked(nvrhi::IResource* resource, uint64_t frameId)
+{
+    auto it = m_placements.find(resource);
+    if (it == m_placements.end())
+        return;
+
+    PendingFree pending;
+    pending.frameId = frameId;
+    pending.heap = it->second.heap;
+    pending.handle = it->second.handle;
+    pending.resource = std::move(it->second.resource);
+    m_pendingFrees.push_back(std::move(pending));
+    m_placements.erase(it);
+}
+
+void ResourceAllocator::release(nvrhi::IResource* resource)
+{
+    if (!resource)
+        return;
+
+    uint64_t frameId = m_deviceManager.getFrameTracker().getReleaseFrameId();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    releaseLocked(resource, frameId);
+}
+
+void ResourceAllocator::freePending(std::vector<PendingFree>& pending)
+{
+    // Placed resources go before their ranges are reused or their heaps destroyed, and
+    // final releases can be slow, so they happen outside the lock
+    for (PendingFree& entry : pending)
+    {
+        entry.resource = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const PendingFree& entry : pending)
+    {
+        entry.heap->allocator->free(entry.handle);
+    }
+    destroyEmptyHeapsLocked();
+}
+
+void ResourceAllocator::destroyEmptyHeapsLocked()
+{
+    // Keep one empty shared heap per pool, so a resource that comes and goes every few
+    // frames does not create and destroy a heap each time
+    std::vector<const Heap*> keptEmpty;
+    auto it = std::remove_if(m_heaps.begin(), m_heaps.end(), [&](const std::unique_ptr<Heap>& heap)
+    {
+        if (!heap->allocator->isEmpty())
+            return false;
+        if (heap->dedicated)
+            return true;
+
+        for (const Heap* kept : keptEmpty)
+        {
+            if (kept->type == heap->type && kept->category == heap->category)
+                return true;
+        }
+        keptEmpty.push_back(heap.get());
+        return false;
+    });
+    m_heaps.erase(it, m_heaps.end());
+}
+
+void ResourceAllocator::update()
+{
+    std::vector<PendingFree> retired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_deviceManager.getFrameTracker().collectRetired(m_pendingFrees, retired);
+    }
+
+    if (!retired.empty())
+        freePending(retired);
+}
+
+void ResourceAllocator::clear()
+{
+    std::vector<PendingFree> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.assign(std::make_move_iterator(m_pendingFrees.begin()), std::make_move_iterator(m_pendingFrees.end()));
+        m_pendingFrees.clear();
+    }
+
+    if (!pending.empty())
+        freePending(pending);
+}
+
+std::vector<ResourceAllocator::Move> ResourceAllocator::defragment(nvrhi::ICommandList* commandList, uint64_t maxBytes)
+{
+    std::vector<Move> moves;
+    uint64_t frameId = m_deviceManager.getFrameTracker().getReleaseFrameId();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Pick the least occupied shared buffer heap of each pool as the one to empty. Moves
+    // only go into other existing heaps, so a pool with a single heap has nowhere to go.
+    std::vector<Heap*> sources;
+    std::vector<uint32_t> heapCounts;
+    for (const auto& heap : m_heaps)
+    {
+        if (heap->dedicated || heap->category != Category::Buffer || heap->allocator->isEmpty())
+            continue;
+
+        auto same = std::find_if(sources.begin(), sources.end(), [&](const Heap* source)
+        {
+            return source->type == heap->type;
+        });
+        if (same == sources.end())
+        {
+            sources.push_back(heap.get());
+            heapCounts.push_back(1);
+            continue;
+        }
+
+        heapCounts[same - sources.begin()]++;
+        if (heap->allocator->getUsedBytes() < (*same)->allocator->getUsedBytes())
+            *same = heap.get();
+    }
+    for (size_t i = sources.size(); i-- > 0;)
+    {
+        if (heapCounts[i] < 2)
+            sources.erase(sources.begin() + i);
+    }
+
+    // Collected first, since moving adds placements
+    std::vector<nvrhi::BufferHandle> candidates;
+    for (const auto& [resource, placement] : m_placements)
+    {
+        if (placement.buffer && std::find(sources.begin(), sources.end(), placement.heap) != sources.end())
+            candidates.push_back(placement.buffer);
+    }
+
+    uint64_t movedBytes = 0;
+    for (const nvrhi::BufferHandle& from : candidates)
+    {
+        const Placement& source = m_placements[from.Get()];
+        if (movedBytes + source.size > maxBytes)
+            break;
+
+        // Reserve the destination before creating anything; the same desc has the same
+        // requirements. Once the other heaps are full, the remaining buffers cannot move either.
+        nvrhi::MemoryRequirements requirements = m_device->getBufferMemoryRequirements(from);
+        TlsfAllocator::Allocation allocation;
+        Heap* heap = allocateLocked(source.heap->type, Category::Buffer, requirements, source.heap, allocation);
+        if (!heap)
+            break;
+
+        nvrhi::BufferDesc desc = from->getDesc();
+        nvrhi::BufferHandle to = m_device->createBuffer(desc);
+        if (!to || !m_device->bindBufferMemory(to, heap->heap, allocation.offset))
+        {
+            std::cerr << "[ResourceAllocator] Failed to place a moved copy of buffer " << desc.debugName << std::endl;
+            heap->allocator->free(allocation.handle);
+            break;
+        }
+
+        commandList->copyBuffer(to, 0, from, 0, desc.byteSize);
+        movedBytes += source.size;
+
+        Placement& placement = m_placements[to.Get()];
+        placement.heap = heap;
+        placement.handle = allocation.handle;
+        placement.size = allocation.size;
+        placement.resource = to.Get();
+        placement.buffer = to;
+
+        releaseLocked(from, frameId);
+        moves.push_back({ from, to });
+    }
+
+    m_movedBuffers += moves.size();
+    return moves;
+}
+
+ResourceAllocator::Stats ResourceAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats;
+    for (const auto& heap : m_heaps)
+    {
+        const TlsfAllocator& allocator = *heap->allocator;
+        stats.heapCount++;
+        if (heap->dedicated)
+            stats.dedicatedHeapCount++;
+        else
+            stats.fragmentation = std::max(stats.fragmentation, allocator.getFragmentation());
+        stats.reservedBytes += allocator.getCapacity();
+        stats.usedBytes += allocator.getUsedBytes();
+    }
+    stats.allocationCount = m_placements.size();
+    stats.pendingFrees = m_pendingFrees.size();
+    stats.movedBuffers = m_movedBuffers;
+    return stats;
+}
+
+} // namespace common
@@ -0,0 +1,141 @@
+// ResourceAllocator.h
+// Placed buffers and textures sub-allocated from large device heaps
+
+#pragma once
+
+#include "TlsfAllocator.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // Creates buffers and textures as placed resources in a few large heaps instead of
+    // one device allocation each. Heaps are pooled by heap type and resource category
+    // (buffers, textures, render targets), since D3D12 resource heap tier 1 cannot mix
+    // the categories. Space within a heap comes from a TlsfAllocator; resources larger
+    // than half a block get a dedicated heap.
+    //
+    // NVRHI reports only the size and alignment a resource needs, not the Vulkan memory
+    // types it allows. A heap gets the memory type NVRHI picks for its heap type, so a
+    // resource restricted to other memory types must not be created here.
+    //
+    // The allocator holds a reference to every resource it created until release(), which
+    // frees the range once the frame being recorded has retired, like the deletion queue.
+    // defragment() moves buffers out of sparsely used heaps so that update() can give the
+    // heaps back to the device. All methods are thread-safe.
+    class ResourceAllocator
+    {
+    public:
+        static constexpr uint64_t DefaultBlockSize = 64ull << 20;
+
+        struct Stats
+        {
+            uint64_t heapCount = 0;
+            uint64_t dedicatedHeapCount = 0;
+            uint64_t reservedBytes = 0;     // Capacity of all heaps
+            uint64_t usedBytes = 0;         // Live and pending ranges
+            uint64_t allocationCount = 0;
+            uint64_t pendingFrees = 0;
+            uint64_t movedBuffers = 0;      // By defragment() since creation
+            double fragmentation = 0.0;     // Worst of the shared heaps, see TlsfAllocator
+        };
+
+        // A buffer moved by defragment(). Users of the old handle switch to the new one
+        // before recording commands after the copy.
+        struct Move
+        {
+            nvrhi::BufferHandle from;
+            nvrhi::BufferHandle to;
+        };
+
+        explicit ResourceAllocator(IDeviceManager& deviceManager, uint64_t blockSize = DefaultBlockSize);
+        ~ResourceAllocator();
+
+        ResourceAllocator(const ResourceAllocator&) = delete;
+        ResourceAllocator& operator=(const ResourceAllocator&) = delete;
+
+        // The desc's isVirtual flag is set by the allocator; returns null on failure
+        nvrhi::BufferHandle createBuffer(nvrhi::BufferDesc desc, nvrhi::HeapType heapType = nvrhi::HeapType::DeviceLocal);
+        nvrhi::TextureHandle createTexture(nvrhi::TextureDesc desc);
+
+        // The caller drops its own handle afterwards; resources the allocator did not
+        // create are ignored
+        void release(nvrhi::IResource* resource);
+
+        // Free the ranges of retired frames and heaps left empty; call once per frame
+        void update();
+
+        // Record copies moving buffers out of the least occupied shared heap of each pool,
+        // up to maxBytes in total. The old buffers are released as if by release().
+        std::vector<Move> defragment(nvrhi::ICommandList* commandList, uint64_t maxBytes);
+
+        // Free every pending range immediately; only valid once the device is idle
+        void clear();
+
+        Stats getStats() const;
+
+    private:
+        // Resources that may share a heap
+        enum class Category : uint8_t
+        {
+            Buffer,
+            Texture,
+            RenderTarget
+        };
+
+        struct Heap
+        {
+            nvrhi::HeapHandle heap;
+            std::unique_ptr<TlsfAllocator> allocator;
+            nvrhi::HeapType type = nvrhi::HeapType::DeviceLocal;
+            Category category = Category::Buffer;
+            bool dedicated = false;
+        };
+
+        struct Placement
+        {
+            Heap* heap = nullptr;
+            uint32_t handle = TlsfAllocator::InvalidHandle;
+            uint64_t size = 0;
+            nvrhi::ResourceHandle resource;
+            nvrhi::BufferHandle buffer;     // Null for textures, which are never moved
+        };
+
+        struct PendingFree
+        {
+            uint64_t frameId = 0;
+            Heap* heap = nullptr;
+            uint32_t handle = TlsfAllocator::InvalidHandle;
+            nvrhi::ResourceHandle resource;
+        };
+
+        // Find space in a heap of the pool other than exclude, creating a heap if needed
+        Heap* allocateLocked(nvrhi::HeapType type, Category category, const nvrhi::MemoryRequirements& requirements,
+            const Heap* exclude, TlsfAllocator::Allocation& allocation);
+        Heap* createHeapLocked(nvrhi::HeapType type, Category category, uint64_t capacity, bool dedicated);
+        void releaseLocked(nvrhi::IResource* resource, uint64_t frameId);
+        void freePending(std::vector<PendingFree>& pending);
+        void destroyEmptyHeapsLocked();
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::DeviceHandle m_device;
+        uint64_t m_blockSize = DefaultBlockSize;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Heap>> m_heaps;
+        std::unordered_map<nvrhi::IResource*, Placement> m_placements;
+        std::deque<PendingFree> m_pendingFrees;     // In frame order
+        uint64_t m_movedBuffers = 0;
+    };
+
+} // namespace common
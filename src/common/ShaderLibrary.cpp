@@ -0,0 +1,525 @@
+// ShaderLibrary.cpp
+// Runtime Slang compilation with a content-addressed binary cache
+
+#include "ShaderLibrary.h"
+#include "DeviceManager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace common
+{
+
+// FNV-1a; cache keys only need to be stable across runs, not cryptographic
+static uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static const char* getStageName(nvrhi::ShaderType shaderType)
+{
+    switch (shaderType)
+    {
+    case nvrhi::ShaderType::Vertex:   return "vertex";
+    case nvrhi::ShaderType::Hull:     return "hull";
+    case nvrhi::ShaderType::Domain:   return "domain";
+    case nvrhi::ShaderType::Geometry: return "geometry";
+    case nvrhi::ShaderType::Pixel:    return "fragment";
+    case nvrhi::ShaderType::Compute:  return "compute";
+    default:                          return nullptr;
+    }
+}
+
+// Resolve a program the way runProcess() does: as given if it names a directory,
+// otherwise the first match on the PATH. Empty if there is none.
+static std::filesystem::path findExecutable(const std::string& program)
+{
+    std::error_code ec;
+    std::filesystem::path path(program);
+#ifdef _WIN32
+    const char separator = ';';
+    if (!path.has_extension())
+        path += ".exe";
+#else
+    const char separator = ':';
+#endif
+
+    if (path.has_parent_path())
+        return std::filesystem::is_regular_file(path, ec) ? path : std::filesystem::path();
+
+    const char* searchPath = std::getenv("PATH");
+    std::istringstream directories(searchPath ? searchPath : "");
+    std::string directory;
+    while (std::getline(directories, directory, separator))
+    {
+        std::filesystem::path candidate = std::filesystem::path(directory.empty() ? "." : directory) / path;
+        if (std::filesystem::is_regular_file(candidate, ec))
+            return candidate;
+    }
+    return {};
+}
+
+#ifdef _WIN32
+// Quote an argument so that CommandLineToArgvW and the C runtime give it back unchanged:
+// backslashes only escape when they precede a quote
+static void appendQuotedArgument(std::string& commandLine, const std::string& argument)
+{
+    if (!argument.empty() && argument.find_first_of(" \t\n\v\"") == std::string::npos)
+    {
+        commandLine += argument;
+        return;
+    }
+
+    commandLine += '"';
+    for (auto it = argument.begin();; ++it)
+    {
+        size_t backslashes = 0;
+        while (it != argument.end() && *it == '\\')
+        {
+            ++it;
+            backslashes++;
+        }
+
+        if (it == argument.end())
+        {
+            commandLine.append(backslashes * 2, '\\');
+            break;
+        }
+
+        commandLine.append(*it == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+        commandLine += *it;
+    }
+    commandLine += '"';
+}
+#endif
+
+// Run a program, looked up on the PATH if the first argument has no directory, and wait
+// for it. The arguments reach it unchanged, with no shell in between. If output is given,
+// it receives everything the program wrote to stdout and stderr. Returns the exit code,
+// or -1 if the program could not be started.
+static int runProcess(const std::vector<std::string>& arguments, std::string* output = nullptr)
+{
+#ifdef _WIN32
+    std::string commandLine;
+    for (const std::string& argument : arguments)
+    {
+        if (!commandLine.empty())
+            commandLine += ' ';
+        appendQuotedArgument(commandLine, argument);
+    }
+
+    STARTUPINFOA startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    HANDLE readPipe = nullptr;
+    HANDLE writePipe = nullptr;
+    if (output)
+    {
+        SECURITY_ATTRIBUTES security = { sizeof(security), nullptr, TRUE };
+        if (!CreatePipe(&readPipe, &writePipe, &security, 0))
+            return -1;
+        SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+
+        startupInfo.dwFlags = STARTF_USESTDHANDLES;
+        startupInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+        startupInfo.hStdOutput = writePipe;
+        startupInfo.hStdError = writePipe;
+    }
+
+    PROCESS_INFORMATION processInfo = {};
+    BOOL created = CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, output ? TRUE : FALSE, 0,
+        nullptr, nullptr, &startupInfo, &processInfo);
+    if (output)
+    {
+        // Only the child holds the write end now, so reading ends when it exits
+        CloseHandle(writePipe);
+        char buffer[256];
+        DWORD bytesRead = 0;
+        while (created && ReadFile(readPipe, buffer, sizeof(buffer), &bytesRead, nullptr) && bytesRead > 0)
+        {
+            output->append(buffer, bytesRead);
+        }
+        CloseHandle(readPipe);
+    }
+    if (!created)
+        return -1;
+
+    DWORD exitCode = DWORD(-1);
+    WaitForSingleObject(processInfo.hProcess, INFINITE);
+    GetExitCodeProcess(processInfo.hProcess, &exitCode);
+    CloseHandle(processInfo.hThread);
+    CloseHandle(processInfo.hProcess);
+    return int(exitCode);
+#else
+    std::vector<char*> argv;
+    for (const std::string& argument : arguments)
+    {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    int pipeFds[2] = { -1, -1 };
+    if (output)
+    {
+        // Close-on-exec, so compilers started by other threads do not hold the pipe open
+        if (pipe(pipeFds) != 0)
+        {
+            posix_spawn_file_actions_destroy(&actions);
+            return -1;
+        }
+        fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(pipeFds[1], F_SETFD, FD_CLOEXEC);
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDERR_FILENO);
+    }
+
+    pid_t pid = 0;
+    int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (output)
+    {
+        close(pipeFds[1]);
+        char buffer[256];
+        while (error == 0)
+        {
+            ssize_t bytesRead = read(pipeFds[0], buffer, sizeof(buffer));
+            if (bytesRead > 0)
+                output->append(buffer, size_t(bytesRead));
+            else if (bytesRead == 0 || errno != EINTR)
+                break;
+        }
+        close(pipeFds[0]);
+    }
+    if (error != 0)
+        return -1;
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+// Read-only view of a whole file, unmapped on destruction
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+            return;
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+            return;
+
+        m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (m_data)
+            m_size = size_t(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = data;
+                m_size = size_t(st.st_size);
+            }
+        }
+
+        // The mapping keeps the file contents alive on its own
+        close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+        if (m_data) munmap(m_data, m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
+
+ShaderLibrary::ShaderLibrary(IDeviceManager& deviceManager, std::string cacheDirectory)
+    : m_deviceManager(deviceManager)
+    , m_cacheDirectory(std::move(cacheDirectory))
+{
+}
+
+void ShaderLibrary::setCompilerPath(std::string compilerPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_compilerPath = std::move(compilerPath);
+    m_cacheValidated = false;
+}
+
+void ShaderLibrary::validateCache()
+{
+    // Once per library; lookups wait for it, since a stale cache must not hit
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cacheValidated)
+        return;
+    m_cacheValidated = true;
+
+    // No compiler: what is cached is all there is, whoever built it
+    std::filesystem::path executable = findExecutable(m_compilerPath);
+    if (executable.empty())
+        return;
+
+    std::error_code ec;
+    std::ostringstream stamp;
+    stamp << executable.string() << '|' << std::filesystem::file_size(executable, ec) << '|'
+          << std::filesystem::last_write_time(executable, ec).time_since_epoch().count();
+
+    // Line 1: the executable's stamp, line 2: its version
+    std::filesystem::path manifestPath = std::filesystem::path(m_cacheDirectory) / "compiler.txt";
+    std::string manifestStamp;
+    std::string manifestVersion;
+    bool hasManifest = false;
+    {
+        std::ifstream manifest(manifestPath);
+        hasManifest = std::getline(manifest, manifestStamp) && std::getline(manifest, manifestVersion);
+    }
+
+    // The same executable as last time is not run at all
+    if (hasManifest && manifestStamp == stamp.str())
+        return;
+
+    std::string version;
+    if (runProcess({ m_compilerPath, "-version" }, &version) != 0)
+    {
+        std::cerr << "[ShaderLibrary] Failed to query the version of " << m_compilerPath << std::endl;
+        return;
+    }
+    std::replace(version.begin(), version.end(), '\n', ' ');
+    version.erase(version.find_last_not_of(" \t\r") + 1);
+
+    if (hasManifest && manifestVersion != version)
+    {
+        std::cout << "[ShaderLibrary] Compiler changed from " << manifestVersion << " to " << version
+                  << ", clearing " << m_cacheDirectory << std::endl;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_cacheDirectory, ec))
+        {
+            std::filesystem::path extension = entry.path().extension();
+            if (extension == ".spv" || extension == ".dxil")
+                std::filesystem::remove(entry.path(), ec);
+        }
+    }
+
+    std::filesystem::create_directories(m_cacheDirectory, ec);
+    std::ofstream manifest(manifestPath, std::ios::trunc);
+    manifest << stamp.str() << '\n' << version << '\n';
+}
+
+uint64_t ShaderLibrary::getSourceHash(const std::string& sourcePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sourceHashes.find(sourcePath);
+        if (it != m_sourceHashes.end())
+            return it->second;
+    }
+
+    uint64_t hash = 0;
+    std::ifstream file(sourcePath, std::ios::binary);
+    if (file.is_open())
+    {
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        hash = hashBytes(source.data(), source.size());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sourceHashes[sourcePath] = hash;
+    return hash;
+}
+
+std::string ShaderLibrary::compile(const ShaderCompileDesc& desc)
+{
+    const bool d3d12 = m_deviceManager.getGraphicsAPI() == GraphicsAPI::D3D12;
+    const char* target = d3d12 ? "dxil" : "spirv";
+    const char* profile = d3d12 ? "sm_6_0" : "glsl_450";
+
+    if (!getStageName(desc.shaderType))
+    {
+        std::cerr << "[ShaderLibrary] Unsupported shader stage for " << desc.entryPoint << std::endl;
+        m_failureCount++;
+        return {};
+    }
+
+    uint64_t sourceHash = getSourceHash(desc.sourcePath);
+    if (sourceHash == 0)
+    {
+        std::cerr << "[ShaderLibrary] Failed to read shader source " << desc.sourcePath << std::endl;
+        m_failureCount++;
+        return {};
+    }
+
+    // Defines are sorted so the same set in a different order shares a binary
+    std::vector<ShaderMacro> defines = desc.defines;
+    std::sort(defines.begin(), defines.end(),
+        [](const ShaderMacro& a, const ShaderMacro& b) { return a.name < b.name; });
+
+    // The compiler is not part of the key; validateCache() drops binaries it did not build
+    validateCache();
+    std::ostringstream key;
+    key << std::hex << sourceHash << '|' << desc.entryPoint << '|' << getStageName(desc.shaderType)
+        << '|' << target << '|' << profile;
+    for (const ShaderMacro& define : defines)
+        key << '|' << define.name << '=' << define.value;
+
+    const std::string keyString = key.str();
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.%s",
+        static_cast<unsigned long long>(hashBytes(keyString.data(), keyString.size())), d3d12 ? "dxil" : "spv");
+
+    std::filesystem::path binaryPath = std::filesystem::path(m_cacheDirectory) / fileName;
+    std::error_code ec;
+    if (std::filesystem::exists(binaryPath, ec))
+    {
+        m_cacheHits++;
+        return binaryPath.string();
+    }
+
+    std::filesystem::create_directories(binaryPath.parent_path(), ec);
+
+    // Compile to a file unique to this thread and rename it into place, so concurrent
+    // compiles of the same key never observe a partially written binary
+    std::filesystem::path tempPath = binaryPath;
+    tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    ShaderCompileDesc sortedDesc = desc;
+    sortedDesc.defines = std::move(defines);
+    if (!runCompiler(sortedDesc, tempPath.string()))
+    {
+        std::filesystem::remove(tempPath, ec);
+        std::cerr << "[ShaderLibrary] Failed to compile " << desc.sourcePath << " (" << desc.entryPoint << ")" << std::endl;
+        m_failureCount++;
+        return {};
+    }
+
+    std::filesystem::rename(tempPath, binaryPath, ec);
+    if (ec)
+    {
+        // Another thread may have won the race with an identical binary
+        std::filesystem::remove(tempPath, ec);
+        if (!std::filesystem::exists(binaryPath, ec))
+        {
+            std::cerr << "[ShaderLibrary] Failed to write " << binaryPath.string() << std::endl;
+            m_failureCount++;
+            return {};
+        }
+    }
+
+    m_compileCount++;
+    return binaryPath.string();
+}
+
+bool ShaderLibrary::runCompiler(const ShaderCompileDesc& desc, const std::string& outputPath) const
+{
+    const bool d3d12 = m_deviceManager.getGraphicsAPI() == GraphicsAPI::D3D12;
+
+    std::vector<std::string> arguments = {
+        m_compilerPath,
+        desc.sourcePath,
+        "-target", d3d12 ? "dxil" : "spirv",
+        "-profile", d3d12 ? "sm_6_0" : "glsl_450",
+        "-entry", desc.entryPoint,
+        "-stage", getStageName(desc.shaderType),
+    };
+    for (const ShaderMacro& define : desc.defines)
+    {
+        arguments.push_back("-D" + define.name + (define.value.empty() ? "" : "=" + define.value));
+    }
+    arguments.push_back("-o");
+    arguments.push_back(outputPath);
+
+    return runProcess(arguments) == 0 && std::filesystem::exists(outputPath);
+}
+
+nvrhi::ShaderHandle ShaderLibrary::createShader(const ShaderCompileDesc& desc, const std::string& debugName)
+{
+    std::string binaryPath = compile(desc);
+    if (binaryPath.empty())
+        return nullptr;
+
+    MappedFile binary(binaryPath);
+    if (!binary.data())
+    {
+        std::cerr << "[ShaderLibrary] Failed to map " << binaryPath << std::endl;
+        m_failureCount++;
+        return nullptr;
+    }
+
+    // slangc renames the SPIR-V entry point to "main"; DXIL keeps the original name
+    nvrhi::ShaderDesc shaderDesc;
+    shaderDesc.shaderType = desc.shaderType;
+    shaderDesc.debugName = debugName.empty() ? desc.entryPoint : debugName;
+    shaderDesc.entryName = m_deviceManager.getGraphicsAPI() == GraphicsAPI::Vulkan ? "main" : desc.entryPoint;
+
+    // NVRHI copies the bytecode, so the mapping can go away once the shader exists
+    return m_deviceManager.getDevice()->createShader(shaderDesc, binary.data(), binary.size());
+}
+
+} // namespace common
@@ -0,0 +1,85 @@
+// ShaderLibrary.h
+// Runtime Slang compilation with a content-addressed binary cache
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    struct ShaderMacro
+    {
+        std::string name;
+        std::string value;
+    };
+
+    struct ShaderCompileDesc
+    {
+        std::string sourcePath;
+        std::string entryPoint;
+        nvrhi::ShaderType shaderType = nvrhi::ShaderType::None;
+        std::vector<ShaderMacro> defines;
+    };
+
+    // Compiles .slang sources with slangc on first use and keeps the resulting SPIR-V or
+    // DXIL in a cache directory, named by a hash of the source text, entry point, stage,
+    // target profile and defines. A cache hit maps the binary straight into memory, so a
+    // warm start runs no build step. The compiler is started directly with an argument
+    // list, never through a shell.
+    //
+    // A manifest in the cache directory records the version of the compiler that built
+    // it, with the executable's size and modification time. The executable is checked
+    // against it once per library, without running it; a changed executable is asked for
+    // its version, and if that differs the cached binaries are deleted. Without a compiler
+    // the cache is used as it is, so a cache built on another machine still hits.
+    //
+    // The hash covers the top-level source file only; edits to imported modules need the
+    // cache directory cleared. All methods are thread-safe.
+    class ShaderLibrary
+    {
+    public:
+        ShaderLibrary(IDeviceManager& deviceManager, std::string cacheDirectory);
+
+        // slangc executable; defaults to "slangc" on the PATH. Call before compiling.
+        void setCompilerPath(std::string compilerPath);
+
+        // Compile if needed and return the cached binary's path (empty on failure)
+        std::string compile(const ShaderCompileDesc& desc);
+
+        // Compile if needed and create the shader from the mapped binary
+        nvrhi::ShaderHandle createShader(const ShaderCompileDesc& desc, const std::string& debugName = {});
+
+        uint64_t getCacheHits() const { return m_cacheHits; }
+        uint64_t getCompileCount() const { return m_compileCount; }
+        uint64_t getFailureCount() const { return m_failureCount; }
+
+    private:
+        uint64_t getSourceHash(const std::string& sourcePath);
+        void validateCache();
+        bool runCompiler(const ShaderCompileDesc& desc, const std::string& outputPath) const;
+
+    private:
+        IDeviceManager& m_deviceManager;
+        std::string m_cacheDirectory;
+        std::string m_compilerPath = "slangc";
+
+        // Source files are hashed once per library; a failed read is cached as 0
+        std::mutex m_mutex;
+        std::unordered_map<std::string, uint64_t> m_sourceHashes;
+        bool m_cacheValidated = false;
+
+        std::atomic<uint64_t> m_cacheHits = 0;
+        std::atomic<uint64_t> m_compileCount = 0;
+        std::atomic<uint64_t> m_failureCount = 0;
+    };
+
+} // namespace common
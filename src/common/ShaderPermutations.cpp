@@ -0,0 +1,126 @@
+// ShaderPermutations.cpp
+// Shader variants over declared define axes, compiled in parallel or on first use
+
+#include "ShaderPermutations.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+namespace common
+{
+
+ShaderPermutationSet::ShaderPermutationSet(ShaderLibrary& library, ShaderCompileDesc baseDesc,
+    std::vector<ShaderPermutationAxis> axes)
+    : m_library(library)
+    , m_baseDesc(std::move(baseDesc))
+    , m_axes(std::move(axes))
+{
+    uint64_t count = 1;
+    for (const ShaderPermutationAxis& axis : m_axes)
+    {
+        count *= std::max<size_t>(axis.values.size(), 1);
+        if (count >= InvalidKey)
+        {
+            std::cerr << "[ShaderLibrary] Too many permutations for " << m_baseDesc.entryPoint << std::endl;
+            count = 0;
+            break;
+        }
+    }
+
+    m_permutationCount = static_cast<uint32_t>(count);
+    m_entries = std::make_unique<Entry[]>(m_permutationCount);
+}
+
+uint32_t ShaderPermutationSet::getKey(const std::vector<ShaderMacro>& values) const
+{
+    uint32_t key = 0;
+    uint32_t stride = 1;
+
+    for (const ShaderPermutationAxis& axis : m_axes)
+    {
+        uint32_t valueIndex = 0;
+        for (const ShaderMacro& value : values)
+        {
+            if (value.name != axis.name)
+                continue;
+
+            auto it = std::find(axis.values.begin(), axis.values.end(), value.value);
+            if (it == axis.values.end())
+                return InvalidKey;
+            valueIndex = static_cast<uint32_t>(it - axis.values.begin());
+        }
+
+        key += valueIndex * stride;
+        stride *= static_cast<uint32_t>(std::max<size_t>(axis.values.size(), 1));
+    }
+
+    // Reject names that do not belong to any axis
+    for (const ShaderMacro& value : values)
+    {
+        auto matches = [&](const ShaderPermutationAxis& axis) { return axis.name == value.name; };
+        if (std::none_of(m_axes.begin(), m_axes.end(), matches))
+            return InvalidKey;
+    }
+
+    return key < m_permutationCount ? key : InvalidKey;
+}
+
+std::vector<ShaderMacro> ShaderPermutationSet::getDefines(uint32_t key) const
+{
+    std::vector<ShaderMacro> defines;
+    if (key >= m_permutationCount)
+        return defines;
+
+    for (const ShaderPermutationAxis& axis : m_axes)
+    {
+        if (axis.values.empty())
+            continue;
+
+        uint32_t radix = static_cast<uint32_t>(axis.values.size());
+        defines.push_back({ axis.name, axis.values[key % radix] });
+        key /= radix;
+    }
+    return defines;
+}
+
+nvrhi::ShaderHandle ShaderPermutationSet::getShader(uint32_t key)
+{
+    if (key >= m_permutationCount)
+        return nullptr;
+
+    Entry& entry = m_entries[key];
+    std::call_once(entry.created, [&]()
+    {
+        ShaderCompileDesc desc = m_baseDesc;
+        std::string debugName = m_baseDesc.entryPoint;
+        for (ShaderMacro& define : getDefines(key))
+        {
+            debugName += " " + define.name + "=" + define.value;
+            desc.defines.push_back(std::move(define));
+        }
+
+        entry.shader = m_library.createShader(desc, debugName);
+    });
+
+    return entry.shader;
+}
+
+bool ShaderPermutationSet::createAll(ThreadPool& pool)
+{
+    std::atomic<uint32_t> failures = 0;
+    for (uint32_t key = 0; key < m_permutationCount; key++)
+    {
+        pool.submit([this, key, &failures]()
+        {
+            if (!getShader(key))
+                failures++;
+        });
+    }
+
+    pool.waitIdle();
+    return failures == 0;
+}
+
+} // namespace common
@@ -0,0 +1,70 @@
+// ShaderPermutations.h
+// Shader variants over declared define axes, compiled in parallel or on first use
+
+#pragma once
+
+#include "ShaderLibrary.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace common
+{
+    class ThreadPool;
+
+    // One define and the values it can take; the first value is the default
+    struct ShaderPermutationAxis
+    {
+        std::string name;
+        std::vector<std::string> values;
+    };
+
+    // Every combination of axis values for one entry point. A permutation is addressed
+    // by a dense key (the axis value indices in mixed radix, first axis fastest), so
+    // looking up a variant is an array index no matter how many there are.
+    //
+    // Shaders are created on first request, or all at once with createAll(). Both paths
+    // are thread-safe and create each permutation at most once.
+    class ShaderPermutationSet
+    {
+    public:
+        static constexpr uint32_t InvalidKey = ~0u;
+
+        ShaderPermutationSet(ShaderLibrary& library, ShaderCompileDesc baseDesc,
+            std::vector<ShaderPermutationAxis> axes);
+
+        uint32_t getPermutationCount() const { return m_permutationCount; }
+
+        // Axes not listed take their default value. Returns InvalidKey for an unknown
+        // axis or value.
+        uint32_t getKey(const std::vector<ShaderMacro>& values) const;
+        std::vector<ShaderMacro> getDefines(uint32_t key) const;
+
+        // Returns null if the key is invalid or the permutation failed to compile
+        nvrhi::ShaderHandle getShader(uint32_t key);
+
+        // Create every permutation on the pool and wait for them. Returns false if any
+        // failed. Waits for the pool to go idle, so other work on it is waited for too.
+        bool createAll(ThreadPool& pool);
+
+    private:
+        struct Entry
+        {
+            std::once_flag created;
+            nvrhi::ShaderHandle shader;
+        };
+
+    private:
+        ShaderLibrary& m_library;
+        ShaderCompileDesc m_baseDesc;
+        std::vector<ShaderPermutationAxis> m_axes;
+
+        uint32_t m_permutationCount = 0;
+        std::unique_ptr<Entry[]> m_entries;
+    };
+
+} // namespace common
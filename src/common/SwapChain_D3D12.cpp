@@ -0,0 +1,242 @@
+// SwapChain_D3D12.cpp
+// DXGI flip-model swap chain for one window
+
+#ifdef _WIN32
+
+#include "SwapChain_D3D12.h"
+#include "DeviceManager_D3D12.h"
+
+#include <GLFW/glfw3.h>
+#define GLFW_EXPOSE_NATIVE_WIN32
+#include <GLFW/glfw3native.h>
+
+#include <iostream>
+#include <string>
+
+namespace common
+{
+
+SwapChain_D3D12::SwapChain_D3D12(DeviceManager_D3D12& deviceManager, GLFWwindow* window, uint32_t width, uint32_t height)
+    : m_deviceManager(deviceManager)
+    , m_window(window)
+    , m_width(width)
+    , m_height(height)
+{
+}
+
+SwapChain_D3D12::~SwapChain_D3D12()
+{
+    destroy();
+}
+
+nvrhi::IFramebuffer* SwapChain_D3D12::getCurrentFramebuffer() const
+{
+    return m_framebuffers.empty() ? nullptr : m_framebuffers[m_currentBackBuffer].Get();
+}
+
+nvrhi::ITexture* SwapChain_D3D12::getCurrentBackBuffer() const
+{
+    return m_textures.empty() ? nullptr : m_textures[m_currentBackBuffer].Get();
+}
+
+bool SwapChain_D3D12::create()
+{
+    DeviceManager_D3D12& dm = m_deviceManager;
+    const DeviceCreationParams& params = dm.m_params;
+    m_format = params.swapChainFormat;
+
+    // Get native window handle
+    m_hwnd = glfwGetWin32Window(m_window);
+    if (!m_hwnd)
+    {
+        std::cerr << "[D3D12] Failed to get Win32 window handle" << std::endl;
+        return false;
+    }
+
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    swapChainDesc.Width = m_width;
+    swapChainDesc.Height = m_height;
+    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.BufferCount = params.swapChainBufferCount;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+
+    // Flip model has no relaxed FIFO, and sync interval 0 without tearing behaves like
+    // MAILBOX. True IMMEDIATE needs tearing support, otherwise it falls back to MAILBOX.
+    BOOL allowTearing = FALSE;
+    dm.m_dxgiFactory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
+
+    m_swapChainFlags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+    m_syncInterval = 1;
+    m_presentFlags = 0;
+    switch (params.presentMode)
+    {
+    case PresentMode::Immediate:
+        if (allowTearing)
+        {
+            m_presentMode = PresentMode::Immediate;
+            m_swapChainFlags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+            m_syncInterval = 0;
+            m_presentFlags = DXGI_PRESENT_ALLOW_TEARING;
+            break;
+        }
+        [[fallthrough]];
+    case PresentMode::Mailbox:
+        m_presentMode = PresentMode::Mailbox;
+        m_syncInterval = 0;
+        break;
+    default:
+        m_presentMode = PresentMode::Fifo;
+        break;
+    }
+    swapChainDesc.Flags = m_swapChainFlags;
+
+    std::cout << "[D3D12] Present mode " << presentModeToString(m_presentMode);
+    if (m_presentMode != params.presentMode)
+        std::cout << " (" << presentModeToString(params.presentMode) << " not supported)";
+    std::cout << std::endl;
+
+    Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain1;
+    if (FAILED(dm.m_dxgiFactory->CreateSwapChainForHwnd(
+        dm.m_commandQueue.Get(), m_hwnd, &swapChainDesc, nullptr, nullptr, &swapChain1)))
+    {
+        std::cerr << "[D3D12] Failed to create swap chain" << std::endl;
+        return false;
+    }
+
+    // Disable Alt+Enter fullscreen toggle
+    dm.m_dxgiFactory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_ALT_ENTER);
+
+    if (FAILED(swapChain1.As(&m_swapChain)))
+    {
+        std::cerr << "[D3D12] Failed to get IDXGISwapChain4 interface" << std::endl;
+        return false;
+    }
+
+    return createRenderTargets();
+}
+
+void SwapChain_D3D12::destroy()
+{
+    destroyRenderTargets();
+    m_swapChain.Reset();
+}
+
+bool SwapChain_D3D12::resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0 || !m_swapChain)
+        return true;
+
+    m_width = width;
+    m_height = height;
+
+    // ResizeBuffers needs every reference to the old buffers gone: wait for the queued
+    // frames, then let NVRHI drop the command list instances that still hold them
+    m_deviceManager.waitForGPU();
+    m_deviceManager.runGarbageCollection();
+    destroyRenderTargets();
+
+    // A swap chain without buffers is unusable, so a failure here releases it; it is
+    // then never acquired or presented again
+    if (FAILED(m_swapChain->ResizeBuffers(
+        m_deviceManager.m_params.swapChainBufferCount,
+        width,
+        height,
+        DXGI_FORMAT_R8G8B8A8_UNORM,
+        m_swapChainFlags)))
+    {
+        std::cerr << "[D3D12] Failed to resize swap chain to " << width << "x" << height << std::endl;
+        destroy();
+        return false;
+    }
+
+    if (!createRenderTargets())
+    {
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+bool SwapChain_D3D12::createRenderTargets()
+{
+    DeviceManager_D3D12& dm = m_deviceManager;
+    const uint32_t bufferCount = dm.m_params.swapChainBufferCount;
+
+    m_buffers.resize(bufferCount);
+    m_textures.resize(bufferCount);
+    m_framebuffers.resize(bufferCount);
+
+    for (UINT i = 0; i < bufferCount; i++)
+    {
+        if (FAILED(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_buffers[i]))))
+        {
+            std::cerr << "[D3D12] Failed to get swap chain buffer " << i << std::endl;
+            return false;
+        }
+
+        nvrhi::TextureDesc textureDesc = {};
+        textureDesc.width = m_width;
+        textureDesc.height = m_height;
+        textureDesc.format = m_format;
+        textureDesc.dimension = nvrhi::TextureDimension::Texture2D;
+        textureDesc.isRenderTarget = true;
+        textureDesc.initialState = nvrhi::ResourceStates::Present;
+        textureDesc.keepInitialState = true;
+        textureDesc.debugName = "SwapChainBuffer" + std::to_string(i);
+
+        m_textures[i] = dm.m_nvrhiDevice->createHandleForNativeTexture(
+            nvrhi::ObjectTypes::D3D12_Resource,
+            static_cast<nvrhi::Object>(m_buffers[i].Get()),
+            textureDesc);
+
+        if (!m_textures[i])
+        {
+            std::cerr << "[D3D12] Failed to create texture handle for swap chain buffer " << i << std::endl;
+            return false;
+        }
+
+        nvrhi::FramebufferDesc fbDesc = {};
+        fbDesc.addColorAttachment(m_textures[i]);
+
+        m_framebuffers[i] = dm.m_device->createFramebuffer(fbDesc);
+        if (!m_framebuffers[i])
+        {
+            std::cerr << "[D3D12] Failed to create framebuffer " << i << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SwapChain_D3D12::destroyRenderTargets()
+{
+    m_framebuffers.clear();
+    m_textures.clear();
+    m_buffers.clear();
+}
+
+void SwapChain_D3D12::acquire()
+{
+    if (m_swapChain)
+    {
+        m_currentBackBuffer = m_swapChain->GetCurrentBackBufferIndex();
+    }
+}
+
+HRESULT SwapChain_D3D12::present(bool waitForVBlank)
+{
+    if (!m_swapChain)
+        return S_OK;
+
+    // Without waiting, a FIFO swap chain still never tears: flip model replaces the
+    // queued frame instead, like MAILBOX
+    UINT syncInterval = waitForVBlank ? m_syncInterval : 0;
+    return m_swapChain->Present(syncInterval, m_presentFlags);
+}
+
+} // namespace common
+
+#endif // _WIN32
@@ -0,0 +1,89 @@
+// SwapChain_D3D12.h
+// DXGI flip-model swap chain for one window
+
+#pragma once
+
+#ifdef _WIN32
+
+#include "DeviceManager.h"
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include <nvrhi/nvrhi.h>
+
+#include <vector>
+
+namespace common
+{
+    class DeviceManager_D3D12;
+
+    // Owns one window's DXGI swap chain and the NVRHI handles for its buffers. The
+    // device manager presents every swap chain it owns at the end of the frame; DXGI has
+    // no batched present, so they go out one Present() call each.
+    class SwapChain_D3D12 : public ISwapChain
+    {
+    public:
+        SwapChain_D3D12(DeviceManager_D3D12& deviceManager, GLFWwindow* window, uint32_t width, uint32_t height);
+        ~SwapChain_D3D12() override;
+
+        SwapChain_D3D12(const SwapChain_D3D12&) = delete;
+        SwapChain_D3D12& operator=(const SwapChain_D3D12&) = delete;
+
+        // ISwapChain implementation
+        GLFWwindow* getWindow() const override { return m_window; }
+        bool isAcquired() const override { return m_swapChain != nullptr; }
+        nvrhi::IFramebuffer* getCurrentFramebuffer() const override;
+        nvrhi::ITexture* getCurrentBackBuffer() const override;
+        uint32_t getCurrentBackBufferIndex() const override { return m_currentBackBuffer; }
+        uint32_t getBackBufferCount() const override { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t getWidth() const override { return m_width; }
+        uint32_t getHeight() const override { return m_height; }
+        nvrhi::Format getFormat() const override { return m_format; }
+        PresentMode getPresentMode() const override { return m_presentMode; }
+        bool resize(uint32_t width, uint32_t height) override;
+
+        // Create the swap chain on the device manager's current device and queue
+        bool create();
+
+        // Release the swap chain; the GPU must be done with its buffers
+        void destroy();
+
+        // Frame steps driven by the device manager. Only one swap chain should wait for
+        // vblank per frame, or each Present() blocks on its own flip queue in turn.
+        void acquire();
+        HRESULT present(bool waitForVBlank);
+
+    private:
+        bool createRenderTargets();
+        void destroyRenderTargets();
+
+    private:
+        DeviceManager_D3D12& m_deviceManager;
+        GLFWwindow* m_window = nullptr;
+        HWND m_hwnd = nullptr;
+        Microsoft::WRL::ComPtr<IDXGISwapChain4> m_swapChain;
+
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        nvrhi::Format m_format = nvrhi::Format::RGBA8_UNORM;
+
+        // Flip-model mapping of the present mode; ResizeBuffers must repeat the flags
+        PresentMode m_presentMode = PresentMode::Fifo;
+        UINT m_swapChainFlags = 0;
+        UINT m_syncInterval = 1;
+        UINT m_presentFlags = 0;
+
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_buffers;
+        std::vector<nvrhi::TextureHandle> m_textures;
+        std::vector<nvrhi::FramebufferHandle> m_framebuffers;
+        uint32_t m_currentBackBuffer = 0;
+    };
+
+} // namespace common
+
+#endif // _WIN32
@@ -0,0 +1,535 @@
+// SwapChain_VK.cpp
+// Vulkan window swap chain, or the offscreen ring in headless mode
+
+#include "SwapChain_VK.h"
+#include "DeviceManager_VK.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace common
+{
+
+static constexpr size_t MaxRetiredSwapChains = 4;
+
+SwapChain_VK::SwapChain_VK(DeviceManager_VK& deviceManager, GLFWwindow* window, VkSurfaceKHR surface,
+    uint32_t width, uint32_t height)
+    : m_deviceManager(deviceManager)
+    , m_window(window)
+    , m_surface(surface)
+    , m_ownsSurface(window && surface == VK_NULL_HANDLE)
+    , m_width(width)
+    , m_height(height)
+{
+}
+
+SwapChain_VK::~SwapChain_VK()
+{
+    destroy();
+}
+
+nvrhi::IFramebuffer* SwapChain_VK::getCurrentFramebuffer() const
+{
+    return m_framebuffers.empty() ? nullptr : m_framebuffers[m_currentBackBuffer].Get();
+}
+
+nvrhi::ITexture* SwapChain_VK::getCurrentBackBuffer() const
+{
+    return m_textures.empty() ? nullptr : m_textures[m_currentBackBuffer].Get();
+}
+
+bool SwapChain_VK::create()
+{
+    DeviceManager_VK& dm = m_deviceManager;
+    const DeviceCreationParams& params = dm.m_params;
+
+    // Headless mode renders into a ring of offscreen textures instead
+    if (!m_window)
+    {
+        m_format = params.swapChainFormat;
+        return createRenderTargets();
+    }
+
+    // Window swap chains get a surface on the current instance, which must be presentable
+    // from the queue the primary window was matched with
+    if (m_ownsSurface && m_surface == VK_NULL_HANDLE)
+    {
+        if (glfwCreateWindowSurface(dm.m_instance, m_window, nullptr, &m_surface) != VK_SUCCESS)
+        {
+            std::cerr << "[Vulkan] Failed to create window surface" << std::endl;
+            return false;
+        }
+
+        VkBool32 presentSupport = VK_FALSE;
+        dm.vkGetPhysicalDeviceSurfaceSupportKHR(dm.m_physicalDevice, dm.m_presentQueueFamily, m_surface, &presentSupport);
+        if (!presentSupport)
+        {
+            std::cerr << "[Vulkan] Window surface is not supported by the present queue" << std::endl;
+            return false;
+        }
+    }
+
+    // Get surface capabilities
+    VkSurfaceCapabilitiesKHR capabilities;
+    dm.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(dm.m_physicalDevice, m_surface, &capabilities);
+
+    // Get surface formats
+    uint32_t formatCount;
+    dm.vkGetPhysicalDeviceSurfaceFormatsKHR(dm.m_physicalDevice, m_surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    dm.vkGetPhysicalDeviceSurfaceFormatsKHR(dm.m_physicalDevice, m_surface, &formatCount, formats.data());
+
+    // Get present modes
+    uint32_t presentModeCount;
+    dm.vkGetPhysicalDeviceSurfacePresentModesKHR(dm.m_physicalDevice, m_surface, &presentModeCount, nullptr);
+    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+    dm.vkGetPhysicalDeviceSurfacePresentModesKHR(dm.m_physicalDevice, m_surface, &presentModeCount, presentModes.data());
+
+    // Choose swap surface format
+    VkSurfaceFormatKHR surfaceFormat = formats[0];
+    for (const auto& format : formats)
+    {
+        if (format.format == VK_FORMAT_B8G8R8A8_UNORM && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+        {
+            surfaceFormat = format;
+            break;
+        }
+    }
+    m_format = nvrhi::Format::BGRA8_UNORM;
+
+    // Choose present mode: the requested one, its nearest substitute, then FIFO. Only
+    // IMMEDIATE may substitute MAILBOX, since it already accepts tearing; MAILBOX falls
+    // back to FIFO rather than starting to tear.
+    std::vector<PresentMode> candidates = { params.presentMode };
+    if (params.presentMode == PresentMode::Immediate)
+        candidates.push_back(PresentMode::Mailbox);
+
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;  // Always available
+    m_presentMode = PresentMode::Fifo;
+    for (PresentMode candidate : candidates)
+    {
+        VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR;
+        switch (candidate)
+        {
+        case PresentMode::FifoRelaxed: mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR; break;
+        case PresentMode::Mailbox:     mode = VK_PRESENT_MODE_MAILBOX_KHR; break;
+        case PresentMode::Immediate:   mode = VK_PRESENT_MODE_IMMEDIATE_KHR; break;
+        default:                       break;
+        }
+
+        if (std::find(presentModes.begin(), presentModes.end(), mode) != presentModes.end())
+        {
+            presentMode = mode;
+            m_presentMode = candidate;
+            break;
+        }
+    }
+
+    // Resizes pick the same mode again, so only the first swap chain logs it
+    if (!m_presentModeLogged)
+    {
+        std::cout << "[Vulkan] Present mode " << presentModeToString(m_presentMode);
+        if (m_presentMode != params.presentMode)
+            std::cout << " (" << presentModeToString(params.presentMode) << " not supported)";
+        std::cout << std::endl;
+        m_presentModeLogged = true;
+    }
+
+    // Choose extent
+    VkExtent2D extent;
+    if (capabilities.currentExtent.width != UINT32_MAX)
+    {
+        extent = capabilities.currentExtent;
+    }
+    else
+    {
+        extent.width = std::clamp(m_width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+        extent.height = std::clamp(m_height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+    }
+    m_width = extent.width;
+    m_height = extent.height;
+
+    // Choose image count
+    uint32_t imageCount = params.swapChainBufferCount;
+    if (imageCount < capabilities.minImageCount)
+        imageCount = capabilities.minImageCount;
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+        imageCount = capabilities.maxImageCount;
+
+    VkSwapchainCreateInfoKHR createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = m_surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    // Frame capture copies out of the swap chain images
+    if (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+    {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    uint32_t queueFamilyIndices[] = { dm.m_graphicsQueueFamily, dm.m_presentQueueFamily };
+    if (dm.m_graphicsQueueFamily != dm.m_presentQueueFamily)
+    {
+        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        createInfo.queueFamilyIndexCount = 2;
+        createInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
+    else
+    {
+        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = presentMode;
+    createInfo.clipped = VK_TRUE;
+
+    // Hand the previous swap chain over so the driver can reuse its resources; it stays
+    // alive (retired) until the presentation engine is known to be done with it
+    createInfo.oldSwapchain = m_swapChain;
+
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+    VkResult result = dm.vkCreateSwapchainKHR(dm.m_vkDevice, &createInfo, nullptr, &swapChain);
+
+    if (m_swapChain != VK_NULL_HANDLE)
+    {
+        retire();
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        std::cerr << "[Vulkan] Failed to create swap chain" << std::endl;
+        return false;
+    }
+    m_swapChain = swapChain;
+    m_firstPresentId = m_presentId + 1;
+
+    // Get swap chain images
+    dm.vkGetSwapchainImagesKHR(dm.m_vkDevice, m_swapChain, &imageCount, nullptr);
+    m_images.resize(imageCount);
+    dm.vkGetSwapchainImagesKHR(dm.m_vkDevice, m_swapChain, &imageCount, m_images.data());
+    m_imagePresentCounts.assign(imageCount, 0);
+
+    // Create synchronization semaphores
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Create present semaphores (one per swap chain image)
+    m_presentSemaphores.resize(imageCount);
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        if (dm.vkCreateSemaphore(dm.m_vkDevice, &semaphoreInfo, nullptr, &m_presentSemaphores[i]) != VK_SUCCESS)
+        {
+            std::cerr << "[Vulkan] Failed to create present semaphore " << i << std::endl;
+            return false;
+        }
+    }
+
+    // Create acquire semaphores (need more than swap chain images for proper frame pipelining).
+    // A semaphore is only reused once the frame that waited on it has retired, so keep at
+    // least one more than the number of frames that may be in flight.
+    uint32_t acquireSemaphoreCount = std::max({ imageCount, params.swapChainBufferCount + 1, params.maxFramesInFlight + 1 });
+    m_acquireSemaphores.resize(acquireSemaphoreCount);
+    for (uint32_t i = 0; i < acquireSemaphoreCount; i++)
+    {
+        if (dm.vkCreateSemaphore(dm.m_vkDevice, &semaphoreInfo, nullptr, &m_acquireSemaphores[i]) != VK_SUCCESS)
+        {
+            std::cerr << "[Vulkan] Failed to create acquire semaphore " << i << std::endl;
+            return false;
+        }
+    }
+    m_acquireSemaphoreIndex = 0;
+
+    return createRenderTargets();
+}
+
+void SwapChain_VK::retire()
+{
+    RetiredSwapChain retired;
+    retired.lastFrameId = m_deviceManager.m_frameTracker.getCurrentFrameId();
+    retired.lastPresentCount = m_presentCount;
+    retired.swapChain = m_swapChain;
+    retired.textures = std::move(m_textures);
+    retired.framebuffers = std::move(m_framebuffers);
+    retired.semaphores = std::move(m_presentSemaphores);
+    retired.semaphores.insert(retired.semaphores.end(), m_acquireSemaphores.begin(), m_acquireSemaphores.end());
+    m_retiredSwapChains.push_back(std::move(retired));
+
+    m_swapChain = VK_NULL_HANDLE;
+    m_textures.clear();
+    m_framebuffers.clear();
+    m_presentSemaphores.clear();
+    m_acquireSemaphores.clear();
+    m_images.clear();
+    m_imagePresentCounts.clear();
+    m_acquired = false;
+}
+
+void SwapChain_VK::markPresented()
+{
+    m_imagePresentCounts[m_currentBackBuffer] = ++m_presentCount;
+    m_acquired = false;
+}
+
+void SwapChain_VK::releaseRetired(bool force)
+{
+    DeviceManager_VK& dm = m_deviceManager;
+
+    for (const PresentCompletion& completion : m_pendingPresentCompletions)
+    {
+        if (dm.m_frameTracker.isFrameRetired(completion.frameId))
+            m_completedPresentCount = std::max(m_completedPresentCount, completion.presentCount);
+    }
+    std::erase_if(m_pendingPresentCompletions, [this](const PresentCompletion& completion)
+        { return completion.presentCount <= m_completedPresentCount; });
+
+    if (m_retiredSwapChains.empty())
+        return;
+
+    // Resizing every frame never acquires an image twice from one swap chain, so no present
+    // completes; past a few retired swap chains, drain the device once and release them all
+    if (!force && m_retiredSwapChains.size() > MaxRetiredSwapChains)
+    {
+        dm.waitForIdle();
+        force = true;
+    }
+
+    // Drop NVRHI's references from completed command lists first, so the image views
+    // go away before the images they were created from
+    dm.runGarbageCollection();
+
+    for (RetiredSwapChain& retired : m_retiredSwapChains)
+    {
+        // GPU completion of the last frame is not enough: the presentation engine may
+        // still be waiting on a present semaphore or holding an image. A finished present
+        // issued after retirement shows it is done with everything presented before.
+        if (!force && (!dm.m_frameTracker.isFrameRetired(retired.lastFrameId) ||
+            m_completedPresentCount <= retired.lastPresentCount))
+            continue;
+
+        retired.framebuffers.clear();
+        retired.textures.clear();
+
+        for (VkSemaphore semaphore : retired.semaphores)
+        {
+            dm.vkDestroySemaphore(dm.m_vkDevice, semaphore, nullptr);
+        }
+        dm.vkDestroySwapchainKHR(dm.m_vkDevice, retired.swapChain, nullptr);
+        retired.swapChain = VK_NULL_HANDLE;
+    }
+
+    std::erase_if(m_retiredSwapChains, [](const RetiredSwapChain& retired) { return retired.swapChain == VK_NULL_HANDLE; });
+}
+
+void SwapChain_VK::destroy()
+{
+    DeviceManager_VK& dm = m_deviceManager;
+
+    // Callers wait for the device to go idle first, so every retired swap chain is done
+    releaseRetired(true);
+    m_pendingPresentCompletions.clear();
+
+    destroyRenderTargets();
+
+    for (auto semaphore : m_presentSemaphores)
+    {
+        if (semaphore != VK_NULL_HANDLE && dm.vkDestroySemaphore)
+        {
+            dm.vkDestroySemaphore(dm.m_vkDevice, semaphore, nullptr);
+        }
+    }
+    m_presentSemaphores.clear();
+
+    for (auto semaphore : m_acquireSemaphores)
+    {
+        if (semaphore != VK_NULL_HANDLE && dm.vkDestroySemaphore)
+        {
+            dm.vkDestroySemaphore(dm.m_vkDevice, semaphore, nullptr);
+        }
+    }
+    m_acquireSemaphores.clear();
+
+    if (m_swapChain != VK_NULL_HANDLE && dm.vkDestroySwapchainKHR)
+    {
+        dm.vkDestroySwapchainKHR(dm.m_vkDevice, m_swapChain, nullptr);
+        m_swapChain = VK_NULL_HANDLE;
+    }
+    m_images.clear();
+    m_acquired = false;
+
+    if (m_ownsSurface && m_surface != VK_NULL_HANDLE && dm.vkDestroySurfaceKHR)
+    {
+        dm.vkDestroySurfaceKHR(dm.m_instance, m_surface, nullptr);
+        m_surface = VK_NULL_HANDLE;
+    }
+}
+
+bool SwapChain_VK::resize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return true;
+
+    m_width = width;
+    m_height = height;
+
+    // Headless targets are ordinary textures, freed once the frames that rendered
+    // to them have retired
+    if (!m_window)
+    {
+        DeletionQueue& deletionQueue = m_deviceManager.m_deletionQueue;
+        for (const nvrhi::FramebufferHandle& framebuffer : m_framebuffers)
+        {
+            deletionQueue.release(framebuffer.Get());
+        }
+        for (const nvrhi::TextureHandle& texture : m_textures)
+        {
+            deletionQueue.release(texture.Get());
+        }
+        destroyRenderTargets();
+        return createRenderTargets();
+    }
+
+    // No device drain: the old swap chain is retired and released from beginFrame()
+    // once a later present has finished
+    return create();
+}
+
+bool SwapChain_VK::createRenderTargets()
+{
+    DeviceManager_VK& dm = m_deviceManager;
+    const DeviceCreationParams& params = dm.m_params;
+
+    // The offscreen ring needs one target per frame in flight so a target is only
+    // rendered to again once the frame that last used it has retired
+    uint32_t imageCount = !m_window
+        ? std::max(params.swapChainBufferCount, params.maxFramesInFlight)
+        : static_cast<uint32_t>(m_images.size());
+    m_textures.resize(imageCount);
+    m_framebuffers.resize(imageCount);
+
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        nvrhi::TextureDesc textureDesc = {};
+        textureDesc.width = m_width;
+        textureDesc.height = m_height;
+        textureDesc.format = m_format;
+        textureDesc.dimension = nvrhi::TextureDimension::Texture2D;
+        textureDesc.isRenderTarget = true;
+        textureDesc.keepInitialState = true;
+
+        if (!m_window)
+        {
+            textureDesc.initialState = nvrhi::ResourceStates::RenderTarget;
+            textureDesc.debugName = "OffscreenBuffer" + std::to_string(i);
+
+            m_textures[i] = dm.m_device->createTexture(textureDesc);
+        }
+        else
+        {
+            textureDesc.initialState = nvrhi::ResourceStates::Present;
+            textureDesc.debugName = "SwapChainBuffer" + std::to_string(i);
+
+            m_textures[i] = dm.m_nvrhiDevice->createHandleForNativeTexture(
+                nvrhi::ObjectTypes::VK_Image,
+                nvrhi::Object(m_images[i]),
+                textureDesc);
+        }
+
+        if (!m_textures[i])
+        {
+            std::cerr << "[Vulkan] Failed to create texture handle for swap chain buffer " << i << std::endl;
+            return false;
+        }
+
+        nvrhi::FramebufferDesc fbDesc = {};
+        fbDesc.addColorAttachment(m_textures[i]);
+
+        m_framebuffers[i] = dm.m_device->createFramebuffer(fbDesc);
+        if (!m_framebuffers[i])
+        {
+            std::cerr << "[Vulkan] Failed to create framebuffer " << i << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SwapChain_VK::destroyRenderTargets()
+{
+    m_framebuffers.clear();
+    m_textures.clear();
+}
+
+bool SwapChain_VK::acquire(uint64_t frameId)
+{
+    DeviceManager_VK& dm = m_deviceManager;
+    m_acquired = false;
+
+    // Headless mode cycles through the offscreen ring; nothing to acquire
+    if (!m_window)
+    {
+        m_currentBackBuffer = static_cast<uint32_t>((frameId - 1) % m_textures.size());
+        m_acquired = true;
+        return true;
+    }
+
+    // A swap chain invalidated by a resize is recreated and the acquire retried, so the
+    // frame always renders into an acquired image
+    VkSemaphore acquireSemaphore = VK_NULL_HANDLE;
+    VkResult result = VK_ERROR_OUT_OF_DATE_KHR;
+    for (int attempt = 0; attempt < 2 && result == VK_ERROR_OUT_OF_DATE_KHR; attempt++)
+    {
+        if (attempt > 0 || m_swapChain == VK_NULL_HANDLE)
+        {
+            int width, height;
+            glfwGetFramebufferSize(m_window, &width, &height);
+            if (width == 0 || height == 0 || !resize(width, height))
+                break;
+        }
+
+        acquireSemaphore = m_acquireSemaphores[m_acquireSemaphoreIndex];
+        result = dm.vkAcquireNextImageKHR(dm.m_vkDevice, m_swapChain, UINT64_MAX,
+            acquireSemaphore, VK_NULL_HANDLE, &m_currentBackBuffer);
+    }
+
+    dm.checkDeviceLost(result, "vkAcquireNextImageKHR");
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        return false;
+
+    // The image's previous present is finished once this frame's wait on the acquire
+    // semaphore has executed
+    uint64_t presentCount = m_imagePresentCounts[m_currentBackBuffer];
+    if (presentCount > m_completedPresentCount)
+    {
+        m_pendingPresentCompletions.push_back({ frameId, presentCount });
+    }
+
+    // Advance acquire semaphore index for next frame
+    m_acquireSemaphoreIndex = (m_acquireSemaphoreIndex + 1) % static_cast<uint32_t>(m_acquireSemaphores.size());
+
+    // Tell NVRHI to wait on the acquire semaphore before executing any commands
+    // The semaphore will be waited on when the first command list is submitted
+    dm.m_nvrhiDevice->queueWaitForSemaphore(nvrhi::CommandQueue::Graphics, acquireSemaphore, 0);
+    m_acquired = true;
+    return true;
+}
+
+void SwapChain_VK::waitForPreviousPresent(uint64_t timeoutNs)
+{
+    // A timeout or out-of-date swap chain is left to the next acquire to deal with
+    if (m_swapChain != VK_NULL_HANDLE && m_presentId > m_firstPresentId)
+    {
+        m_deviceManager.vkWaitForPresentKHR(m_deviceManager.m_vkDevice, m_swapChain, m_presentId - 1, timeoutNs);
+    }
+}
+
+} // namespace common
@@ -0,0 +1,132 @@
+// SwapChain_VK.h
+// Vulkan window swap chain, or the offscreen ring in headless mode
+
+#pragma once
+
+#include "DeviceManager.h"
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+#include <nvrhi/nvrhi.h>
+
+#include <vector>
+
+namespace common
+{
+    class DeviceManager_VK;
+
+    // Owns everything presentation needs for one window: the swap chain, its NVRHI texture
+    // and framebuffer handles, and its acquire and present semaphores. The device manager
+    // drives acquire and present for every swap chain it owns, so windows share one
+    // device, one graphics queue and one vkQueuePresentKHR per frame.
+    //
+    // Without a window it renders into a ring of offscreen textures instead (headless mode).
+    class SwapChain_VK : public ISwapChain
+    {
+    public:
+        // A surface passed in is borrowed (the primary window's, created before the device
+        // to select one that can present to it); otherwise the swap chain creates its own
+        SwapChain_VK(DeviceManager_VK& deviceManager, GLFWwindow* window, VkSurfaceKHR surface,
+            uint32_t width, uint32_t height);
+        ~SwapChain_VK() override;
+
+        SwapChain_VK(const SwapChain_VK&) = delete;
+        SwapChain_VK& operator=(const SwapChain_VK&) = delete;
+
+        // ISwapChain implementation
+        GLFWwindow* getWindow() const override { return m_window; }
+        bool isAcquired() const override { return m_acquired; }
+        nvrhi::IFramebuffer* getCurrentFramebuffer() const override;
+        nvrhi::ITexture* getCurrentBackBuffer() const override;
+        uint32_t getCurrentBackBufferIndex() const override { return m_currentBackBuffer; }
+        uint32_t getBackBufferCount() const override { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t getWidth() const override { return m_width; }
+        uint32_t getHeight() const override { return m_height; }
+        nvrhi::Format getFormat() const override { return m_format; }
+        PresentMode getPresentMode() const override { return m_presentMode; }
+        bool resize(uint32_t width, uint32_t height) override;
+
+        // (Re)create the swap chain; an existing one is retired, not destroyed
+        bool create();
+
+        // Release everything, including an owned surface; the device must be idle.
+        // create() can be called again afterwards, e.g. on a recreated device.
+        void destroy();
+
+        // Frame steps driven by the device manager
+        void releaseRetired(bool force);
+        bool acquire(uint64_t frameId);
+        VkSwapchainKHR getHandle() const { return m_swapChain; }
+        VkSemaphore getPresentSemaphore() const { return m_presentSemaphores[m_currentBackBuffer]; }
+        uint64_t nextPresentId() { return ++m_presentId; }
+        void markPresented();
+
+        // Block until the frame before the last one presented is on screen (present wait)
+        void waitForPreviousPresent(uint64_t timeoutNs);
+
+    private:
+        bool createRenderTargets();
+        void destroyRenderTargets();
+        void retire();
+
+    private:
+        DeviceManager_VK& m_deviceManager;
+        GLFWwindow* m_window = nullptr;
+        VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+        bool m_ownsSurface = false;
+        VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
+
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        nvrhi::Format m_format = nvrhi::Format::BGRA8_UNORM;
+        PresentMode m_presentMode = PresentMode::Fifo;
+        bool m_presentModeLogged = false;
+
+        std::vector<VkImage> m_images;
+        std::vector<nvrhi::TextureHandle> m_textures;
+        std::vector<nvrhi::FramebufferHandle> m_framebuffers;
+        uint32_t m_currentBackBuffer = 0;
+        bool m_acquired = false;
+
+        // One present semaphore per image; more acquire semaphores than frames in flight
+        std::vector<VkSemaphore> m_acquireSemaphores;
+        std::vector<VkSemaphore> m_presentSemaphores;
+        uint32_t m_acquireSemaphoreIndex = 0;
+
+        // Presents are numbered per window, across its swap chains. Acquiring an image again
+        // proves its previous present is finished, present semaphore wait included, once
+        // the frame that waited on the acquire has completed; presents finish in order, so
+        // every earlier one is finished as well.
+        struct PresentCompletion
+        {
+            uint64_t frameId = 0;
+            uint64_t presentCount = 0;
+        };
+        std::vector<uint64_t> m_imagePresentCounts;  // Last present of each image, 0 if none
+        std::vector<PresentCompletion> m_pendingPresentCompletions;
+        uint64_t m_presentCount = 0;
+        uint64_t m_completedPresentCount = 0;
+
+        // Swap chains replaced by a resize. The presentation engine may still wait on their
+        // present semaphores and hold their images after the GPU is done with the frame, so
+        // they are released only once a later present, to a newer swap chain, has finished,
+        // or after a device drain once too many have piled up.
+        struct RetiredSwapChain
+        {
+            uint64_t lastFrameId = 0;
+            uint64_t lastPresentCount = 0;
+            VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+            std::vector<nvrhi::TextureHandle> textures;
+            std::vector<nvrhi::FramebufferHandle> framebuffers;
+            std::vector<VkSemaphore> semaphores;
+        };
+        std::vector<RetiredSwapChain> m_retiredSwapChains;
+
+        // VK_KHR_present_id values increase across swap chains of this window; only IDs
+        // from the current one can be waited on
+        uint64_t m_presentId = 0;
+        uint64_t m_firstPresentId = 1;
+    };
+
+} // namespace common
@@ -0,0 +1,29 @@
+// TextureMemory.cpp
+// Texture sizes estimated from their descs, without a device
+
+#include "TextureMemory.h"
+
+#include <algorithm>
+
+namespace common
+{
+
+uint64_t estimateTextureBytes(const nvrhi::TextureDesc& desc)
+{
+    const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(desc.format);
+    const uint32_t blockSize = std::max<uint32_t>(formatInfo.blockSize, 1);
+
+    uint64_t bytes = 0;
+    for (uint32_t mip = 0; mip < desc.mipLevels; mip++)
+    {
+        uint64_t width = std::max(desc.width >> mip, 1u);
+        uint64_t height = std::max(desc.height >> mip, 1u);
+        uint64_t depth = std::max(desc.depth >> mip, 1u);
+        uint64_t blocksWide = (width + blockSize - 1) / blockSize;
+        uint64_t blocksHigh = (height + blockSize - 1) / blockSize;
+        bytes += blocksWide * blocksHigh * depth * formatInfo.bytesPerBlock;
+    }
+    return bytes * desc.arraySize * std::max(desc.sampleCount, 1u);
+}
+
+} // namespace common
@@ -0,0 +1,16 @@
+// TextureMemory.h
+// Texture sizes estimated from their descs, without a device
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+
+namespace common
+{
+    // Bytes of texel data over every mip, array layer and sample, from the format's
+    // block size; excludes the padding and alignment a driver adds
+    uint64_t estimateTextureBytes(const nvrhi::TextureDesc& desc);
+
+} // namespace common
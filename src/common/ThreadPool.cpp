@@ -0,0 +1,90 @@
+// ThreadPool.cpp
+// Fixed-size worker pool for CPU work that must stay off the render thread
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace common
+{
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = std::max(hardwareThreads, 2u) - 1;
+    }
+
+    m_threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        m_threads.emplace_back(&ThreadPool::workerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+
+    // Workers drain the queue before exiting
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_tasks.empty() && m_activeTasks == 0; });
+}
+
+size_t ThreadPool::getPendingTaskCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.size() + m_activeTasks;
+}
+
+void ThreadPool::workerMain()
+{
+    for (;;)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_activeTasks++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeTasks--;
+            if (m_tasks.empty() && m_activeTasks == 0)
+                m_idle.notify_all();
+        }
+    }
+}
+
+} // namespace common
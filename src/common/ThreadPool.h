@@ -0,0 +1,50 @@
+// ThreadPool.h
+// Fixed-size worker pool for CPU work that must stay off the render thread
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common
+{
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        // threadCount == 0 uses one thread per hardware thread minus the render thread
+        explicit ThreadPool(uint32_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(Task task);
+
+        // Block until every submitted task has finished
+        void waitIdle();
+
+        uint32_t getThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+        size_t getPendingTaskCount() const;
+
+    private:
+        void workerMain();
+
+    private:
+        std::vector<std::thread> m_threads;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_taskAvailable;
+        std::condition_variable m_idle;
+        std::deque<Task> m_tasks;
+        uint32_t m_activeTasks = 0;
+        bool m_stopping = false;
+    };
+
+} // namespace common
@@ -0,0 +1,369 @@
+// TlsfAllocator.cpp
+// Two-level segregated fit allocator for offsets within a memory block
+
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace common
+{
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity, uint64_t granularity)
+    : m_granularity(std::max<uint64_t>(std::bit_ceil(granularity), SecondLevelCount))
+{
+    for (auto& lists : m_freeLists)
+    {
+        std::fill(std::begin(lists), std::end(lists), NullRange);
+    }
+
+    m_capacity = capacity & ~(m_granularity - 1);
+    if (m_capacity > 0)
+    {
+        insertFree(createRange(0, m_capacity));
+    }
+}
+
+void TlsfAllocator::mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    // Sizes are at least the granularity, so the first level always has SecondLevelBits
+    // bits below its leading one to pick the second level with
+    firstLevel = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    secondLevel = static_cast<uint32_t>(size >> (firstLevel - SecondLevelBits)) & (SecondLevelCount - 1);
+}
+
+uint32_t TlsfAllocator::createRange(uint64_t offset, uint64_t size)
+{
+    uint32_t index;
+    if (m_unusedRanges != NullRange)
+    {
+        index = m_unusedRanges;
+        m_unusedRanges = m_ranges[index].nextFree;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_ranges.size());
+        m_ranges.emplace_back();
+    }
+
+    Range& range = m_ranges[index];
+    range = Range();
+    range.offset = offset;
+    range.size = size;
+    range.used = true;
+    return index;
+}
+
+void TlsfAllocator::destroyRange(uint32_t index)
+{
+    Range& range = m_ranges[index];
+    range.used = false;
+    range.nextFree = m_unusedRanges;
+    m_unusedRanges = index;
+}
+
+void TlsfAllocator::insertFree(uint32_t index)
+{
+    Range& range = m_ranges[index];
+    uint32_t firstLevel, secondLevel;
+    mapping(range.size, firstLevel, secondLevel);
+
+    uint32_t& head = m_freeLists[firstLevel][secondLevel];
+    range.free = true;
+    range.prevFree = NullRange;
+    range.nextFree = head;
+    if (head != NullRange)
+    {
+        m_ranges[head].prevFree = index;
+    }
+    head = index;
+
+    m_firstLevelBitmap |= 1ull << firstLevel;
+    m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::removeFree(uint32_t index)
+{
+    Range& range = m_ranges[index];
+    uint32_t firstLevel, secondLevel;
+    mapping(range.size, firstLevel, secondLevel);
+
+    if (range.prevFree != NullRange)
+        m_ranges[range.prevFree].nextFree = range.nextFree;
+    if (range.nextFree != NullRange)
+        m_ranges[range.nextFree].prevFree = range.prevFree;
+
+    uint32_t& head = m_freeLists[firstLevel][secondLevel];
+    if (head == index)
+    {
+        head = range.nextFree;
+        if (head == NullRange)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+                m_firstLevelBitmap &= ~(1ull << firstLevel);
+        }
+    }
+
+    range.free = false;
+    range.prevFree = NullRange;
+    range.nextFree = NullRange;
+}
+
+uint32_t TlsfAllocator::findFree(uint64_t size) const
+{
+    // Round up to the next class boundary, so any range in the class found is large enough
+    uint32_t firstLevel = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    size += (1ull << (firstLevel - SecondLevelBits)) - 1;
+
+    uint32_t secondLevel;
+    mapping(size, firstLevel, secondLevel);
+    if (firstLevel >= FirstLevelCount)
+        return NullRange;
+
+    uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0)
+    {
+        // Nothing in this first level; take the smallest class of any larger one
+        uint64_t firstLevelMap = firstLevel + 1 < FirstLevelCount
+            ? m_firstLevelBitmap & (~0ull << (firstLevel + 1))
+            : 0;
+        if (firstLevelMap == 0)
+            return NullRange;
+
+        firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+        secondLevelMap = m_secondLevelBitmaps[firstLevel];
+    }
+
+    secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+    return m_freeLists[firstLevel][secondLevel];
+}
+
+uint32_t TlsfAllocator::splitFront(uint32_t index, uint64_t size)
+{
+    // createRange may grow the vector, so no references are held across it
+    uint32_t front = createRange(m_ranges[index].offset, size);
+
+    Range& back = m_ranges[index];
+    Range& range = m_ranges[front];
+    range.prevPhysical = back.prevPhysical;
+    range.nextPhysical = index;
+    if (range.prevPhysical != NullRange)
+    {
+        m_ranges[range.prevPhysical].nextPhysical = front;
+    }
+
+    back.prevPhysical = front;
+    back.offset += size;
+    back.size -= size;
+    return front;
+}
+
+TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || size > m_capacity)
+        return {};
+
+    size = alignUp(size, m_granularity);
+    alignment = std::max(alignment, m_granularity);
+
+    // The head of the smallest fitting class is usually aligned well enough; otherwise
+    // search again with room for the worst-case padding
+    uint32_t index = findFree(size);
+    if (index != NullRange)
+    {
+        const Range& range = m_ranges[index];
+        if (alignUp(range.offset, alignment) - range.offset + size > range.size)
+            index = NullRange;
+    }
+    if (index == NullRange && alignment > m_granularity && size + alignment - m_granularity <= m_capacity)
+    {
+        index = findFree(size + alignment - m_granularity);
+    }
+    if (index == NullRange)
+        return {};
+
+    removeFree(index);
+
+    // Padding in front stays free; its physical predecessor is in use, or the two
+    // would have been merged
+    uint64_t padding = alignUp(m_ranges[index].offset, alignment) - m_ranges[index].offset;
+    if (padding > 0)
+    {
+        insertFree(splitFront(index, padding));
+    }
+
+    if (m_ranges[index].size > size)
+    {
+        uint32_t allocated = splitFront(index, size);
+        insertFree(index);
+        index = allocated;
+    }
+
+    m_usedBytes += size;
+    m_allocationCount++;
+
+    Allocation allocation;
+    allocation.handle = index;
+    allocation.offset = m_ranges[index].offset;
+    allocation.size = size;
+    return allocation;
+}
+
+void TlsfAllocator::free(uint32_t handle)
+{
+    if (handle >= m_ranges.size() || !m_ranges[handle].used || m_ranges[handle].free)
+    {
+        assert(!"TlsfAllocator::free called with an invalid handle");
+        return;
+    }
+
+    m_usedBytes -= m_ranges[handle].size;
+    m_allocationCount--;
+
+    uint32_t index = handle;
+    uint32_t next = m_ranges[index].nextPhysical;
+    if (next != NullRange && m_ranges[next].free)
+    {
+        removeFree(next);
+        m_ranges[index].size += m_ranges[next].size;
+        m_ranges[index].nextPhysical = m_ranges[next].nextPhysical;
+        if (m_ranges[index].nextPhysical != NullRange)
+            m_ranges[m_ranges[index].nextPhysical].prevPhysical = index;
+        destroyRange(next);
+    }
+
+    uint32_t prev = m_ranges[index].prevPhysical;
+    if (prev != NullRange && m_ranges[prev].free)
+    {
+        removeFree(prev);
+        m_ranges[prev].size += m_ranges[index].size;
+        m_ranges[prev].nextPhysical = m_ranges[index].nextPhysical;
+        if (m_ranges[prev].nextPhysical != NullRange)
+            m_ranges[m_ranges[prev].nextPhysical].prevPhysical = prev;
+        destroyRange(index);
+        index = prev;
+    }
+
+    insertFree(index);
+}
+
+TlsfAllocator::Stats TlsfAllocator::getStats() const
+{
+    Stats stats;
+    stats.capacity = m_capacity;
+    stats.usedBytes = m_usedBytes;
+    stats.allocationCount = m_allocationCount;
+
+    for (const Range& range : m_ranges)
+    {
+        if (range.used && range.free)
+        {
+            stats.freeRangeCount++;
+            stats.largestFreeRange = std::max(stats.largestFreeRange, range.size);
+        }
+    }
+    return stats;
+}
+
+double TlsfAllocator::getFragmentation() const
+{
+    uint64_t freeBytes = m_capacity - m_usedBytes;
+    if (freeBytes == 0)
+        return 0.0;
+    return 1.0 - double(getStats().largestFreeRange) / double(freeBytes);
+}
+
+bool TlsfAllocator::validate() const
+{
+    // Exactly one range starts the block
+    uint32_t first = NullRange;
+    uint32_t liveRanges = 0;
+    for (uint32_t i = 0; i < m_ranges.size(); i++)
+    {
+        if (!m_ranges[i].used)
+            continue;
+        liveRanges++;
+        if (m_ranges[i].prevPhysical == NullRange)
+        {
+            if (first != NullRange)
+                return false;
+            first = i;
+        }
+    }
+    if (m_capacity == 0)
+        return first == NullRange;
+    if (first == NullRange)
+        return false;
+
+    // Physical order: contiguous, granular, covering the block, no adjacent free ranges
+    uint64_t offset = 0;
+    uint64_t usedBytes = 0;
+    uint32_t allocationCount = 0;
+    uint32_t walked = 0;
+    uint32_t freeRanges = 0;
+    for (uint32_t index = first; index != NullRange; index = m_ranges[index].nextPhysical)
+    {
+        const Range& range = m_ranges[index];
+        if (!range.used || range.offset != offset || range.size == 0 || (range.size & (m_granularity - 1)) != 0)
+            return false;
+        if (range.nextPhysical != NullRange && m_ranges[range.nextPhysical].prevPhysical != index)
+            return false;
+        if (range.free && range.nextPhysical != NullRange && m_ranges[range.nextPhysical].free)
+            return false;
+
+        if (range.free)
+        {
+            freeRanges++;
+        }
+        else
+        {
+            usedBytes += range.size;
+            allocationCount++;
+        }
+        offset += range.size;
+        if (++walked > liveRanges)
+            return false;
+    }
+    if (offset != m_capacity || walked != liveRanges || usedBytes != m_usedBytes || allocationCount != m_allocationCount)
+        return false;
+
+    // Every free range is in the list of its class, and the bitmaps match the lists
+    uint32_t listed = 0;
+    for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; firstLevel++)
+    {
+        for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; secondLevel++)
+        {
+            uint32_t head = m_freeLists[firstLevel][secondLevel];
+            bool bitSet = (m_secondLevelBitmaps[firstLevel] >> secondLevel) & 1;
+            if (bitSet != (head != NullRange))
+                return false;
+
+            uint32_t prev = NullRange;
+            for (uint32_t index = head; index != NullRange; index = m_ranges[index].nextFree)
+            {
+                const Range& range = m_ranges[index];
+                uint32_t rangeFirstLevel, rangeSecondLevel;
+                mapping(range.size, rangeFirstLevel, rangeSecondLevel);
+                if (!range.used || !range.free || range.prevFree != prev ||
+                    rangeFirstLevel != firstLevel || rangeSecondLevel != secondLevel)
+                    return false;
+                prev = index;
+                if (++listed > freeRanges)
+                    return false;
+            }
+        }
+        bool firstLevelSet = (m_firstLevelBitmap >> firstLevel) & 1;
+        if (firstLevelSet != (m_secondLevelBitmaps[firstLevel] != 0))
+            return false;
+    }
+    return listed == freeRanges;
+}
+
+} // namespace common
@@ -0,0 +1,103 @@
+// TlsfAllocator.h
+// Two-level segregated fit allocator for offsets within a memory block
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace common
+{
+    // Hands out aligned ranges of a fixed-size block in O(1): free ranges are kept in
+    // lists segregated by size class (a power-of-two first level split into 32 linear
+    // second-level classes), with bitmaps to find the smallest non-empty class that fits.
+    // Freed ranges merge with free neighbours immediately, so there are never two
+    // adjacent free ranges.
+    //
+    // Only metadata is managed, no memory is touched, so the same code places GPU
+    // resources in heaps and runs in CPU-only tests and benchmarks. Not thread-safe.
+    class TlsfAllocator
+    {
+    public:
+        static constexpr uint32_t InvalidHandle = UINT32_MAX;
+
+        struct Allocation
+        {
+            uint32_t handle = InvalidHandle;
+            uint64_t offset = 0;
+            uint64_t size = 0;  // Rounded up to the granularity
+
+            explicit operator bool() const { return handle != InvalidHandle; }
+        };
+
+        struct Stats
+        {
+            uint64_t capacity = 0;
+            uint64_t usedBytes = 0;
+            uint64_t allocationCount = 0;
+            uint64_t freeRangeCount = 0;
+            uint64_t largestFreeRange = 0;
+        };
+
+        // Every offset and size is a multiple of granularity, a power of two of at least 32
+        explicit TlsfAllocator(uint64_t capacity, uint64_t granularity = 256);
+
+        // Alignment must be a power of two; fails (returns an invalid allocation) if no
+        // free range can hold the aligned size
+        Allocation allocate(uint64_t size, uint64_t alignment = 1);
+        void free(uint32_t handle);
+
+        uint64_t getCapacity() const { return m_capacity; }
+        uint64_t getUsedBytes() const { return m_usedBytes; }
+        uint32_t getAllocationCount() const { return m_allocationCount; }
+        bool isEmpty() const { return m_allocationCount == 0; }
+        Stats getStats() const;
+
+        // 0 when all free space is one range, approaching 1 as it splits into small pieces
+        double getFragmentation() const;
+
+        // Walk the block and check every invariant; for tests, O(n)
+        bool validate() const;
+
+    private:
+        static constexpr uint32_t SecondLevelBits = 5;
+        static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+        static constexpr uint32_t FirstLevelCount = 64;
+        static constexpr uint32_t NullRange = UINT32_MAX;
+
+        struct Range
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t prevPhysical = NullRange;
+            uint32_t nextPhysical = NullRange;
+            uint32_t prevFree = NullRange;  // Free list links, or the next unused slot
+            uint32_t nextFree = NullRange;
+            bool free = false;
+            bool used = false;  // Slot holds a live range
+        };
+
+        uint32_t createRange(uint64_t offset, uint64_t size);
+        void destroyRange(uint32_t index);
+        void insertFree(uint32_t index);
+        void removeFree(uint32_t index);
+        uint32_t findFree(uint64_t size) const;
+        uint32_t splitFront(uint32_t index, uint64_t size);
+
+        static void mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+    private:
+        uint64_t m_capacity = 0;
+        uint64_t m_granularity = 0;
+        uint64_t m_usedBytes = 0;
+        uint32_t m_allocationCount = 0;
+
+        std::vector<Range> m_ranges;
+        uint32_t m_unusedRanges = NullRange;  // Slots to recycle, linked through nextFree
+
+        uint64_t m_firstLevelBitmap = 0;
+        uint32_t m_secondLevelBitmaps[FirstLevelCount] = {};
+        uint32_t m_freeLists[FirstLevelCount][SecondLevelCount];
+    };
+
+} // namespace common
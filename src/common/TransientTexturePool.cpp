@@ -0,0 +1,241 @@
+// TransientTexturePool.cpp
+// Placed textures for the transients of a compiled render graph
+
+#include "TransientTexturePool.h"
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+
+#include <iostream>
+#include <type_traits>
+
+namespace common
+{
+
+static const char* const heapKindNames[] = { "RenderTargets", "Textures" };
+
+template<typename T>
+static void appendField(std::string& key, const T& value)
+{
+    static_assert(std::is_scalar_v<T>, "pack fields one at a time");
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// The fields that decide a texture's memory and views; debug names do not count
+static std::string makeTextureKey(const nvrhi::TextureDesc& desc)
+{
+    std::string key;
+    appendField(key, desc.width);
+    appendField(key, desc.height);
+    appendField(key, desc.depth);
+    appendField(key, desc.arraySize);
+    appendField(key, desc.mipLevels);
+    appendField(key, desc.sampleCount);
+    appendField(key, desc.format);
+    appendField(key, desc.dimension);
+    appendField(key, desc.isRenderTarget);
+    appendField(key, desc.isUAV);
+    appendField(key, desc.isTypeless);
+    appendField(key, desc.initialState);
+    appendField(key, desc.keepInitialState);
+    appendField(key, desc.useClearValue);
+    appendField(key, desc.clearValue.r);
+    appendField(key, desc.clearValue.g);
+    appendField(key, desc.clearValue.b);
+    appendField(key, desc.clearValue.a);
+    return key;
+}
+
+TransientTexturePool::TransientTexturePool(IDeviceManager& deviceManager)
+    : m_deviceManager(deviceManager)
+    , m_device(deviceManager.getDevice())
+{
+}
+
+TransientTexturePool::~TransientTexturePool()
+{
+    // Owners wait for the device first
+    clear();
+}
+
+nvrhi::MemoryRequirements TransientTexturePool::getRequirements(const nvrhi::TextureDesc& desc)
+{
+    std::string key = makeTextureKey(desc);
+    auto it = m_requirements.find(key);
+    if (it != m_requirements.end())
+        return it->second;
+
+    // A virtual texture has no memory, so it can be dropped right away
+    nvrhi::TextureDesc virtualDesc = desc;
+    virtualDesc.isVirtual = true;
+    nvrhi::TextureHandle texture = m_device->createTexture(virtualDesc);
+    if (!texture)
+    {
+        std::cerr << "[TransientTexturePool] Failed to create texture " << desc.debugName << std::endl;
+        return {};
+    }
+
+    nvrhi::MemoryRequirements requirements = m_device->getTextureMemoryRequirements(texture);
+    m_requirements[key] = requirements;
+    return requirements;
+}
+
+RenderGraph::RequirementsCallback TransientTexturePool::getRequirementsCallback()
+{
+    return [this](const nvrhi::TextureDesc& desc) { return getRequirements(desc); };
+}
+
+void TransientTexturePool::releaseHeap(RenderGraph::HeapKind kind)
+{
+    DeletionQueue& deletionQueue = m_deviceManager.getDeletionQueue();
+    for (auto it = m_textures.begin(); it != m_textures.end();)
+    {
+        if (it->second.kind == kind)
+        {
+            deletionQueue.release(it->second.texture);
+            it = m_textures.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    int index = static_cast<int>(kind);
+    if (m_heaps[index])
+    {
+        deletionQueue.release(m_heaps[index], m_heapCapacities[index]);
+        m_stats.heapBytes -= m_heapCapacities[index];
+    }
+    m_heaps[index] = nullptr;
+    m_heapCapacities[index] = 0;
+}
+
+bool TransientTexturePool::reserveHeap(RenderGraph::HeapKind kind, uint64_t size)
+{
+    int index = static_cast<int>(kind);
+    if (size <= m_heapCapacities[index])
+        return true;
+
+    // Everything placed in the old heap goes with it
+    releaseHeap(kind);
+
+    nvrhi::HeapDesc heapDesc;
+    heapDesc.capacity = size;
+    heapDesc.type = nvrhi::HeapType::DeviceLocal;
+    heapDesc.debugName = std::string("TransientTexturePool.") + heapKindNames[index];
+
+    nvrhi::HeapHandle heap = m_device->createHeap(heapDesc);
+    if (!heap)
+    {
+        std::cerr << "[TransientTexturePool] Failed to create a " << size << " byte heap ("
+                  << heapDesc.debugName << ")" << std::endl;
+        return false;
+    }
+
+    m_heaps[index] = heap;
+    m_heapCapacities[index] = size;
+    m_stats.heapBytes += size;
+    m_stats.heapResizes++;
+    return true;
+}
+
+nvrhi::ResourceStates TransientTexturePool::getTransientState() const
+{
+    return m_deviceManager.getGraphicsAPI() == GraphicsAPI::D3D12
+        ? nvrhi::ResourceStates::Common
+        : nvrhi::ResourceStates::CopyDest;
+}
+
+bool TransientTexturePool::realize(RenderGraph& graph)
+{
+    // The aliasing barriers were computed for the graph's state
+    nvrhi::ResourceStates transientState = getTransientState();
+    if (graph.getTransientState() != transientState)
+    {
+        std::cerr << "[TransientTexturePool] Render graph was compiled for another transient state" << std::endl;
+        return false;
+    }
+
+    for (int index = 0; index < static_cast<int>(RenderGraph::HeapKind::Count); index++)
+    {
+        RenderGraph::HeapKind kind = static_cast<RenderGraph::HeapKind>(index);
+        if (!reserveHeap(kind, graph.getHeapSize(kind)))
+            return false;
+    }
+
+    // Textures this frame uses move over; what is left over afterwards is unused
+    std::unordered_map<std::string, PlacedTexture> textures;
+    for (RenderGraph::ResourceId id = 0; id < graph.getResourceCount(); id++)
+    {
+        if (!graph.isTransient(id) || !graph.isResourceUsed(id))
+            continue;
+
+        const nvrhi::TextureDesc& desc = graph.getTextureDesc(id);
+        RenderGraph::HeapKind kind = graph.getHeapKind(id);
+        uint64_t offset = graph.getTransientOffset(id);
+        std::string key = makeTextureKey(desc);
+        appendField(key, offset);
+
+        // Transients that do not overlap in time can share one texture too
+        auto it = textures.find(key);
+        if (it == textures.end())
+        {
+            auto previous = m_textures.find(key);
+            if (previous != m_textures.end())
+            {
+                it = textures.emplace(key, std::move(previous->second)).first;
+                m_textures.erase(previous);
+            }
+        }
+
+        if (it == textures.end())
+        {
+            // Command lists start tracking it in the transient state and return it there,
+            // whichever transient used the memory last
+            nvrhi::TextureDesc placedDesc = desc;
+            placedDesc.isVirtual = true;
+            placedDesc.initialState = transientState;
+            placedDesc.keepInitialState = true;
+            nvrhi::TextureHandle texture = m_device->createTexture(placedDesc);
+            if (!texture || !m_device->bindTextureMemory(texture, m_heaps[static_cast<int>(kind)], offset))
+            {
+                std::cerr << "[TransientTexturePool] Failed to place texture " << desc.debugName
+                          << " at offset " << offset << std::endl;
+                m_textures.merge(textures);
+                return false;
+            }
+
+            PlacedTexture placed;
+            placed.texture = texture;
+            placed.kind = kind;
+            it = textures.emplace(key, std::move(placed)).first;
+            m_stats.createdTextures++;
+        }
+
+        graph.setTexture(id, it->second.texture);
+    }
+
+    DeletionQueue& deletionQueue = m_deviceManager.getDeletionQueue();
+    for (auto& [key, placed] : m_textures)
+    {
+        deletionQueue.release(placed.texture);
+    }
+    m_textures = std::move(textures);
+    m_stats.textureCount = static_cast<uint32_t>(m_textures.size());
+    return true;
+}
+
+void TransientTexturePool::clear()
+{
+    m_textures.clear();
+    for (int index = 0; index < static_cast<int>(RenderGraph::HeapKind::Count); index++)
+    {
+        m_heaps[index] = nullptr;
+        m_heapCapacities[index] = 0;
+    }
+    m_requirements.clear();
+    m_stats.heapBytes = 0;
+    m_stats.textureCount = 0;
+}
+
+} // namespace common
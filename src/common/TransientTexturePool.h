@@ -0,0 +1,83 @@
+// TransientTexturePool.h
+// Placed textures for the transients of a compiled render graph
+
+#pragma once
+
+#include "RenderGraph.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // Owns one heap per RenderGraph::HeapKind and the textures placed in them at the
+    // offsets compile() chose. A texture is kept between frames and reused when a
+    // transient with the same desc lands at the same offset, so a graph that does not
+    // change creates nothing after its first frame. Heaps grow to the largest graph seen;
+    // replaced heaps, and textures no transient used in a frame, go to the deletion queue.
+    //
+    // Placed textures start and end every command list in getTransientState(), which the
+    // graph must be given before compile(). Memory requirements come from a virtual
+    // texture created once per distinct desc. Not thread-safe.
+    class TransientTexturePool
+    {
+    public:
+        struct Stats
+        {
+            uint64_t heapBytes = 0;
+            uint32_t textureCount = 0;
+            uint64_t createdTextures = 0;   // Since creation
+            uint64_t heapResizes = 0;
+        };
+
+        explicit TransientTexturePool(IDeviceManager& deviceManager);
+        ~TransientTexturePool();
+
+        TransientTexturePool(const TransientTexturePool&) = delete;
+        TransientTexturePool& operator=(const TransientTexturePool&) = delete;
+
+        // For RenderGraph::compile(); zero if the texture cannot be created
+        nvrhi::MemoryRequirements getRequirements(const nvrhi::TextureDesc& desc);
+        RenderGraph::RequirementsCallback getRequirementsCallback();
+
+        // Common on D3D12. NVRHI maps Common to an undefined image layout on Vulkan, so
+        // transients rest in the copy layout there, which every texture supports.
+        nvrhi::ResourceStates getTransientState() const;
+
+        // Give every transient the compiled graph uses a texture; returns false if a heap
+        // or texture could not be created, or the graph was compiled for another state
+        bool realize(RenderGraph& graph);
+
+        // Drop every heap and texture immediately; only valid once the device is idle
+        void clear();
+
+        Stats getStats() const { return m_stats; }
+
+    private:
+        struct PlacedTexture
+        {
+            nvrhi::TextureHandle texture;
+            RenderGraph::HeapKind kind = RenderGraph::HeapKind::Texture;
+        };
+
+        bool reserveHeap(RenderGraph::HeapKind kind, uint64_t size);
+        void releaseHeap(RenderGraph::HeapKind kind);
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::DeviceHandle m_device;
+
+        nvrhi::HeapHandle m_heaps[static_cast<int>(RenderGraph::HeapKind::Count)];
+        uint64_t m_heapCapacities[static_cast<int>(RenderGraph::HeapKind::Count)] = {};
+
+        std::unordered_map<std::string, nvrhi::MemoryRequirements> m_requirements;  // By desc key
+        std::unordered_map<std::string, PlacedTexture> m_textures;                  // By desc key and offset
+        Stats m_stats;
+    };
+
+} // namespace common
@@ -0,0 +1,144 @@
+// UploadRing.cpp
+// Persistently mapped ring buffer for transient per-frame uploads
+
+#include "UploadRing.h"
+#include "DeviceManager.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace common
+{
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UploadRing::UploadRing(IDeviceManager& deviceManager, uint64_t capacity)
+    : m_deviceManager(deviceManager)
+    , m_capacity(alignUp(capacity, 64 * 1024))
+{
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = m_capacity;
+    bufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
+    bufferDesc.isVertexBuffer = true;
+    bufferDesc.isIndexBuffer = true;
+    bufferDesc.isConstantBuffer = true;
+    bufferDesc.canHaveRawViews = true;  // Readable through a bindless table
+    // CPU-visible buffers never change state; NVRHI skips their barriers
+    bufferDesc.initialState = nvrhi::ResourceStates::CopySource;
+    bufferDesc.keepInitialState = true;
+    bufferDesc.debugName = "UploadRing";
+
+    m_buffer = m_deviceManager.getDevice()->createBuffer(bufferDesc);
+    if (m_buffer)
+    {
+        // Mapped for the ring's whole lifetime
+        m_mappedData = static_cast<uint8_t*>(
+            m_deviceManager.getDevice()->mapBuffer(m_buffer, nvrhi::CpuAccessMode::Write));
+    }
+
+    if (!m_mappedData)
+    {
+        std::cerr << "[UploadRing] Failed to create a " << m_capacity << " byte upload buffer" << std::endl;
+        m_buffer = nullptr;
+    }
+}
+
+UploadRing::~UploadRing()
+{
+    if (m_mappedData)
+    {
+        m_deviceManager.getDevice()->unmapBuffer(m_buffer);
+    }
+}
+
+bool UploadRing::reclaimLocked(bool wait)
+{
+    FrameTracker& frameTracker = m_deviceManager.getFrameTracker();
+
+    if (wait && !m_frameRegions.empty() && !frameTracker.waitForFrame(m_frameRegions.front().first))
+        return false;
+
+    while (!m_frameRegions.empty() && frameTracker.isFrameRetired(m_frameRegions.front().first))
+    {
+        m_tail = m_frameRegions.front().second;
+        m_frameRegions.pop_front();
+    }
+    return true;
+}
+
+UploadRing::Allocation UploadRing::allocate(uint64_t size, uint64_t alignment)
+{
+    if (!m_mappedData || size == 0 || size > m_capacity || alignment == 0 || m_capacity % alignment != 0)
+    {
+        std::cerr << "[UploadRing] Cannot allocate " << size << " bytes (alignment " << alignment << ")" << std::endl;
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Close the previous frame's region on the first allocation of a new frame. Between
+    // frames the data is read by the frame about to start, not the one that just ended.
+    uint64_t frameId = m_deviceManager.getFrameTracker().getReleaseFrameId();
+    if (frameId != m_currentFrameId)
+    {
+        if (m_currentFrameId != 0 && (m_frameRegions.empty() || m_frameRegions.back().second != m_head))
+            m_frameRegions.emplace_back(m_currentFrameId, m_head);
+        m_currentFrameId = frameId;
+    }
+
+    reclaimLocked(false);
+
+    while (true)
+    {
+        // Allocations never straddle the end of the buffer; skip to the start instead
+        uint64_t begin = alignUp(m_head, alignment);
+        if (begin % m_capacity + size > m_capacity)
+            begin = alignUp(begin, m_capacity);
+
+        if (begin + size - m_tail <= m_capacity)
+        {
+            m_head = begin + size;
+
+            Allocation allocation;
+            allocation.buffer = m_buffer;
+            allocation.offset = begin % m_capacity;
+            allocation.size = size;
+            allocation.cpuAddress = m_mappedData + allocation.offset;
+            return allocation;
+        }
+
+        if (m_frameRegions.empty())
+        {
+            std::cerr << "[UploadRing] Frame " << frameId << " uploads more than " << m_capacity << " bytes" << std::endl;
+            return {};
+        }
+
+        // Out of space: block on the oldest frame still holding a region
+        if (!reclaimLocked(true))
+        {
+            std::cerr << "[UploadRing] No GPU timeline to wait on for frame " << m_frameRegions.front().first << std::endl;
+            return {};
+        }
+    }
+}
+
+UploadRing::Allocation UploadRing::upload(const void* data, uint64_t size, uint64_t alignment)
+{
+    Allocation allocation = allocate(size, alignment);
+    if (allocation)
+    {
+        std::memcpy(allocation.cpuAddress, data, size);
+    }
+    return allocation;
+}
+
+uint64_t UploadRing::getUsedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_head - m_tail;
+}
+
+} // namespace common
@@ -0,0 +1,76 @@
+// UploadRing.h
+// Persistently mapped ring buffer for transient per-frame uploads
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // One large CPU-writable buffer, mapped once and sub-allocated linearly. Space used
+    // during a frame is recycled once the FrameTracker retires that frame, so an upload
+    // costs an aligned pointer bump and a memcpy with no driver allocation.
+    //
+    // The buffer can be bound directly (vertex, index or constant data read by the GPU
+    // that frame) or used as the source of a copy into a device-local resource.
+    // Allocations belong to the frame that will read them: the open frame, or between
+    // frames (and before the first one) the frame about to start. When the ring is full
+    // the oldest frame is waited for. All methods are thread-safe.
+    class UploadRing
+    {
+    public:
+        struct Allocation
+        {
+            nvrhi::IBuffer* buffer = nullptr;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            void* cpuAddress = nullptr;
+
+            explicit operator bool() const { return buffer != nullptr; }
+        };
+
+        static constexpr uint64_t DefaultCapacity = 16ull << 20;
+        static constexpr uint64_t DefaultAlignment = 256;  // Covers constant buffer offsets on every backend
+
+        explicit UploadRing(IDeviceManager& deviceManager, uint64_t capacity = DefaultCapacity);
+        ~UploadRing();
+
+        UploadRing(const UploadRing&) = delete;
+        UploadRing& operator=(const UploadRing&) = delete;
+
+        // Returns an empty allocation if the size exceeds what the ring can hold
+        Allocation allocate(uint64_t size, uint64_t alignment = DefaultAlignment);
+        Allocation upload(const void* data, uint64_t size, uint64_t alignment = DefaultAlignment);
+
+        nvrhi::IBuffer* getBuffer() const { return m_buffer; }
+        uint64_t getCapacity() const { return m_capacity; }
+        uint64_t getUsedBytes() const;
+
+    private:
+        // Retired regions are released here; called with the lock held
+        // Returns false if the wait was not possible
+        bool reclaimLocked(bool wait);
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::BufferHandle m_buffer;
+        uint8_t* m_mappedData = nullptr;
+        uint64_t m_capacity = 0;
+
+        // Monotonic byte positions; the physical offset is position % capacity
+        mutable std::mutex m_mutex;
+        uint64_t m_head = 0;
+        uint64_t m_tail = 0;
+
+        // Frame that owns [region start, m_head), and the end position of older frames
+        uint64_t m_currentFrameId = 0;
+        std::deque<std::pair<uint64_t, uint64_t>> m_frameRegions;
+    };
+
+} // namespace common
@@ -0,0 +1,284 @@
+// UploadService.cpp
+// Background buffer and texture uploads on the transfer queue
+
+#include "UploadService.h"
+#include "DeviceManager.h"
+
+#include <iostream>
+
+namespace common
+{
+
+UploadService::UploadService(IDeviceManager& deviceManager)
+    : m_deviceManager(deviceManager)
+{
+    if (m_deviceManager.hasDedicatedQueue(nvrhi::CommandQueue::Copy))
+    {
+        m_queue = nvrhi::CommandQueue::Copy;
+    }
+
+    m_worker = std::thread(&UploadService::workerMain, this);
+}
+
+UploadService::~UploadService()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_requests.clear();
+    }
+    m_requestAvailable.notify_all();
+    m_worker.join();
+
+    // Recorded but unsubmitted batches are dropped; submitted ones must finish before
+    // their command lists are released
+    for (const std::unique_ptr<Batch>& batch : m_inFlight)
+    {
+        if (batch->query)
+            m_deviceManager.getDevice()->waitEventQuery(batch->query);
+    }
+}
+
+nvrhi::ResourceStates UploadService::getTextureState() const
+{
+    // D3D12 textures decay to COMMON after a copy queue submission. NVRHI maps Common to an
+    // undefined image layout on Vulkan, so textures stay in the copy layout there instead.
+    return m_deviceManager.getGraphicsAPI() == GraphicsAPI::D3D12
+        ? nvrhi::ResourceStates::Common
+        : nvrhi::ResourceStates::CopyDest;
+}
+
+uint64_t UploadService::uploadBuffer(nvrhi::IBuffer* buffer, std::vector<uint8_t> data, uint64_t destOffset)
+{
+    if (!buffer || data.empty())
+        return 0;
+
+    const nvrhi::BufferDesc& desc = buffer->getDesc();
+    if (desc.initialState != getBufferState() || !desc.keepInitialState ||
+        desc.cpuAccess != nvrhi::CpuAccessMode::None || destOffset + data.size() > desc.byteSize)
+    {
+        std::cerr << "[UploadService] Cannot upload " << data.size() << " bytes to buffer " << desc.debugName << std::endl;
+        m_failureCount++;
+        return 0;
+    }
+
+    Request request;
+    request.buffer = buffer;
+    request.destOffset = destOffset;
+    request.data = std::move(data);
+    return enqueue(std::move(request));
+}
+
+uint64_t UploadService::uploadTexture(nvrhi::ITexture* texture, std::vector<uint8_t> data, size_t rowPitch,
+    uint32_t arraySlice, uint32_t mipLevel)
+{
+    if (!texture || data.empty())
+        return 0;
+
+    const nvrhi::TextureDesc& desc = texture->getDesc();
+    if (desc.initialState != getTextureState() || !desc.keepInitialState ||
+        arraySlice >= desc.arraySize || mipLevel >= desc.mipLevels || rowPitch == 0)
+    {
+        std::cerr << "[UploadService] Cannot upload to texture " << desc.debugName << std::endl;
+        m_failureCount++;
+        return 0;
+    }
+
+    Request request;
+    request.texture = texture;
+    request.arraySlice = arraySlice;
+    request.mipLevel = mipLevel;
+    request.rowPitch = rowPitch;
+    request.data = std::move(data);
+    return enqueue(std::move(request));
+}
+
+uint64_t UploadService::enqueue(Request request)
+{
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ticket = m_nextTicket++;
+        request.ticket = ticket;
+        m_requests.push_back(std::move(request));
+    }
+    m_requestAvailable.notify_one();
+    return ticket;
+}
+
+void UploadService::workerMain()
+{
+    for (;;)
+    {
+        std::vector<Request> requests;
+        std::unique_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestAvailable.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+            if (m_stopping)
+                return;
+
+            // At least one request per batch, however large
+            uint64_t batchBytes = 0;
+            while (!m_requests.empty() && (requests.empty() || batchBytes + m_requests.front().data.size() <= MaxBatchBytes))
+            {
+                batchBytes += m_requests.front().data.size();
+                requests.push_back(std::move(m_requests.front()));
+                m_requests.pop_front();
+            }
+
+            if (!m_freeBatches.empty())
+            {
+                batch = std::move(m_freeBatches.back());
+                m_freeBatches.pop_back();
+            }
+        }
+
+        if (!batch)
+        {
+            batch = std::make_unique<Batch>();
+
+            // Recorded off the render thread, so the list must not execute immediately
+            nvrhi::CommandListParameters params;
+            params.setQueueType(m_queue);
+            params.setEnableImmediateExecution(false);
+            batch->commandList = m_deviceManager.createCommandList(params);
+            batch->query = m_deviceManager.getDevice()->createEventQuery();
+        }
+
+        batch->lastTicket = requests.back().ticket;
+        batch->bytes = 0;
+
+        if (batch->commandList && batch->query)
+        {
+            batch->commandList->open();
+            for (Request& request : requests)
+            {
+                if (request.buffer)
+                {
+                    batch->commandList->writeBuffer(request.buffer, request.data.data(), request.data.size(), request.destOffset);
+                    batch->resources.push_back(request.buffer.Get());
+                }
+                else
+                {
+                    batch->commandList->writeTexture(request.texture, request.arraySlice, request.mipLevel,
+                        request.data.data(), request.rowPitch);
+                    batch->resources.push_back(request.texture.Get());
+                }
+                batch->bytes += request.data.size();
+            }
+            batch->commandList->close();
+        }
+        else
+        {
+            // Retired straight away; the tickets complete without their data
+            std::cerr << "[UploadService] Failed to create an upload command list" << std::endl;
+            m_failureCount += requests.size();
+            batch->commandList = nullptr;
+            batch->query = nullptr;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_recorded.push_back(std::move(batch));
+        }
+        m_batchRecorded.notify_all();
+    }
+}
+
+void UploadService::submitRecorded()
+{
+    std::deque<std::unique_ptr<Batch>> recorded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        recorded.swap(m_recorded);
+    }
+
+    nvrhi::IDevice* device = m_deviceManager.getDevice();
+    for (std::unique_ptr<Batch>& batch : recorded)
+    {
+        if (batch->commandList)
+        {
+            nvrhi::ICommandList* commandList = batch->commandList;
+            batch->submissionId = m_deviceManager.executeCommandLists(
+                std::span<nvrhi::ICommandList* const>(&commandList, 1), m_queue);
+
+            device->resetEventQuery(batch->query);
+            device->setEventQuery(batch->query, m_queue);
+        }
+        m_inFlight.push_back(std::move(batch));
+    }
+}
+
+void UploadService::retireCompleted()
+{
+    nvrhi::IDevice* device = m_deviceManager.getDevice();
+    while (!m_inFlight.empty())
+    {
+        std::unique_ptr<Batch>& batch = m_inFlight.front();
+        if (batch->query && !device->pollEventQuery(batch->query))
+            break;
+
+        m_completedTicket = batch->lastTicket;
+        m_bytesUploaded += batch->bytes;
+
+        if (batch->commandList)
+        {
+            batch->resources.clear();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeBatches.push_back(std::move(batch));
+        }
+        m_inFlight.pop_front();
+    }
+}
+
+void UploadService::update()
+{
+    submitRecorded();
+    retireCompleted();
+}
+
+bool UploadService::queueWait(nvrhi::CommandQueue waitQueue, uint64_t ticket)
+{
+    update();
+    if (isComplete(ticket))
+        return true;
+
+    for (const std::unique_ptr<Batch>& batch : m_inFlight)
+    {
+        if (batch->lastTicket >= ticket)
+        {
+            m_deviceManager.queueWaitForSubmission(waitQueue, m_queue, batch->submissionId);
+            return true;
+        }
+    }
+    return false;
+}
+
+void UploadService::flush()
+{
+    for (;;)
+    {
+        update();
+
+        uint64_t lastTicket;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            lastTicket = m_nextTicket - 1;
+        }
+        if (isComplete(lastTicket))
+            return;
+
+        if (!m_inFlight.empty())
+        {
+            m_deviceManager.getDevice()->waitEventQuery(m_inFlight.front()->query);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_batchRecorded.wait(lock, [this]() { return !m_recorded.empty(); });
+        }
+    }
+}
+
+} // namespace common
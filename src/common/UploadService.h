@@ -0,0 +1,121 @@
+// UploadService.h
+// Background buffer and texture uploads on the transfer queue
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common
+{
+    class IDeviceManager;
+
+    // Streams data into device-local buffers and textures without touching the render
+    // thread's command lists. A worker thread records batches of writes on the copy queue
+    // (graphics when the device has no dedicated transfer queue); update() submits them
+    // and retires finished batches by polling event queries, which NVRHI resolves against
+    // the queue's timeline semaphore on Vulkan and its fence on D3D12.
+    //
+    // Every request returns a ticket. Tickets complete in order, so a resource is ready
+    // once isComplete() returns true for its ticket, or earlier on the GPU via queueWait().
+    // Destinations must be created with keepInitialState and the initial state given by
+    // getBufferState()/getTextureState(), which both the copy and graphics queues can
+    // hand over between command lists.
+    //
+    // Enqueueing and isComplete() are thread-safe; the other methods belong to the thread
+    // that submits frames.
+    class UploadService
+    {
+    public:
+        static constexpr uint64_t MaxBatchBytes = 32ull << 20;
+
+        explicit UploadService(IDeviceManager& deviceManager);
+        ~UploadService();
+
+        UploadService(const UploadService&) = delete;
+        UploadService& operator=(const UploadService&) = delete;
+
+        // Queue a copy into a buffer or a texture subresource; returns the ticket, or 0
+        // if the destination cannot be written by the service
+        uint64_t uploadBuffer(nvrhi::IBuffer* buffer, std::vector<uint8_t> data, uint64_t destOffset = 0);
+        uint64_t uploadTexture(nvrhi::ITexture* texture, std::vector<uint8_t> data, size_t rowPitch,
+            uint32_t arraySlice = 0, uint32_t mipLevel = 0);
+
+        // Submit recorded batches and retire completed ones; call once per frame
+        void update();
+
+        bool isComplete(uint64_t ticket) const { return ticket <= m_completedTicket; }
+
+        // Make later submissions on waitQueue wait on the GPU for a ticket. Returns false
+        // if the ticket is still being recorded, in which case try again next frame.
+        bool queueWait(nvrhi::CommandQueue waitQueue, uint64_t ticket);
+
+        // Block until every queued request has completed
+        void flush();
+
+        nvrhi::CommandQueue getQueue() const { return m_queue; }
+        nvrhi::ResourceStates getBufferState() const { return nvrhi::ResourceStates::Common; }
+        nvrhi::ResourceStates getTextureState() const;
+        uint64_t getBytesUploaded() const { return m_bytesUploaded; }
+        uint64_t getFailureCount() const { return m_failureCount; }
+
+    private:
+        struct Request
+        {
+            uint64_t ticket = 0;
+            nvrhi::BufferHandle buffer;
+            uint64_t destOffset = 0;
+            nvrhi::TextureHandle texture;
+            uint32_t arraySlice = 0;
+            uint32_t mipLevel = 0;
+            size_t rowPitch = 0;
+            std::vector<uint8_t> data;
+        };
+
+        // A command list and the destinations it writes, kept alive until it retires
+        struct Batch
+        {
+            nvrhi::CommandListHandle commandList;
+            nvrhi::EventQueryHandle query;
+            std::vector<nvrhi::ResourceHandle> resources;
+            uint64_t lastTicket = 0;
+            uint64_t submissionId = 0;
+            uint64_t bytes = 0;
+        };
+
+        uint64_t enqueue(Request request);
+        void workerMain();
+        void submitRecorded();
+        void retireCompleted();
+
+    private:
+        IDeviceManager& m_deviceManager;
+        nvrhi::CommandQueue m_queue = nvrhi::CommandQueue::Graphics;
+        std::thread m_worker;
+
+        std::mutex m_mutex;
+        std::condition_variable m_requestAvailable;
+        std::condition_variable m_batchRecorded;
+        std::deque<Request> m_requests;
+        std::deque<std::unique_ptr<Batch>> m_recorded;
+        std::vector<std::unique_ptr<Batch>> m_freeBatches;
+        uint64_t m_nextTicket = 1;
+        bool m_stopping = false;
+
+        // Submitted batches in ticket order; owned by the submitting thread
+        std::deque<std::unique_ptr<Batch>> m_inFlight;
+
+        std::atomic<uint64_t> m_completedTicket = 0;
+        std::atomic<uint64_t> m_bytesUploaded = 0;
+        std::atomic<uint64_t> m_failureCount = 0;
+    };
+
+} // namespace common
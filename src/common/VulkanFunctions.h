@@ -0,0 +1,62 @@
+// VulkanFunctions.h
+// Tables of the Vulkan entry points the device manager loads itself
+
+#pragma once
+
+// Each table applies X(name) to every function of one dispatch level, so declarations,
+// loading and statistics are generated from the same list. Adding a function means
+// adding one line to the right table; PFN_<name> must exist in vulkan.h.
+//
+// NVRHI's own calls (command recording, queue submission) go through the vulkan.hpp
+// dispatcher instead, which is initialized from the same vkGetInstanceProcAddr.
+
+// Loaded with a null instance
+#define VK_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties)
+
+// Loaded through vkGetInstanceProcAddr once the instance exists
+#define VK_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkGetDeviceProcAddr) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties2) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkCreateDevice) \
+    X(vkDestroySurfaceKHR) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkCreateDebugUtilsMessengerEXT) \
+    X(vkDestroyDebugUtilsMessengerEXT)
+
+// Loaded through vkGetDeviceProcAddr, which returns the driver's entry points directly
+// instead of loader trampolines that look up the device's dispatch table on every call
+#define VK_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkCreateSwapchainKHR) \
+    X(vkDestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR) \
+    X(vkAcquireNextImageKHR) \
+    X(vkQueuePresentKHR) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkDeviceWaitIdle) \
+    X(vkQueueWaitIdle) \
+    X(vkGetSemaphoreCounterValue) \
+    X(vkWaitSemaphores) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkGetPipelineCacheData) \
+    X(vkWaitForPresentKHR)
+
+#define VK_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
@@ -0,0 +1,520 @@
+// Benchmarks.cpp
+// Benchmark modes of the triangle demo, selected on the command line
+
+#include "Benchmarks.h"
+
+#include <TlsfAllocator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Initialize an app with presentation uncapped, run the benchmark on it and clean up;
+// returns false if the app could not be initialized
+template<typename Function>
+static bool runWithApp(AppOptions options, Function&& function)
+{
+    // Vsync would cap every configuration at the refresh rate; tearing does not matter here
+    options.presentMode = common::PresentMode::Immediate;
+    
+    TriangleApp app;
+    if (!app.initialize(options))
+    {
+        std::cerr << "Failed to initialize application" << std::endl;
+        app.cleanup();
+        return false;
+    }
+    
+    function(app);
+    app.cleanup();
+    return true;
+}
+
+int runFramesInFlightBenchmark(AppOptions options)
+{
+    std::vector<std::pair<uint32_t, FramePacingStats>> results;
+    for (uint32_t framesInFlight = 1; framesInFlight <= 3; framesInFlight++)
+    {
+        options.maxFramesInFlight = framesInFlight;
+        bool initialized = runWithApp(options, [&](TriangleApp& app)
+        {
+            results.emplace_back(framesInFlight, app.runFramePacingBenchmark(options.benchmarkFrames));
+        });
+        if (!initialized)
+            return -1;
+    }
+    
+    std::cout << std::endl;
+    std::cout << "Frames-in-flight benchmark (" << options.benchmarkFrames << " frames, "
+              << common::graphicsAPIToString(options.api) << ")" << std::endl;
+    std::cout << "  N   frame time (ms)   latency (ms)   FPS" << std::endl;
+    for (const auto& [framesInFlight, stats] : results)
+    {
+        std::cout << "  " << framesInFlight
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(18) << stats.averageFrameTimeMs
+                  << std::setw(15) << stats.averageLatencyMs
+                  << std::setprecision(1)
+                  << std::setw(9) << stats.framesPerSecond << std::endl;
+    }
+    
+    return 0;
+}
+
+int runResizeStormBenchmark(AppOptions options)
+{
+    ResizeStormStats stats;
+    bool initialized = runWithApp(options, [&](TriangleApp& app)
+    {
+        stats = app.runResizeStormBenchmark(options.benchmarkFrames);
+    });
+    if (!initialized)
+        return -1;
+    
+    std::cout << std::endl;
+    std::cout << "Resize-storm benchmark (" << options.benchmarkFrames << " frames, "
+              << common::graphicsAPIToString(options.api) << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << "  resizes: " << stats.resizeCount
+              << "   average frame: " << stats.averageFrameTimeMs << " ms"
+              << "   worst frame: " << stats.worstFrameTimeMs << " ms" << std::endl;
+    
+    return 0;
+}
+
+int runUploadStreamingBenchmark(AppOptions options)
+{
+    // 1024x1024 RGBA8 textures
+    uint32_t textureCount = std::max(1u, options.benchmarkUploadMB / 4);
+    UploadStreamingStats blocking;
+    UploadStreamingStats streamed;
+    bool initialized = runWithApp(options, [&](TriangleApp& app)
+    {
+        blocking = app.runUploadStreamingBenchmark(textureCount, false);
+        streamed = app.runUploadStreamingBenchmark(textureCount, true);
+    });
+    if (!initialized)
+        return -1;
+    
+    std::cout << std::endl;
+    std::cout << "Upload streaming benchmark (" << textureCount * 4 << " MB in " << textureCount << " textures, "
+              << common::graphicsAPIToString(options.api) << ")" << std::endl;
+    std::cout << "  mode                frames   average (ms)   worst (ms)   total (ms)" << std::endl;
+    for (const auto& [name, stats] : { std::pair{ "graphics + wait", blocking }, std::pair{ "background", streamed } })
+    {
+        std::cout << "  " << std::left << std::setw(18) << name << std::right
+                  << std::setw(8) << stats.frameCount
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(15) << stats.averageFrameTimeMs
+                  << std::setw(13) << stats.worstFrameTimeMs
+                  << std::setw(13) << stats.uploadTimeMs << std::endl;
+    }
+    
+    return 0;
+}
+
+int runResourceChurnBenchmark(AppOptions options)
+{
+    ResourceChurnStats drained;
+    ResourceChurnStats deferred;
+    bool initialized = runWithApp(options, [&](TriangleApp& app)
+    {
+        drained = app.runResourceChurnBenchmark(options.benchmarkFrames, false);
+        deferred = app.runResourceChurnBenchmark(options.benchmarkFrames, true);
+    });
+    if (!initialized)
+        return -1;
+    
+    std::cout << std::endl;
+    std::cout << "Resource churn benchmark (" << options.benchmarkFrames << " frames, "
+              << common::graphicsAPIToString(options.api) << ")" << std::endl;
+    std::cout << "  mode              average (ms)   worst (ms)   peak pending   peak bytes   released" << std::endl;
+    for (const auto& [name, stats] : { std::pair{ "wait for idle", drained }, std::pair{ "deletion queue", deferred } })
+    {
+        std::cout << "  " << std::left << std::setw(16) << name << std::right
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << stats.averageFrameTimeMs
+                  << std::setw(13) << stats.worstFrameTimeMs
+                  << std::setw(15) << stats.peakPendingObjects
+                  << std::setw(13) << stats.peakPendingBytes
+                  << std::setw(11) << stats.releasedObjects << std::endl;
+    }
+    
+    return 0;
+}
+
+int runDrawScalingBenchmark(AppOptions options)
+{
+    std::vector<DrawScalingStats> results;
+    bool initialized = runWithApp(options, [&](TriangleApp& app)
+    {
+        for (uint32_t threadCount = 1; threadCount <= options.benchmarkThreads; threadCount++)
+        {
+            results.push_back(app.runDrawScalingBenchmark(threadCount, options.benchmarkDraws, options.benchmarkFrames));
+        }
+    });
+    if (!initialized)
+        return -1;
+    
+    std::cout << std::endl;
+    std::cout << "Draw-call scaling benchmark (" << options.benchmarkDraws << " draws x "
+              << options.benchmarkFrames << " frames, " << common::graphicsAPIToString(options.api)
+              << (options.validation ? ", validation on" : "") << ")" << std::endl;
+    std::cout << "  threads   record (ms)   frame (ms)   Mdraws/s   speedup" << std::endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        double speedup = results[i].averageRecordTimeMs > 0.0
+            ? results[0].averageRecordTimeMs / results[i].averageRecordTimeMs : 0.0;
+        std::cout << std::setw(9) << (i + 1)
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << results[i].averageRecordTimeMs
+                  << std::setw(13) << results[i].averageFrameTimeMs
+                  << std::setw(11) << results[i].drawsPerSecond / 1.0e6
+                  << std::setprecision(2)
+                  << std::setw(9) << speedup << "x" << std::endl;
+    }
+    
+    return 0;
+}
+
+int runInstancingBenchmark(AppOptions options)
+{
+    // Draw calls are CPU bound long before a million of them, so the baseline renders
+    // fewer instances; instances per second stays comparable
+    const uint32_t baselineInstances = std::min(options.benchmarkInstances, 65536u);
+    InstancingStats indirect;
+    InstancingStats culled;
+    InstancingStats baseline;
+    bool initialized = runWithApp(options, [&](TriangleApp& app)
+    {
+        indirect = app.runInstancingBenchmark(options.benchmarkInstances, options.benchmarkFrames,
+            InstancingMode::Indirect);
+        culled = app.runInstancingBenchmark(options.benchmarkInstances, options.benchmarkFrames,
+            InstancingMode::Culled);
+        baseline = app.runInstancingBenchmark(baselineInstances, options.benchmarkFrames,
+            InstancingMode::DrawPerInstance);
+    });
+    if (!initialized)
+        return -1;
+    
+    std::cout << std::endl;
+    std::cout << "Instancing benchmark (" << options.benchmarkFrames << " frames, "
+              << common::graphicsAPIToString(options.api)
+              << (options.validation ? ", validation on" : "") << ")" << std::endl;
+    std::cout << "  mode            instances   visible     draws   record (ms)   frame (ms)   Minstances/s   speedup" << std::endl;
+    for (const auto& [name, stats] : { std::pair{ "draw each", baseline }, std::pair{ "indirect", indirect },
+        std::pair{ "culled", culled } })
+    {
+        double speedup = baseline.instancesPerSecond > 0.0 ? stats.instancesPerSecond / baseline.instancesPerSecond : 0.0;
+        std::cout << "  " << std::left << std::setw(12) << name << std::right
+                  << std::setw(13) << stats.instanceCount
+                  << std::setw(10) << stats.visibleCount
+                  << std::setw(10) << stats.drawCount
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << stats.averageRecordTimeMs
+                  << std::setw(13) << stats.averageFrameTimeMs
+                  << std::setw(15) << stats.instancesPerSecond / 1.0e6
+                  << std::setprecision(2)
+                  << std::setw(9) << speedup << "x" << std::endl;
+    }
+    
+    // Rounding differs between the GPU and the CPU, so instances touching a frustum plane
+    // may come out differently
+    int64_t difference = int64_t(culled.firstFrameVisible) - int64_t(culled.referenceVisible);
+    std::cout << "  first culled frame (frustum only): " << culled.firstFrameVisible << " visible on the GPU, "
+              << culled.referenceVisible << " in the CPU reference"
+              << (difference == 0 ? "" : ", differ by " + std::to_string(std::abs(difference))) << std::endl;
+    
+    return 0;
+}
+
+// Time the TLSF allocator in a steady state; its correctness is covered by the TlsfAllocator
+// test. Only metadata is exercised, so this runs without a GPU.
+int runAllocatorBenchmark()
+{
+    using Allocation = common::TlsfAllocator::Allocation;
+    
+    // Fixed seed, so runs compare
+    std::mt19937 random(12345);
+    
+    // Log-uniform sizes from 16 bytes to 64 KB and alignments up to 64 KB, like a mix of
+    // constant buffers, meshes and small textures
+    auto randomSize = [&]()
+    {
+        uint64_t base = 16ull << (random() % 12);
+        return base + random() % base;
+    };
+    auto randomAlignment = [&]()
+    {
+        return 1ull << (random() % 17);
+    };
+    
+    std::cout << std::endl;
+    std::cout << "Allocator benchmark (TLSF, CPU only)" << std::endl;
+    
+    // Throughput: fill a large block, free a random half, refill the holes, free the rest
+    const uint64_t capacity = 4ull << 30;
+    const uint32_t allocationCount = 100000;
+    const uint32_t rounds = 10;
+    common::TlsfAllocator allocator(capacity);
+    
+    std::vector<uint64_t> sizes(allocationCount);
+    std::vector<uint64_t> alignments(allocationCount);
+    for (uint32_t i = 0; i < allocationCount; i++)
+    {
+        sizes[i] = randomSize();
+        alignments[i] = randomAlignment();
+    }
+    
+    auto now = []()
+    {
+        return std::chrono::steady_clock::now();
+    };
+    auto nanosecondsSince = [&](std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(now() - start).count();
+    };
+    
+    double allocateTime = 0.0;
+    double refillTime = 0.0;
+    double freeTime = 0.0;
+    uint64_t allocateCount = 0;
+    uint64_t refillCount = 0;
+    uint64_t freeCount = 0;
+    double fragmentation = 0.0;
+    uint32_t peakRanges = 0;
+    std::vector<Allocation> allocations(allocationCount);
+    
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        auto start = now();
+        for (uint32_t i = 0; i < allocationCount; i++)
+        {
+            allocations[i] = allocator.allocate(sizes[i], alignments[i]);
+        }
+        allocateTime += nanosecondsSince(start);
+        allocateCount += allocationCount;
+        
+        std::shuffle(allocations.begin(), allocations.end(), random);
+        const uint32_t half = allocationCount / 2;
+        
+        start = now();
+        for (uint32_t i = 0; i < half; i++)
+        {
+            if (allocations[i])
+                allocator.free(allocations[i].handle);
+        }
+        freeTime += nanosecondsSince(start);
+        freeCount += half;
+        
+        fragmentation += allocator.getFragmentation();
+        peakRanges = std::max<uint32_t>(peakRanges, static_cast<uint32_t>(allocator.getStats().freeRangeCount));
+        
+        start = now();
+        for (uint32_t i = 0; i < half; i++)
+        {
+            allocations[i] = allocator.allocate(sizes[i], alignments[i]);
+        }
+        refillTime += nanosecondsSince(start);
+        refillCount += half;
+        
+        start = now();
+        for (const Allocation& allocation : allocations)
+        {
+            if (allocation)
+                allocator.free(allocation.handle);
+        }
+        freeTime += nanosecondsSince(start);
+        freeCount += allocationCount;
+    }
+    
+    std::cout << "  throughput: " << allocationCount << " allocations x " << rounds << " rounds in a "
+              << (capacity >> 20) << " MB block" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "    allocate (empty block):      " << allocateTime / allocateCount << " ns" << std::endl
+              << "    allocate (fragmented block): " << refillTime / refillCount << " ns" << std::endl
+              << "    free:                        " << freeTime / freeCount << " ns" << std::endl
+              << std::setprecision(3)
+              << "    fragmentation after freeing half: " << fragmentation / rounds
+              << " (" << peakRanges << " free ranges)" << std::endl;
+    
+    return 0;
+}
+
+// Time the culling reference that csCullInstances mirrors; its correctness is covered by
+// the InstanceCulling test. Runs without a GPU.
+int runCullingBenchmark()
+{
+    // Fixed seed, so runs compare
+    std::mt19937 random(12345);
+    
+    // An orthographic camera: clip = world * zoom + pan, depth = z
+    auto orthographic = [](float zoom, float panX, float panY, float* matrix)
+    {
+        const float values[16] = {
+            zoom, 0.0f, 0.0f, panX,
+            0.0f, zoom, 0.0f, panY,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+        std::copy(std::begin(values), std::end(values), matrix);
+    };
+    
+    std::cout << std::endl;
+    std::cout << "Culling benchmark (CPU reference)" << std::endl;
+    
+    // Throughput: the instancing benchmark's scene and camera on a window-sized buffer
+    const uint32_t instanceCount = 1u << 20;
+    const uint32_t width = WINDOW_WIDTH;
+    const uint32_t height = WINDOW_HEIGHT;
+    std::vector<InstanceData> instances = createInstanceGrid(instanceCount);
+    std::vector<common::BoundingSphere> spheres(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        std::copy(std::begin(instances[i].position), std::end(instances[i].position), spheres[i].center);
+        spheres[i].radius = instances[i].radius;
+    }
+    
+    std::vector<float> depth(size_t(width) * height, 1.0f);
+    for (uint32_t rectangle = 0; rectangle < 64; rectangle++)
+    {
+        uint32_t x0 = random() % width;
+        uint32_t y0 = random() % height;
+        uint32_t x1 = std::min(width - 1, x0 + 32 + uint32_t(random() % 128));
+        uint32_t y1 = std::min(height - 1, y0 + 32 + uint32_t(random() % 128));
+        for (uint32_t y = y0; y <= y1; y++)
+        {
+            std::fill(depth.begin() + y * width + x0, depth.begin() + y * width + x1 + 1, 0.05f);
+        }
+    }
+    
+    auto now = []()
+    {
+        return std::chrono::steady_clock::now();
+    };
+    auto millisecondsSince = [&](std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(now() - start).count();
+    };
+    
+    common::HiZPyramid hiZ;
+    auto start = now();
+    hiZ.build(depth.data(), width, height);
+    double buildTime = millisecondsSince(start);
+    
+    float matrix[16];
+    orthographic(1.5f, 0.25f, -0.25f, matrix);
+    common::CullingView view;
+    view.setMatrices(matrix, matrix);
+    
+    std::vector<uint32_t> visible;
+    visible.reserve(instanceCount);
+    start = now();
+    common::cullInstances(view, nullptr, spheres, visible);
+    double frustumTime = millisecondsSince(start);
+    size_t frustumVisible = visible.size();
+    
+    visible.clear();
+    start = now();
+    common::cullInstances(view, &hiZ, spheres, visible);
+    double occlusionTime = millisecondsSince(start);
+    
+    std::cout << "  throughput: " << instanceCount << " instances, " << width << "x" << height << " depth" << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << "    HiZ build:             " << buildTime << " ms" << std::endl
+              << "    frustum:               " << frustumTime << " ms, " << frustumVisible << " visible" << std::endl
+              << "    frustum and occlusion: " << occlusionTime << " ms, " << visible.size() << " visible" << std::endl
+              << std::setprecision(1)
+              << "    " << instanceCount / (occlusionTime * 1.0e3) << " Minstances/s with occlusion" << std::endl;
+    
+    return 0;
+}
+
+// A synthetic frame for the render graph benchmark: every pass reads up to three of the
+// last sixteen targets and writes a new one; every 50th pass and the last composite into
+// the back buffer instead. Targets nothing reads make whole chains of passes culled.
+static void buildSyntheticGraph(common::RenderGraph& graph, uint32_t passCount, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    graph.clear();
+    common::RenderGraph::ResourceId backBuffer = graph.importTexture(nullptr, nvrhi::ResourceStates::Present,
+        nvrhi::ResourceStates::Present);
+    
+    std::vector<common::RenderGraph::ResourceId> targets;
+    for (uint32_t i = 0; i < passCount; i++)
+    {
+        common::RenderGraph::PassId pass = graph.addPass("Pass" + std::to_string(i));
+        uint32_t readCount = targets.empty() ? 0 : random() % 4;
+        for (uint32_t read = 0; read < readCount; read++)
+        {
+            size_t window = std::min<size_t>(targets.size(), 16);
+            graph.read(pass, targets[targets.size() - 1 - random() % window], nvrhi::ResourceStates::ShaderResource);
+        }
+        
+        if (i % 50 == 49 || i == passCount - 1)
+        {
+            graph.write(pass, backBuffer, nvrhi::ResourceStates::RenderTarget);
+            continue;
+        }
+        
+        // Full, half and quarter resolution; a quarter of the passes are compute
+        uint32_t shift = random() % 3;
+        bool compute = random() % 4 == 0;
+        nvrhi::TextureDesc desc;
+        desc.width = 1920 >> shift;
+        desc.height = 1080 >> shift;
+        desc.format = compute ? nvrhi::Format::RGBA16_FLOAT : nvrhi::Format::RGBA8_UNORM;
+        desc.isRenderTarget = !compute;
+        desc.isUAV = compute;
+        desc.debugName = "Target" + std::to_string(i);
+        
+        common::RenderGraph::ResourceId target = graph.createTexture(desc);
+        graph.write(pass, target, compute ? nvrhi::ResourceStates::UnorderedAccess : nvrhi::ResourceStates::RenderTarget);
+        targets.push_back(target);
+    }
+}
+
+// Time declaring and compiling synthetic graphs of passCount passes; the compiler's
+// correctness is covered by the RenderGraph test. No GPU is needed.
+int runRenderGraphBenchmark(uint32_t passCount)
+{
+    std::cout << std::endl;
+    std::cout << "Render graph benchmark" << std::endl;
+    
+    // Throughput: declaring and compiling a frame, as every frame does
+    const uint32_t iterations = 100;
+    common::RenderGraph graph;
+    double buildTime = 0.0;
+    double compileTime = 0.0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        buildSyntheticGraph(graph, passCount, 12345);
+        auto built = std::chrono::steady_clock::now();
+        graph.compile();
+        auto compiled = std::chrono::steady_clock::now();
+        buildTime += std::chrono::duration<double, std::micro>(built - start).count();
+        compileTime += std::chrono::duration<double, std::micro>(compiled - built).count();
+    }
+    
+    common::RenderGraph::Stats stats = graph.getStats();
+    std::cout << "  " << passCount << " passes, " << stats.passCount - stats.culledPassCount << " kept, "
+              << stats.culledPassCount << " culled" << std::endl;
+    std::cout << "  barriers: " << stats.barrierCount << " in " << stats.barrierBatchCount << " batches, "
+              << stats.aliasingBarrierCount << " for aliasing" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  transients: " << stats.transientCount << ", " << stats.transientBytes / (1024.0 * 1024.0)
+              << " MB in " << stats.heapBytes / (1024.0 * 1024.0) << " MB of heaps" << std::endl;
+    std::cout << std::setprecision(3)
+              << "  build:   " << buildTime / iterations / 1000.0 << " ms" << std::endl
+              << "  compile: " << compileTime / iterations / 1000.0 << " ms" << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,22 @@
+// Benchmarks.h
+// Benchmark modes of the triangle demo, selected on the command line
+
+#pragma once
+
+#include "TriangleApp.h"
+
+#include <cstdint>
+
+// Rendering benchmarks: each runs one or more apps with the given options, presentation
+// uncapped, prints a table and returns the exit code
+int runFramesInFlightBenchmark(AppOptions options);    // 1..3 frames in flight, compared
+int runResizeStormBenchmark(AppOptions options);       // A swap chain resize every frame
+int runUploadStreamingBenchmark(AppOptions options);   // Textures uploaded blocking, then in the background
+int runResourceChurnBenchmark(AppOptions options);     // A buffer replaced every frame, drained vs deferred
+int runDrawScalingBenchmark(AppOptions options);       // Draw recording on 1..N threads
+int runInstancingBenchmark(AppOptions options);        // One draw each vs indirect vs culled
+
+// CPU only, no device is created; correctness is covered by the common_tests suites
+int runAllocatorBenchmark();
+int runCullingBenchmark();
+int runRenderGraphBenchmark(uint32_t passCount);
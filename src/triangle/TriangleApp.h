@@ -0,0 +1,332 @@
+// TriangleApp.h
+// The triangle demo application, its command line options and its benchmark statistics
+
+#pragma once
+
+#include <DeviceManager.h>
+#include <BindlessTable.h>
+#include <CommandListPool.h>
+#include <InstanceCulling.h>
+#include <PipelineCache.h>
+#include <RenderGraph.h>
+#include <ResourceAllocator.h>
+#include <ShaderLibrary.h>
+#include <ShaderPermutations.h>
+#include <ThreadPool.h>
+#include <TransientTexturePool.h>
+#include <UploadRing.h>
+#include <UploadService.h>
+
+#include <GLFW/glfw3.h>
+
+#include <nvrhi/nvrhi.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Window dimensions
+constexpr int WINDOW_WIDTH = 1280;
+constexpr int WINDOW_HEIGHT = 720;
+
+// Per-instance transform and bounds read by vsInstanced and vsCulled from a structured buffer
+struct InstanceData
+{
+    float position[3];
+    float scale;
+    float rotation;
+    float radius;
+    float padding[2];
+};
+
+// Instances on a grid over [-1, 1] x [-1, 1] at varying depths, each with its own size and
+// angle. Every 256th is a large occluder in front of the others.
+std::vector<InstanceData> createInstanceGrid(uint32_t instanceCount);
+
+// Command line options
+struct AppOptions
+{
+    common::GraphicsAPI api = common::GraphicsAPI::Vulkan;
+    uint32_t maxFramesInFlight = 2;
+    common::PresentMode presentMode = common::PresentMode::Fifo;
+    uint32_t maxFrameRate = 0;
+    bool validation = true;
+    
+    // Adapter to create the device on: an index from --list-adapters or part of a name
+    std::string adapter;
+    bool listAdapters = false;
+    
+    // Persistent pipeline cache directory (empty disables it)
+    std::string pipelineCacheDirectory = "cache";
+    
+    // Compiled shader binaries, keyed by content hash
+    std::string shaderCacheDirectory = "cache/shaders";
+    
+    // Pixel shader permutation, and whether to build every permutation at startup
+    uint32_t shadeMode = 0;
+    bool compileAllShaders = false;
+    
+    // Headless: render offscreen without a window for a fixed number of frames
+    bool headless = false;
+    uint32_t headlessFrames = 100;
+    
+    // Rotate the triangle by streaming its vertices through the upload ring every frame
+    bool animate = false;
+    
+    // Fault injection: simulate a device loss every N frames (0 disables it)
+    uint32_t deviceLostInterval = 0;
+    
+    // Fetch vertices through the bindless table instead of a vertex buffer binding
+    bool bindless = false;
+    
+    // Windows sharing the device; each draws the triangle and all present together
+    uint32_t windowCount = 1;
+    
+    // Frame capture: a single frame and/or a printf-style sequence pattern
+    std::string capturePath;
+    std::string captureSequencePattern;
+    
+    // Frames-in-flight benchmark: renders a fixed number of frames for N = 1..3
+    bool benchmarkFramesInFlight = false;
+    uint32_t benchmarkFrames = 1000;
+    
+    // Draw-call scaling benchmark: records benchmarkDraws draws per frame on 1..N threads
+    uint32_t benchmarkThreads = 0;
+    uint32_t benchmarkDraws = 10000;
+    
+    // Resize-storm benchmark: changes the window size every frame
+    bool benchmarkResize = false;
+    
+    // Upload streaming benchmark: megabytes of texture data loaded while rendering
+    uint32_t benchmarkUploadMB = 0;
+    
+    // Resource churn benchmark: replaces the vertex buffer every frame
+    bool benchmarkChurn = false;
+    
+    // Allocator benchmark: CPU-only test and timing of the heap sub-allocator metadata
+    bool benchmarkAllocator = false;
+    
+    // Instancing benchmark: N triangle instances in one indirect draw vs one draw each
+    uint32_t benchmarkInstances = 0;
+    
+    // Culling benchmark: CPU-only test and timing of the culling reference
+    bool benchmarkCulling = false;
+    
+    // Render graph benchmark: CPU-only test and timing of compiling an n-pass graph
+    uint32_t benchmarkRenderGraph = 0;
+};
+
+// Frame pacing statistics gathered by TriangleApp::runFramePacingBenchmark
+struct FramePacingStats
+{
+    double averageFrameTimeMs = 0.0;
+    double averageLatencyMs = 0.0;  // CPU frame start to observed GPU completion
+    double framesPerSecond = 0.0;
+};
+
+// Recording statistics gathered by TriangleApp::runDrawScalingBenchmark
+struct DrawScalingStats
+{
+    double averageRecordTimeMs = 0.0;  // Parallel recording of all draws, excluding submit/present
+    double averageFrameTimeMs = 0.0;
+    double drawsPerSecond = 0.0;
+};
+
+// Frame time statistics gathered by TriangleApp::runResizeStormBenchmark
+struct ResizeStormStats
+{
+    double averageFrameTimeMs = 0.0;
+    double worstFrameTimeMs = 0.0;
+    uint32_t resizeCount = 0;
+};
+
+// Frame time statistics gathered by TriangleApp::runUploadStreamingBenchmark
+struct UploadStreamingStats
+{
+    double averageFrameTimeMs = 0.0;
+    double worstFrameTimeMs = 0.0;
+    double uploadTimeMs = 0.0;  // First frame to the last texture being usable
+    uint32_t frameCount = 0;
+};
+
+// Frame time and deletion queue statistics gathered by TriangleApp::runResourceChurnBenchmark
+struct ResourceChurnStats
+{
+    double averageFrameTimeMs = 0.0;
+    double worstFrameTimeMs = 0.0;
+    uint64_t peakPendingObjects = 0;
+    uint64_t peakPendingBytes = 0;
+    uint64_t releasedObjects = 0;
+};
+
+// How TriangleApp::runInstancingBenchmark submits the instances
+enum class InstancingMode
+{
+    DrawPerInstance,    // The baseline: one draw call each
+    Indirect,           // One draw, arguments written by a compute pass
+    Culled              // One draw of the instances left by frustum and HiZ culling
+};
+
+// Throughput statistics gathered by TriangleApp::runInstancingBenchmark
+struct InstancingStats
+{
+    double averageRecordTimeMs = 0.0;
+    double averageFrameTimeMs = 0.0;
+    double instancesPerSecond = 0.0;    // Submitted, including culled ones
+    uint32_t instanceCount = 0;
+    uint32_t drawCount = 0;             // Per frame
+    uint32_t visibleCount = 0;          // Drawn in the last frame
+    
+    // Culled mode: the first frame has no depth pyramid yet, so it is culled by the frustum
+    // alone and its count read back from the GPU is checked against common::cullInstances
+    uint32_t firstFrameVisible = 0;
+    uint32_t referenceVisible = 0;
+};
+
+// Application class encapsulating all rendering state
+class TriangleApp
+{
+public:
+    bool initialize(const AppOptions& options);
+    void mainLoop();
+    FramePacingStats runFramePacingBenchmark(uint32_t frameCount);
+    DrawScalingStats runDrawScalingBenchmark(uint32_t threadCount, uint32_t drawCount, uint32_t frameCount);
+    ResizeStormStats runResizeStormBenchmark(uint32_t frameCount);
+    UploadStreamingStats runUploadStreamingBenchmark(uint32_t textureCount, bool background);
+    ResourceChurnStats runResourceChurnBenchmark(uint32_t frameCount, bool deferred);
+    InstancingStats runInstancingBenchmark(uint32_t instanceCount, uint32_t frameCount, InstancingMode mode);
+    void cleanup();
+
+private:
+    bool initWindow();
+    bool loadShaders();
+    bool createPipeline();
+    bool createInputLayout();
+    nvrhi::GraphicsPipelineDesc makePipelineDesc(nvrhi::IShader* pixelShader) const;
+    nvrhi::FramebufferInfo getFramebufferInfo() const;
+    bool setShadeMode(uint32_t shadeMode);
+    bool createVertexBuffer();
+    bool createBindlessResources();
+    bool createInstancingResources(uint32_t instanceCount);
+    bool createCullingResources(uint32_t instanceCount);
+    
+    // Windows beyond the first, each with its own swap chain on the shared device
+    bool createExtraWindows(uint32_t count);
+    void updateExtraWindows();
+    void destroyExtraWindows();
+    
+    // Everything created from the device, rebuilt after a device loss
+    bool createDeviceResources();
+    void releaseDeviceResources();
+    
+    bool beginFrame();
+    void render();
+    void drawTriangle(nvrhi::IFramebuffer* framebuffer, uint32_t width, uint32_t height,
+        const nvrhi::Color& clearColor, const nvrhi::VertexBufferBinding& vertexBuffer);
+    double renderMultithreaded(common::ThreadPool& workers, uint32_t jobCount, uint32_t drawCount);
+    double renderInstanced(uint32_t instanceCount, InstancingMode mode);
+    void recordCulledInstances(uint32_t instanceCount);
+    nvrhi::IFramebuffer* getDepthFramebuffer();
+    void onResize(int width, int height);
+    void updateWindowTitle();
+    
+    // GLFW window resize callback
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+private:
+    // Window
+    GLFWwindow* m_window = nullptr;
+    int m_windowWidth = WINDOW_WIDTH;
+    int m_windowHeight = WINDOW_HEIGHT;
+    bool m_windowResized = false;
+    
+    struct ExtraWindow
+    {
+        GLFWwindow* window = nullptr;
+        common::ISwapChain* swapChain = nullptr;
+    };
+    std::vector<ExtraWindow> m_extraWindows;
+    
+    AppOptions m_options;
+    
+    // Device manager (handles D3D12/Vulkan backend)
+    std::unique_ptr<common::IDeviceManager> m_deviceManager;
+    nvrhi::CommandListHandle m_commandList;
+    std::unique_ptr<common::CommandListPool> m_commandListPool;
+    
+    // Pipeline resources
+    std::unique_ptr<common::ShaderLibrary> m_shaderLibrary;
+    std::vector<std::unique_ptr<common::ShaderPermutationSet>> m_shaderSets;
+    nvrhi::ShaderHandle m_vertexShader;
+    nvrhi::ShaderHandle m_pixelShader;
+    nvrhi::InputLayoutHandle m_inputLayout;
+    std::unique_ptr<common::PipelineCache> m_pipelineCache;
+    std::unique_ptr<common::ThreadPool> m_prewarmThreads;
+    nvrhi::GraphicsPipelineHandle m_pipeline;
+    uint32_t m_shadeMode = 0;
+    nvrhi::BufferHandle m_vertexBuffer;
+    std::unique_ptr<common::UploadRing> m_uploadRing;
+    std::unique_ptr<common::UploadService> m_uploadService;
+    std::unique_ptr<common::ResourceAllocator> m_resourceAllocator;
+    
+    // The frame as a render graph, rebuilt and compiled every frame
+    common::RenderGraph m_renderGraph;
+    std::unique_ptr<common::TransientTexturePool> m_transientTextures;
+    
+    // Bindless mode: the table, and push constants selecting the vertex buffer entry
+    std::unique_ptr<common::BindlessTable> m_bindlessTable;
+    nvrhi::BindingLayoutHandle m_bindlessConstantsLayout;
+    nvrhi::BindingSetHandle m_bindlessConstantsSet;
+    uint32_t m_vertexBufferIndex = common::BindlessTable::InvalidIndex;
+    uint32_t m_uploadRingIndex = common::BindlessTable::InvalidIndex;
+    
+    // Instancing benchmark: per-instance transforms, and the indirect draw arguments
+    // written by a compute pass every frame
+    nvrhi::BufferHandle m_instanceBuffer;
+    nvrhi::BufferHandle m_drawArgsBuffer;
+    nvrhi::BindingLayoutHandle m_instancingLayout;
+    nvrhi::BindingSetHandle m_instancingSet;
+    nvrhi::BindingLayoutHandle m_drawArgsLayout;
+    nvrhi::BindingSetHandle m_drawArgsSet;
+    nvrhi::GraphicsPipelineHandle m_instancedPipeline;
+    nvrhi::ComputePipelineHandle m_drawArgsPipeline;
+    uint32_t m_instanceCapacity = 0;
+    
+    // Culled instancing: a compute pass appends the instances inside the frustum and not
+    // behind the previous frame's HiZ pyramid to a visible list and the draw arguments
+    struct CullingResources
+    {
+        nvrhi::BufferHandle constantBuffer;
+        nvrhi::BufferHandle visibleInstanceBuffer;
+        nvrhi::BufferHandle readbackBuffer;     // Visible counts of the first and last frame
+        nvrhi::TextureHandle depthTexture;
+        nvrhi::TextureHandle hiZTexture;
+        nvrhi::BindingLayoutHandle cullingLayout;
+        nvrhi::BindingLayoutHandle drawLayout;
+        nvrhi::BindingLayoutHandle hiZLayout;
+        nvrhi::BindingSetHandle cullingSet;
+        nvrhi::BindingSetHandle drawSet;
+        std::vector<nvrhi::BindingSetHandle> hiZSets;           // Per mip level
+        std::vector<nvrhi::FramebufferHandle> framebuffers;     // Per back buffer, with depth
+        nvrhi::ComputePipelineHandle cullingPipeline;
+        nvrhi::ComputePipelineHandle hiZPipeline;
+        nvrhi::GraphicsPipelineHandle pipeline;
+        uint32_t instanceCapacity = 0;
+        
+        common::CullingView view;
+        common::CullingView firstView;          // Of the first frame since the reset
+        uint32_t framesSinceReset = 0;
+        bool hiZValid = false;
+    };
+    CullingResources m_culling;
+    
+    // FPS tracking
+    double m_lastTime = 0.0;
+    double m_lastTitleUpdateTime = 0.0;
+    int m_frameCount = 0;
+    uint32_t m_resizeCount = 0;
+    double m_fps = 0.0;
+    
+    // Device-local usage above 90% of the budget, reported when it changes
+    bool m_memoryBudgetWarning = false;
+};
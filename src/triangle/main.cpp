@@ -2,7 +2,8 @@
 // This demo shows how to render a simple colored triangle using NVRHI
 // Supports both D3D12 and Vulkan backends
 
-#include <DeviceManager.h>
+#include "Benchmarks.h"
+#include "TriangleApp.h"
 
 #include <GLFW/glfw3.h>
 
@@ -12,14 +13,18 @@
 #include <iostream>
 #include <vector>
 #include <array>
-#include <fstream>
 #include <memory>
 #include <sstream>
 #include <iomanip>
-
-// Window dimensions
-constexpr int WINDOW_WIDTH = 1280;
-constexpr int WINDOW_HEIGHT = 720;
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
 
 // Vertex structure matching shader input
 struct Vertex
@@ -28,6 +33,74 @@ struct Vertex
     float color[3];
 };
 
+// Push constants of vsBindless: which table entry holds the vertices, and where
+struct BindlessConstants
+{
+    uint32_t vertexBufferIndex;
+    uint32_t vertexOffset;
+};
+
+// Push constants of instancing.slang, shared by vsInstanced and csWriteDrawArgs
+struct InstancingConstants
+{
+    uint32_t instanceOffset;
+    float time;
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+};
+
+// Constant buffer of culling.slang: rows of the matrices, as in common::CullingView
+struct CullingConstants
+{
+    float viewProj[16];
+    float prevViewProj[16];
+    float frustumPlanes[6][4];
+    uint32_t instanceCount;
+    uint32_t hiZMipCount;
+    uint32_t hiZSize[2];
+    uint32_t occlusionEnabled;
+    uint32_t padding[3];
+};
+
+// Push constants of csBuildHiZ
+struct HiZConstants
+{
+    uint32_t sourceSize[2];
+    uint32_t destSize[2];
+};
+
+// Shader entry points and their permutation axes, indexed by TriangleShader
+enum TriangleShader
+{
+    TriangleVS,
+    TrianglePS,
+    TriangleBindlessVS,
+    InstancedVS,
+    WriteDrawArgsCS,
+    CulledVS,
+    CullInstancesCS,
+    BuildHiZCS
+};
+
+struct ShaderTableEntry
+{
+    const char* sourcePath;
+    const char* entryPoint;
+    nvrhi::ShaderType shaderType;
+    std::vector<common::ShaderPermutationAxis> axes;
+};
+
+static const ShaderTableEntry g_TriangleShaders[] = {
+    { "shaders/triangle.slang",   "vsMain",          nvrhi::ShaderType::Vertex,  {} },
+    { "shaders/triangle.slang",   "psMain",          nvrhi::ShaderType::Pixel,   { { "SHADE_MODE", { "0", "1", "2" } } } },
+    { "shaders/triangle.slang",   "vsBindless",      nvrhi::ShaderType::Vertex,  {} },
+    { "shaders/instancing.slang", "vsInstanced",     nvrhi::ShaderType::Vertex,  {} },
+    { "shaders/instancing.slang", "csWriteDrawArgs", nvrhi::ShaderType::Compute, {} },
+    { "shaders/culling.slang",    "vsCulled",        nvrhi::ShaderType::Vertex,  {} },
+    { "shaders/culling.slang",    "csCullInstances", nvrhi::ShaderType::Compute, {} },
+    { "shaders/culling.slang",    "csBuildHiZ",      nvrhi::ShaderType::Compute, {} },
+};
+
 // Triangle vertices with position and color
 static const std::array<Vertex, 3> g_TriangleVertices = {{
     // Position (x, y, z),       Color (r, g, b)
@@ -36,53 +109,36 @@ static const std::array<Vertex, 3> g_TriangleVertices = {{
     {{ -0.5f,  -0.5f, 0.0f },  { 0.0f, 0.0f, 1.0f }}   // Bottom Left - Blue
 }};
 
-// Application class encapsulating all rendering state
-class TriangleApp
-{
-public:
-    bool initialize(common::GraphicsAPI api);
-    void mainLoop();
-    void cleanup();
-
-private:
-    bool initWindow();
-    bool loadShaders();
-    bool createPipeline();
-    bool createVertexBuffer();
-    
-    void render();
-    void onResize(int width, int height);
-    void updateWindowTitle();
-    
-    std::vector<uint8_t> loadShaderFromFile(const std::string& filename);
-
-    // GLFW window resize callback
-    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
-
-private:
-    // Window
-    GLFWwindow* m_window = nullptr;
-    int m_windowWidth = WINDOW_WIDTH;
-    int m_windowHeight = WINDOW_HEIGHT;
-    bool m_windowResized = false;
-    
-    // Device manager (handles D3D12/Vulkan backend)
-    std::unique_ptr<common::IDeviceManager> m_deviceManager;
-    nvrhi::CommandListHandle m_commandList;
-    
-    // Pipeline resources
-    nvrhi::ShaderHandle m_vertexShader;
-    nvrhi::ShaderHandle m_pixelShader;
-    nvrhi::InputLayoutHandle m_inputLayout;
-    nvrhi::GraphicsPipelineHandle m_pipeline;
-    nvrhi::BufferHandle m_vertexBuffer;
-    
-    // FPS tracking
-    double m_lastTime = 0.0;
-    double m_lastTitleUpdateTime = 0.0;
-    int m_frameCount = 0;
-    double m_fps = 0.0;
-};
+// Instances on a grid over [-1, 1] x [-1, 1] at varying depths, each with its own size and
+// angle. Every 256th is a large occluder in front of the others.
+std::vector<InstanceData> createInstanceGrid(uint32_t instanceCount)
+{
+    float boundingRadius = 0.0f;
+    for (const Vertex& vertex : g_TriangleVertices)
+    {
+        boundingRadius = std::max(boundingRadius, std::hypot(vertex.position[0], vertex.position[1]));
+    }
+    
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(double(instanceCount))));
+    float cellSize = 2.0f / float(columns);
+    std::vector<InstanceData> instances(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        InstanceData& instance = instances[i];
+        instance.position[0] = -1.0f + (float(i % columns) + 0.5f) * cellSize;
+        instance.position[1] = 1.0f - (float(i / columns) + 0.5f) * cellSize;
+        instance.position[2] = 0.2f + 0.79f * float((i * 2654435761u) >> 8) / 16777216.0f;
+        instance.scale = cellSize * (0.5f + 0.5f * float(i % 7) / 6.0f);
+        instance.rotation = float(i) * 2.39996f;  // Golden angle, so neighbours differ
+        if (i % 256 == 0)
+        {
+            instance.position[2] = 0.05f;
+            instance.scale = cellSize * 12.0f;
+        }
+        instance.radius = instance.scale * boundingRadius;
+    }
+    return instances;
+}
 
 void TriangleApp::framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
@@ -92,9 +148,13 @@ void TriangleApp::framebufferSizeCallback(GLFWwindow* window, int width, int hei
     app->m_windowResized = true;
 }
 
-bool TriangleApp::initialize(common::GraphicsAPI api)
+bool TriangleApp::initialize(const AppOptions& options)
 {
-    if (!initWindow()) return false;
+    m_options = options;
+    m_shadeMode = options.shadeMode;
+    common::GraphicsAPI api = options.api;
+    
+    if (!options.headless && !initWindow()) return false;
     
     // Create device manager for the selected API
     m_deviceManager = common::createDeviceManager(api);
@@ -107,12 +167,22 @@ bool TriangleApp::initialize(common::GraphicsAPI api)
     // Set up device creation params
     common::DeviceCreationParams params;
     params.window = m_window;
+    params.headless = options.headless;
     params.windowWidth = m_windowWidth;
     params.windowHeight = m_windowHeight;
     params.swapChainBufferCount = 2;
     params.enableDebugLayer = true;
-    params.enableValidationLayer = true;
-    params.vsync = true;
+    params.enableValidationLayer = options.validation;
+    params.presentMode = options.presentMode;
+    params.maxFrameRate = options.maxFrameRate;
+    params.maxFramesInFlight = options.maxFramesInFlight;
+    params.pipelineCacheDirectory = options.pipelineCacheDirectory;
+    bool adapterIsIndex = !options.adapter.empty() && std::all_of(options.adapter.begin(), options.adapter.end(),
+        [](unsigned char c) { return std::isdigit(c) != 0; });
+    if (adapterIsIndex)
+        params.preferredAdapterIndex = std::atoi(options.adapter.c_str());
+    else
+        params.preferredAdapterName = options.adapter;
     
     if (!m_deviceManager->createDevice(params))
     {
@@ -120,21 +190,47 @@ bool TriangleApp::initialize(common::GraphicsAPI api)
         return false;
     }
     
-    // Create command list
-    m_commandList = m_deviceManager->createCommandList();
-    if (!m_commandList)
+    common::MemoryStats memoryStats = m_deviceManager->getMemoryStats();
+    std::cout << "Device memory: " << (memoryStats.getDeviceLocalUsage() >> 20) << " MB used of "
+              << (memoryStats.getDeviceLocalBudget() >> 20) << " MB budget"
+              << (memoryStats.budgetSupported ? "" : " (heap size, no budget query)") << std::endl;
+    
+    // A streaming system would evict here; the demo only reports crossing the threshold
+    m_deviceManager->setMemoryBudgetCallback([this](const common::MemoryStats& stats)
     {
-        std::cerr << "Failed to create command list" << std::endl;
-        return false;
-    }
+        bool overThreshold = stats.budgetSupported &&
+            stats.getDeviceLocalUsage() > stats.getDeviceLocalBudget() / 10 * 9;
+        if (overThreshold != m_memoryBudgetWarning)
+        {
+            std::cout << "Device memory " << (overThreshold ? "above" : "back below") << " 90% of budget: "
+                      << (stats.getDeviceLocalUsage() >> 20) << " / " << (stats.getDeviceLocalBudget() >> 20)
+                      << " MB" << std::endl;
+            m_memoryBudgetWarning = overThreshold;
+        }
+    });
     
-    if (!loadShaders()) return false;
-    if (!createPipeline()) return false;
-    if (!createVertexBuffer()) return false;
+    // After a device loss everything created from the old device is rebuilt
+    m_deviceManager->setDeviceRecoveryCallbacks({
+        [this]() { releaseDeviceResources(); },
+        [this]() { return createDeviceResources(); }
+    });
+    
+    if (!createDeviceResources()) return false;
+    
+    if (m_window && options.windowCount > 1 && !createExtraWindows(options.windowCount - 1)) return false;
+    
+    // Readback happens asynchronously inside present()
+    if (!options.capturePath.empty())
+        m_deviceManager->getFrameCapture().captureNextFrame(options.capturePath);
+    if (!options.captureSequencePattern.empty())
+        m_deviceManager->getFrameCapture().startSequence(options.captureSequencePattern);
     
     // Set initial window title with API name
-    std::string initialTitle = "NVRHI Triangle Demo - " + std::string(m_deviceManager->getGraphicsAPIName());
-    glfwSetWindowTitle(m_window, initialTitle.c_str());
+    if (m_window)
+    {
+        std::string initialTitle = "NVRHI Triangle Demo - " + std::string(m_deviceManager->getGraphicsAPIName());
+        glfwSetWindowTitle(m_window, initialTitle.c_str());
+    }
     
     std::cout << "Initialized with " << m_deviceManager->getGraphicsAPIName() << " backend" << std::endl;
     return true;
@@ -167,91 +263,142 @@ bool TriangleApp::initWindow()
     return true;
 }
 
-std::vector<uint8_t> TriangleApp::loadShaderFromFile(const std::string& filename)
+bool TriangleApp::createExtraWindows(uint32_t count)
 {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open())
+    for (uint32_t i = 0; i < count; i++)
     {
-        return {};
+        std::string title = "NVRHI Triangle Demo - Window " + std::to_string(i + 2);
+        GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, title.c_str(), nullptr, nullptr);
+        if (!window)
+        {
+            std::cerr << "Failed to create GLFW window " << i + 2 << std::endl;
+            return false;
+        }
+        
+        common::ISwapChain* swapChain = m_deviceManager->createWindowSwapChain(window);
+        if (!swapChain)
+        {
+            std::cerr << "Failed to create a swap chain for window " << i + 2 << std::endl;
+            glfwDestroyWindow(window);
+            return false;
+        }
+        m_extraWindows.push_back({ window, swapChain });
     }
     
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::vector<uint8_t> buffer(size);
-    file.read(reinterpret_cast<char*>(buffer.data()), size);
-    
-    return buffer;
+    std::cout << "Rendering to " << m_extraWindows.size() + 1 << " windows with one device" << std::endl;
+    return true;
+}
+
+void TriangleApp::updateExtraWindows()
+{
+    for (auto it = m_extraWindows.begin(); it != m_extraWindows.end();)
+    {
+        // Closing an extra window only removes that window
+        if (glfwWindowShouldClose(it->window))
+        {
+            m_deviceManager->destroyWindowSwapChain(it->swapChain);
+            glfwDestroyWindow(it->window);
+            it = m_extraWindows.erase(it);
+            continue;
+        }
+        
+        // Vulkan also recreates out-of-date swap chains at acquire; DXGI needs the resize
+        int width, height;
+        glfwGetFramebufferSize(it->window, &width, &height);
+        if (width > 0 && height > 0 &&
+            (uint32_t(width) != it->swapChain->getWidth() || uint32_t(height) != it->swapChain->getHeight()))
+        {
+            it->swapChain->resize(width, height);
+        }
+        ++it;
+    }
+}
+
+void TriangleApp::destroyExtraWindows()
+{
+    for (const ExtraWindow& extraWindow : m_extraWindows)
+    {
+        if (m_deviceManager)
+            m_deviceManager->destroyWindowSwapChain(extraWindow.swapChain);
+        glfwDestroyWindow(extraWindow.window);
+    }
+    m_extraWindows.clear();
 }
 
 bool TriangleApp::loadShaders()
 {
-    // Determine shader file extension based on API
-    std::string vsFile, psFile;
+    m_shaderLibrary = std::make_unique<common::ShaderLibrary>(*m_deviceManager, m_options.shaderCacheDirectory);
+#ifdef SLANGC_EXECUTABLE
+    m_shaderLibrary->setCompilerPath(SLANGC_EXECUTABLE);
+#endif
     
-    if (m_deviceManager->getGraphicsAPI() == common::GraphicsAPI::D3D12)
+    m_shaderSets.clear();
+    for (const ShaderTableEntry& entry : g_TriangleShaders)
     {
-        vsFile = "shaders/triangle_vs.dxil";
-        psFile = "shaders/triangle_ps.dxil";
+        common::ShaderCompileDesc desc;
+        desc.sourcePath = entry.sourcePath;
+        desc.entryPoint = entry.entryPoint;
+        desc.shaderType = entry.shaderType;
+        m_shaderSets.push_back(std::make_unique<common::ShaderPermutationSet>(*m_shaderLibrary, desc, entry.axes));
     }
-    else // Vulkan
+    
+    // Everything up front on worker threads, or only the variants actually requested
+    if (m_options.compileAllShaders)
     {
-        vsFile = "shaders/triangle_vs.spv";
-        psFile = "shaders/triangle_ps.spv";
+        auto start = std::chrono::steady_clock::now();
+        common::ThreadPool compilers;
+        uint32_t permutationCount = 0;
+        for (auto& shaderSet : m_shaderSets)
+        {
+            shaderSet->createAll(compilers);
+            permutationCount += shaderSet->getPermutationCount();
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Created " << permutationCount << " shader permutations on " << compilers.getThreadCount()
+                  << " threads in " << elapsedMs << " ms" << std::endl;
     }
     
-    std::vector<uint8_t> vsData = loadShaderFromFile(vsFile);
-    std::vector<uint8_t> psData = loadShaderFromFile(psFile);
+    const std::string shadeMode = std::to_string(m_options.shadeMode);
+    m_vertexShader = m_shaderSets[m_options.bindless ? TriangleBindlessVS : TriangleVS]->getShader(0);
+    m_pixelShader = m_shaderSets[TrianglePS]->getShader(
+        m_shaderSets[TrianglePS]->getKey({ { "SHADE_MODE", shadeMode } }));
     
-    if (vsData.empty() || psData.empty())
+    if (!m_vertexShader || !m_pixelShader)
     {
-        std::cerr << "Failed to load shader files. Please compile shaders first." << std::endl;
-        std::cerr << "Required files: " << vsFile << ", " << psFile << std::endl;
-        std::cerr << std::endl;
-        std::cerr << "For D3D12 (DXIL), run:" << std::endl;
-        std::cerr << "  slangc triangle.slang -profile sm_6_0 -target dxil -entry vsMain -stage vertex -o triangle_vs.dxil" << std::endl;
-        std::cerr << "  slangc triangle.slang -profile sm_6_0 -target dxil -entry psMain -stage fragment -o triangle_ps.dxil" << std::endl;
-        std::cerr << std::endl;
-        std::cerr << "For Vulkan (SPIR-V), run:" << std::endl;
-        std::cerr << "  slangc triangle.slang -profile glsl_450 -target spirv -entry vsMain -stage vertex -o triangle_vs.spv" << std::endl;
-        std::cerr << "  slangc triangle.slang -profile glsl_450 -target spirv -entry psMain -stage fragment -o triangle_ps.spv" << std::endl;
+        std::cerr << "Failed to load shaders. Is slangc installed and on the PATH?" << std::endl;
         return false;
     }
     
-    // Entry point names differ between D3D12 (keeps original name) and Vulkan (SPIR-V uses "main")
-    const char* vsEntryName = (m_deviceManager->getGraphicsAPI() == common::GraphicsAPI::Vulkan) ? "main" : "vsMain";
-    const char* psEntryName = (m_deviceManager->getGraphicsAPI() == common::GraphicsAPI::Vulkan) ? "main" : "psMain";
+    std::cout << "Shaders: " << m_shaderLibrary->getCompileCount() << " compiled, "
+              << m_shaderLibrary->getCacheHits() << " loaded from " << m_options.shaderCacheDirectory << std::endl;
     
-    // Create vertex shader
-    nvrhi::ShaderDesc vsDesc = {};
-    vsDesc.shaderType = nvrhi::ShaderType::Vertex;
-    vsDesc.debugName = "TriangleVS";
-    vsDesc.entryName = vsEntryName;
+    return true;
+}
+
+bool TriangleApp::createPipeline()
+{
+    m_pipelineCache = std::make_unique<common::PipelineCache>(*m_deviceManager);
     
-    m_vertexShader = m_deviceManager->getDevice()->createShader(vsDesc, vsData.data(), vsData.size());
-    if (!m_vertexShader)
-    {
-        std::cerr << "Failed to create vertex shader" << std::endl;
+    // The bindless vertex shader loads its vertices itself
+    if (!m_options.bindless && !createInputLayout())
         return false;
-    }
-    
-    // Create pixel shader
-    nvrhi::ShaderDesc psDesc = {};
-    psDesc.shaderType = nvrhi::ShaderType::Pixel;
-    psDesc.debugName = "TrianglePS";
-    psDesc.entryName = psEntryName;
     
-    m_pixelShader = m_deviceManager->getDevice()->createShader(psDesc, psData.data(), psData.size());
-    if (!m_pixelShader)
+    // Build the other shading modes' pipelines in the background so switching is a hit
+    if (m_options.compileAllShaders)
     {
-        std::cerr << "Failed to create pixel shader" << std::endl;
-        return false;
+        m_prewarmThreads = std::make_unique<common::ThreadPool>();
+        common::ShaderPermutationSet& pixelShaders = *m_shaderSets[TrianglePS];
+        for (uint32_t key = 0; key < pixelShaders.getPermutationCount(); key++)
+        {
+            if (nvrhi::ShaderHandle pixelShader = pixelShaders.getShader(key))
+                m_pipelineCache->prewarm(*m_prewarmThreads, makePipelineDesc(pixelShader), getFramebufferInfo());
+        }
     }
     
-    return true;
+    return setShadeMode(m_shadeMode);
 }
 
-bool TriangleApp::createPipeline()
+bool TriangleApp::createInputLayout()
 {
     // Define input layout matching vertex structure
     std::array<nvrhi::VertexAttributeDesc, 2> vertexAttributes = {{
@@ -278,29 +425,61 @@ bool TriangleApp::createPipeline()
         return false;
     }
     
-    // Create graphics pipeline
+    return true;
+}
+
+nvrhi::GraphicsPipelineDesc TriangleApp::makePipelineDesc(nvrhi::IShader* pixelShader) const
+{
     nvrhi::GraphicsPipelineDesc pipelineDesc = {};
     pipelineDesc.inputLayout = m_inputLayout;
     pipelineDesc.VS = m_vertexShader;
-    pipelineDesc.PS = m_pixelShader;
+    pipelineDesc.PS = pixelShader;
     pipelineDesc.primType = nvrhi::PrimitiveType::TriangleList;
     
+    // Push constants at b0, the bindless table as the second layout (set 1 on Vulkan)
+    if (m_bindlessTable)
+    {
+        pipelineDesc.bindingLayouts = { m_bindlessConstantsLayout, m_bindlessTable->getLayout() };
+    }
+    
     // Configure render state
     pipelineDesc.renderState.depthStencilState.depthTestEnable = false;
     pipelineDesc.renderState.depthStencilState.depthWriteEnable = false;
     pipelineDesc.renderState.rasterState.cullMode = nvrhi::RasterCullMode::None;
     
-    // Use framebuffer info for pipeline creation
+    return pipelineDesc;
+}
+
+nvrhi::FramebufferInfo TriangleApp::getFramebufferInfo() const
+{
     nvrhi::FramebufferInfo fbInfo;
     fbInfo.addColorFormat(m_deviceManager->getSwapChainFormat());
+    return fbInfo;
+}
+
+bool TriangleApp::setShadeMode(uint32_t shadeMode)
+{
+    common::ShaderPermutationSet& pixelShaders = *m_shaderSets[TrianglePS];
+    nvrhi::ShaderHandle pixelShader = pixelShaders.getShader(
+        pixelShaders.getKey({ { "SHADE_MODE", std::to_string(shadeMode) } }));
+    if (!pixelShader)
+    {
+        std::cerr << "Failed to load pixel shader for shade mode " << shadeMode << std::endl;
+        return false;
+    }
     
-    m_pipeline = m_deviceManager->getDevice()->createGraphicsPipeline(pipelineDesc, fbInfo);
-    if (!m_pipeline)
+    // Identical states come back from the cache instead of being rebuilt
+    nvrhi::GraphicsPipelineHandle pipeline = m_pipelineCache->getGraphicsPipeline(
+        makePipelineDesc(pixelShader), getFramebufferInfo());
+    if (!pipeline)
     {
         std::cerr << "Failed to create graphics pipeline" << std::endl;
         return false;
     }
     
+    m_pixelShader = pixelShader;
+    m_pipeline = pipeline;
+    m_shadeMode = shadeMode;
     return true;
 }
 
@@ -310,209 +489,1771 @@ bool TriangleApp::createVertexBuffer()
     nvrhi::BufferDesc bufferDesc = {};
     bufferDesc.byteSize = sizeof(Vertex) * g_TriangleVertices.size();
     bufferDesc.isVertexBuffer = true;
+    bufferDesc.canHaveRawViews = true;  // Read by vsBindless in bindless mode
     bufferDesc.initialState = nvrhi::ResourceStates::VertexBuffer;
     bufferDesc.keepInitialState = true;
     bufferDesc.debugName = "TriangleVertexBuffer";
     
-    m_vertexBuffer = m_deviceManager->getDevice()->createBuffer(bufferDesc);
+    // Placed in a shared heap rather than a dedicated allocation of its own
+    m_vertexBuffer = m_resourceAllocator->createBuffer(bufferDesc);
     if (!m_vertexBuffer)
     {
         std::cerr << "Failed to create vertex buffer" << std::endl;
         return false;
     }
     
-    // Upload vertex data
+    if (m_bindlessTable)
+    {
+        m_vertexBufferIndex = m_bindlessTable->addBuffer(m_vertexBuffer);
+        if (m_vertexBufferIndex == common::BindlessTable::InvalidIndex)
+            return false;
+    }
+    
+    // Upload vertex data through the ring; the copy retires with the first frame,
+    // so there is no need to wait for the GPU here
+    common::UploadRing::Allocation upload = m_uploadRing->upload(g_TriangleVertices.data(), bufferDesc.byteSize);
+    if (!upload)
+        return false;
+    
     m_commandList->open();
-    m_commandList->writeBuffer(m_vertexBuffer, g_TriangleVertices.data(), bufferDesc.byteSize);
+    m_commandList->copyBuffer(m_vertexBuffer, 0, upload.buffer, upload.offset, bufferDesc.byteSize);
     m_commandList->close();
     
     m_deviceManager->executeCommandList(m_commandList);
-    m_deviceManager->waitForIdle();
     
     return true;
 }
 
-void TriangleApp::onResize(int width, int height)
+bool TriangleApp::createBindlessResources()
 {
-    if (width == 0 || height == 0)
-        return;
+    m_bindlessTable = std::make_unique<common::BindlessTable>(*m_deviceManager);
+    if (!m_bindlessTable->isValid())
+        return false;
     
-    m_deviceManager->resizeSwapChain(width, height);
-}
-
-void TriangleApp::render()
-{
-    // Handle window resize
-    if (m_windowResized)
+    nvrhi::BindingLayoutDesc layoutDesc;
+    layoutDesc.setVisibility(nvrhi::ShaderType::Vertex)
+        .addItem(nvrhi::BindingLayoutItem::PushConstants(0, sizeof(BindlessConstants)));
+    m_bindlessConstantsLayout = m_deviceManager->getDevice()->createBindingLayout(layoutDesc);
+    if (!m_bindlessConstantsLayout)
     {
-        onResize(m_windowWidth, m_windowHeight);
-        m_windowResized = false;
+        std::cerr << "Failed to create bindless constants layout" << std::endl;
+        return false;
     }
     
-    // Skip rendering if window is minimized
-    if (m_windowWidth == 0 || m_windowHeight == 0)
-        return;
-    
-    // Begin frame (acquires next swap chain image)
-    m_deviceManager->beginFrame();
-    
-    // Begin recording commands
-    m_commandList->open();
-    
-    // Clear render target to dark blue
-    nvrhi::utils::ClearColorAttachment(m_commandList, m_deviceManager->getCurrentFramebuffer(), 0,
-        nvrhi::Color(0.1f, 0.1f, 0.2f, 1.0f));
-    
-    // Set up graphics state
-    nvrhi::GraphicsState state = {};
-    state.pipeline = m_pipeline;
-    state.framebuffer = m_deviceManager->getCurrentFramebuffer();
-    state.viewport.addViewportAndScissorRect(nvrhi::Viewport(
-        static_cast<float>(m_deviceManager->getWindowWidth()),
-        static_cast<float>(m_deviceManager->getWindowHeight())));
-    state.addVertexBuffer(nvrhi::VertexBufferBinding()
-        .setBuffer(m_vertexBuffer)
-        .setSlot(0)
-        .setOffset(0));
-    
-    m_commandList->setGraphicsState(state);
-    
-    // Draw triangle
-    nvrhi::DrawArguments drawArgs = {};
-    drawArgs.vertexCount = static_cast<uint32_t>(g_TriangleVertices.size());
-    m_commandList->draw(drawArgs);
-    
-    // End recording
-    m_commandList->close();
-    
-    // Execute command list
-    m_deviceManager->executeCommandList(m_commandList);
+    // One binding set for every draw; only the push constants change between them
+    nvrhi::BindingSetDesc setDesc;
+    setDesc.addItem(nvrhi::BindingSetItem::PushConstants(0, sizeof(BindlessConstants)));
+    m_bindlessConstantsSet = m_deviceManager->getDevice()->createBindingSet(setDesc, m_bindlessConstantsLayout);
+    if (!m_bindlessConstantsSet)
+    {
+        std::cerr << "Failed to create bindless constants binding set" << std::endl;
+        return false;
+    }
     
-    // Present
-    m_deviceManager->present();
+    return true;
 }
 
-void TriangleApp::updateWindowTitle()
+bool TriangleApp::createInstancingResources(uint32_t instanceCount)
 {
-    double currentTime = glfwGetTime();
-    m_frameCount++;
+    if (m_instanceBuffer && m_instanceCapacity >= instanceCount)
+        return true;
     
-    // Update FPS every 0.5 seconds
-    double elapsed = currentTime - m_lastTitleUpdateTime;
-    if (elapsed >= 0.5)
+    nvrhi::IDevice* device = m_deviceManager->getDevice();
+    
+    // Pipelines and the argument buffer do not depend on the instance count
+    if (!m_instancedPipeline)
     {
-        m_fps = m_frameCount / elapsed;
-        m_frameCount = 0;
-        m_lastTitleUpdateTime = currentTime;
+        nvrhi::ShaderHandle vertexShader = m_shaderSets[InstancedVS]->getShader(0);
+        nvrhi::ShaderHandle computeShader = m_shaderSets[WriteDrawArgsCS]->getShader(0);
+        if (!vertexShader || !computeShader)
+        {
+            std::cerr << "Failed to load instancing shaders" << std::endl;
+            return false;
+        }
         
-        // Build window title with API and FPS
-        std::ostringstream title;
-        title << "["  << m_deviceManager->getGraphicsAPIName() << "] "
-              << "NVRHI Triangle Demo - "
-              << std::fixed << std::setprecision(1) << m_fps << " FPS";
+        // Bindless mode draws without an input layout, so it has none yet
+        if (!m_inputLayout && !createInputLayout())
+            return false;
         
-        glfwSetWindowTitle(m_window, title.str().c_str());
+        nvrhi::BindingLayoutDesc layoutDesc;
+        layoutDesc.setVisibility(nvrhi::ShaderType::Vertex)
+            .addItem(nvrhi::BindingLayoutItem::PushConstants(0, sizeof(InstancingConstants)))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(0));
+        m_instancingLayout = device->createBindingLayout(layoutDesc);
+        
+        nvrhi::BindingLayoutDesc drawArgsLayoutDesc;
+        drawArgsLayoutDesc.setVisibility(nvrhi::ShaderType::Compute)
+            .addItem(nvrhi::BindingLayoutItem::PushConstants(0, sizeof(InstancingConstants)))
+            .addItem(nvrhi::BindingLayoutItem::RawBuffer_UAV(0));
+        m_drawArgsLayout = device->createBindingLayout(drawArgsLayoutDesc);
+        
+        if (!m_instancingLayout || !m_drawArgsLayout)
+        {
+            std::cerr << "Failed to create instancing binding layouts" << std::endl;
+            return false;
+        }
+        
+        nvrhi::GraphicsPipelineDesc pipelineDesc = makePipelineDesc(m_pixelShader);
+        pipelineDesc.inputLayout = m_inputLayout;
+        pipelineDesc.VS = vertexShader;
+        pipelineDesc.bindingLayouts = { m_instancingLayout };
+        m_instancedPipeline = m_pipelineCache->getGraphicsPipeline(pipelineDesc, getFramebufferInfo());
+        
+        nvrhi::ComputePipelineDesc computeDesc;
+        computeDesc.CS = computeShader;
+        computeDesc.bindingLayouts = { m_drawArgsLayout };
+        m_drawArgsPipeline = device->createComputePipeline(computeDesc);
+        
+        if (!m_instancedPipeline || !m_drawArgsPipeline)
+        {
+            std::cerr << "Failed to create instancing pipelines" << std::endl;
+            return false;
+        }
+        
+        // One draw's arguments; keepInitialState returns the buffer to UAV after each
+        // command list, so the compute pass can write it again next frame
+        nvrhi::BufferDesc argsDesc = {};
+        argsDesc.byteSize = sizeof(uint32_t) * 4;
+        argsDesc.isDrawIndirectArgs = true;
+        argsDesc.canHaveUAVs = true;
+        argsDesc.canHaveRawViews = true;
+        argsDesc.initialState = nvrhi::ResourceStates::UnorderedAccess;
+        argsDesc.keepInitialState = true;
+        argsDesc.debugName = "DrawArgsBuffer";
+        m_drawArgsBuffer = m_resourceAllocator->createBuffer(argsDesc);
+        if (!m_drawArgsBuffer)
+        {
+            std::cerr << "Failed to create draw arguments buffer" << std::endl;
+            return false;
+        }
+        
+        nvrhi::BindingSetDesc setDesc;
+        setDesc.addItem(nvrhi::BindingSetItem::PushConstants(0, sizeof(InstancingConstants)))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_UAV(0, m_drawArgsBuffer));
+        m_drawArgsSet = device->createBindingSet(setDesc, m_drawArgsLayout);
+        if (!m_drawArgsSet)
+        {
+            std::cerr << "Failed to create draw arguments binding set" << std::endl;
+            return false;
+        }
     }
-}
-
-void TriangleApp::mainLoop()
-{
-    // Initialize timing
-    m_lastTime = glfwGetTime();
-    m_lastTitleUpdateTime = m_lastTime;
-    m_frameCount = 0;
     
-    while (!glfwWindowShouldClose(m_window))
+    std::vector<InstanceData> instances = createInstanceGrid(instanceCount);
+    
+    nvrhi::BufferDesc bufferDesc = {};
+    bufferDesc.byteSize = sizeof(InstanceData) * instanceCount;
+    bufferDesc.structStride = sizeof(InstanceData);
+    bufferDesc.initialState = m_uploadService->getBufferState();
+    bufferDesc.keepInitialState = true;
+    bufferDesc.debugName = "InstanceBuffer";
+    
+    // Frames still reading a smaller buffer retire before its range is reused
+    if (m_instanceBuffer)
     {
-        if(glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-            glfwSetWindowShouldClose(m_window, true);
-        glfwPollEvents();
-        render();
-        updateWindowTitle();
+        m_resourceAllocator->release(m_instanceBuffer);
+        m_instanceBuffer = nullptr;
+        m_instancingSet = nullptr;
+        m_culling.cullingSet = nullptr;
+        m_culling.drawSet = nullptr;
+        m_instanceCapacity = 0;
     }
     
-    // Wait for GPU before cleanup
-    m_deviceManager->waitForIdle();
-}
-
-void TriangleApp::cleanup()
-{
-    // Release pipeline resources
-    m_vertexBuffer = nullptr;
-    m_pipeline = nullptr;
-    m_inputLayout = nullptr;
-    m_pixelShader = nullptr;
-    m_vertexShader = nullptr;
-    m_commandList = nullptr;
+    nvrhi::BufferHandle instanceBuffer = m_resourceAllocator->createBuffer(bufferDesc);
+    if (!instanceBuffer)
+    {
+        std::cerr << "Failed to create instance buffer for " << instanceCount << " instances" << std::endl;
+        return false;
+    }
     
-    // Destroy device manager
-    if (m_deviceManager)
+    nvrhi::BindingSetDesc setDesc;
+    setDesc.addItem(nvrhi::BindingSetItem::PushConstants(0, sizeof(InstancingConstants)))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(0, instanceBuffer));
+    m_instancingSet = device->createBindingSet(setDesc, m_instancingLayout);
+    if (!m_instancingSet)
     {
-        m_deviceManager->destroyDevice();
-        m_deviceManager.reset();
+        std::cerr << "Failed to create instancing binding set" << std::endl;
+        m_resourceAllocator->release(instanceBuffer);
+        return false;
     }
     
-    // Cleanup GLFW
-    if (m_window)
+    // Setup rather than a frame, so wait for the copy instead of tracking its ticket
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(instances.data());
+    if (m_uploadService->uploadBuffer(instanceBuffer, std::vector<uint8_t>(bytes, bytes + bufferDesc.byteSize)) == 0)
     {
-        glfwDestroyWindow(m_window);
-        m_window = nullptr;
+        std::cerr << "Failed to upload instance data" << std::endl;
+        m_instancingSet = nullptr;
+        m_resourceAllocator->release(instanceBuffer);
+        return false;
     }
-    glfwTerminate();
+    m_uploadService->flush();
+    
+    m_instanceBuffer = instanceBuffer;
+    m_instanceCapacity = instanceCount;
+    return true;
 }
 
-// Parse command line arguments to select graphics API
-common::GraphicsAPI parseCommandLine(int argc, char* argv[])
+bool TriangleApp::createCullingResources(uint32_t instanceCount)
 {
-    // Default to D3D12 on Windows, Vulkan otherwise
-#ifdef _WIN32
-    common::GraphicsAPI defaultAPI = common::GraphicsAPI::D3D12;
-#else
-    common::GraphicsAPI defaultAPI = common::GraphicsAPI::Vulkan;
-#endif
+    CullingResources& culling = m_culling;
+    nvrhi::IDevice* device = m_deviceManager->getDevice();
     
-    for (int i = 1; i < argc; i++)
+    // Pipelines and buffers that depend on neither the instance count nor the window size
+    if (!culling.pipeline)
     {
-        std::string arg = argv[i];
-        if (arg == "-d3d12" || arg == "--d3d12" || arg == "-dx12")
+        nvrhi::ShaderHandle vertexShader = m_shaderSets[CulledVS]->getShader(0);
+        nvrhi::ShaderHandle cullingShader = m_shaderSets[CullInstancesCS]->getShader(0);
+        nvrhi::ShaderHandle hiZShader = m_shaderSets[BuildHiZCS]->getShader(0);
+        if (!vertexShader || !cullingShader || !hiZShader)
         {
-            return common::GraphicsAPI::D3D12;
+            std::cerr << "Failed to load culling shaders" << std::endl;
+            return false;
         }
-        else if (arg == "-vulkan" || arg == "--vulkan" || arg == "-vk")
+        
+        nvrhi::BindingLayoutDesc cullingLayoutDesc;
+        cullingLayoutDesc.setVisibility(nvrhi::ShaderType::Compute)
+            .addItem(nvrhi::BindingLayoutItem::VolatileConstantBuffer(0))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(0))
+            .addItem(nvrhi::BindingLayoutItem::Texture_SRV(2))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_UAV(0))
+            .addItem(nvrhi::BindingLayoutItem::RawBuffer_UAV(1));
+        culling.cullingLayout = device->createBindingLayout(cullingLayoutDesc);
+        
+        nvrhi::BindingLayoutDesc drawLayoutDesc;
+        drawLayoutDesc.setVisibility(nvrhi::ShaderType::Vertex)
+            .addItem(nvrhi::BindingLayoutItem::VolatileConstantBuffer(0))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(0))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(1));
+        culling.drawLayout = device->createBindingLayout(drawLayoutDesc);
+        
+        nvrhi::BindingLayoutDesc hiZLayoutDesc;
+        hiZLayoutDesc.setVisibility(nvrhi::ShaderType::Compute)
+            .addItem(nvrhi::BindingLayoutItem::PushConstants(1, sizeof(HiZConstants)))
+            .addItem(nvrhi::BindingLayoutItem::Texture_SRV(3))
+            .addItem(nvrhi::BindingLayoutItem::Texture_UAV(2));
+        culling.hiZLayout = device->createBindingLayout(hiZLayoutDesc);
+        
+        if (!culling.cullingLayout || !culling.drawLayout || !culling.hiZLayout)
         {
-            return common::GraphicsAPI::Vulkan;
+            std::cerr << "Failed to create culling binding layouts" << std::endl;
+            return false;
+        }
+        
+        nvrhi::ComputePipelineDesc cullingDesc;
+        cullingDesc.CS = cullingShader;
+        cullingDesc.bindingLayouts = { culling.cullingLayout };
+        culling.cullingPipeline = device->createComputePipeline(cullingDesc);
+        
+        nvrhi::ComputePipelineDesc hiZDesc;
+        hiZDesc.CS = hiZShader;
+        hiZDesc.bindingLayouts = { culling.hiZLayout };
+        culling.hiZPipeline = device->createComputePipeline(hiZDesc);
+        
+        nvrhi::GraphicsPipelineDesc pipelineDesc = makePipelineDesc(m_pixelShader);
+        pipelineDesc.inputLayout = m_inputLayout;
+        pipelineDesc.VS = vertexShader;
+        pipelineDesc.bindingLayouts = { culling.drawLayout };
+        pipelineDesc.renderState.depthStencilState.depthTestEnable = true;
+        pipelineDesc.renderState.depthStencilState.depthWriteEnable = true;
+        pipelineDesc.renderState.depthStencilState.depthFunc = nvrhi::ComparisonFunc::Less;
+        nvrhi::FramebufferInfo fbInfo = getFramebufferInfo();
+        fbInfo.setDepthFormat(nvrhi::Format::D32);
+        culling.pipeline = m_pipelineCache->getGraphicsPipeline(pipelineDesc, fbInfo);
+        
+        if (!culling.cullingPipeline || !culling.hiZPipeline || !culling.pipeline)
+        {
+            std::cerr << "Failed to create culling pipelines" << std::endl;
+            culling.pipeline = nullptr;
+            return false;
+        }
+        
+        culling.constantBuffer = device->createBuffer(nvrhi::utils::CreateVolatileConstantBufferDesc(
+            sizeof(CullingConstants), "CullingConstants", 16));
+        
+        nvrhi::BufferDesc readbackDesc = {};
+        readbackDesc.byteSize = sizeof(uint32_t) * 8;
+        readbackDesc.cpuAccess = nvrhi::CpuAccessMode::Read;
+        readbackDesc.initialState = nvrhi::ResourceStates::CopyDest;
+        readbackDesc.keepInitialState = true;
+        readbackDesc.debugName = "CullingReadback";
+        culling.readbackBuffer = device->createBuffer(readbackDesc);
+        
+        if (!culling.constantBuffer || !culling.readbackBuffer)
+        {
+            std::cerr << "Failed to create culling buffers" << std::endl;
+            culling.pipeline = nullptr;
+            return false;
+        }
+    }
+    
+    if (culling.instanceCapacity < instanceCount)
+    {
+        if (culling.visibleInstanceBuffer)
+        {
+            m_resourceAllocator->release(culling.visibleInstanceBuffer);
+            culling.visibleInstanceBuffer = nullptr;
+            culling.instanceCapacity = 0;
+        }
+        
+        nvrhi::BufferDesc bufferDesc = {};
+        bufferDesc.byteSize = sizeof(uint32_t) * instanceCount;
+        bufferDesc.structStride = sizeof(uint32_t);
+        bufferDesc.canHaveUAVs = true;
+        bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+        bufferDesc.keepInitialState = true;
+        bufferDesc.debugName = "VisibleInstanceBuffer";
+        culling.visibleInstanceBuffer = m_resourceAllocator->createBuffer(bufferDesc);
+        if (!culling.visibleInstanceBuffer)
+        {
+            std::cerr << "Failed to create visible instance buffer for " << instanceCount << " instances" << std::endl;
+            return false;
+        }
+        
+        culling.instanceCapacity = instanceCount;
+        culling.cullingSet = nullptr;
+        culling.drawSet = nullptr;
+    }
+    
+    // Depth and its pyramid follow the window size; a new pyramid holds no depth yet
+    uint32_t width = m_deviceManager->getWindowWidth();
+    uint32_t height = m_deviceManager->getWindowHeight();
+    if (!culling.depthTexture || culling.depthTexture->getDesc().width != width ||
+        culling.depthTexture->getDesc().height != height)
+    {
+        if (culling.depthTexture)
+        {
+            m_resourceAllocator->release(culling.depthTexture);
+            m_resourceAllocator->release(culling.hiZTexture);
+            culling.depthTexture = nullptr;
+            culling.hiZTexture = nullptr;
+        }
+        culling.hiZSets.clear();
+        culling.framebuffers.clear();
+        culling.cullingSet = nullptr;
+        culling.hiZValid = false;
+        
+        nvrhi::TextureDesc depthDesc = {};
+        depthDesc.width = width;
+        depthDesc.height = height;
+        depthDesc.format = nvrhi::Format::D32;
+        depthDesc.isRenderTarget = true;
+        depthDesc.isTypeless = true;
+        depthDesc.initialState = nvrhi::ResourceStates::DepthWrite;
+        depthDesc.keepInitialState = true;
+        depthDesc.debugName = "DepthBuffer";
+        
+        nvrhi::TextureDesc hiZDesc = {};
+        hiZDesc.width = width;
+        hiZDesc.height = height;
+        hiZDesc.mipLevels = static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+        hiZDesc.format = nvrhi::Format::R32_FLOAT;
+        hiZDesc.isUAV = true;
+        hiZDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+        hiZDesc.keepInitialState = true;
+        hiZDesc.debugName = "HiZ";
+        
+        culling.depthTexture = m_resourceAllocator->createTexture(depthDesc);
+        culling.hiZTexture = m_resourceAllocator->createTexture(hiZDesc);
+        if (!culling.depthTexture || !culling.hiZTexture)
+        {
+            std::cerr << "Failed to create " << width << "x" << height << " depth and HiZ textures" << std::endl;
+            culling.depthTexture = nullptr;
+            culling.hiZTexture = nullptr;
+            return false;
+        }
+        
+        // Level 0 reads the depth buffer, every other level the one below it
+        for (uint32_t mip = 0; mip < hiZDesc.mipLevels; mip++)
+        {
+            nvrhi::BindingSetDesc setDesc;
+            setDesc.addItem(nvrhi::BindingSetItem::PushConstants(1, sizeof(HiZConstants)))
+                .addItem(mip == 0
+                    ? nvrhi::BindingSetItem::Texture_SRV(3, culling.depthTexture)
+                    : nvrhi::BindingSetItem::Texture_SRV(3, culling.hiZTexture, nvrhi::Format::UNKNOWN,
+                        nvrhi::TextureSubresourceSet(mip - 1, 1, 0, 1)))
+                .addItem(nvrhi::BindingSetItem::Texture_UAV(2, culling.hiZTexture, nvrhi::Format::UNKNOWN,
+                    nvrhi::TextureSubresourceSet(mip, 1, 0, 1)));
+            nvrhi::BindingSetHandle hiZSet = device->createBindingSet(setDesc, culling.hiZLayout);
+            if (!hiZSet)
+            {
+                std::cerr << "Failed to create HiZ binding set for mip " << mip << std::endl;
+                culling.hiZSets.clear();
+                return false;
+            }
+            culling.hiZSets.push_back(hiZSet);
+        }
+    }
+    
+    if (!culling.cullingSet)
+    {
+        nvrhi::BindingSetDesc setDesc;
+        setDesc.addItem(nvrhi::BindingSetItem::ConstantBuffer(0, culling.constantBuffer))
+            .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(0, m_instanceBuffer))
+            .addItem(nvrhi::BindingSetItem::Texture_SRV(2, culling.hiZTexture))
+            .addItem(nvrhi::BindingSetItem::StructuredBuffer_UAV(0, culling.visibleInstanceBuffer))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_UAV(1, m_drawArgsBuffer));
+        culling.cullingSet = device->createBindingSet(setDesc, culling.cullingLayout);
+    }
+    if (!culling.drawSet)
+    {
+        nvrhi::BindingSetDesc setDesc;
+        setDesc.addItem(nvrhi::BindingSetItem::ConstantBuffer(0, culling.constantBuffer))
+            .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(0, m_instanceBuffer))
+            .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(1, culling.visibleInstanceBuffer));
+        culling.drawSet = device->createBindingSet(setDesc, culling.drawLayout);
+    }
+    if (!culling.cullingSet || !culling.drawSet)
+    {
+        std::cerr << "Failed to create culling binding sets" << std::endl;
+        culling.cullingSet = nullptr;
+        culling.drawSet = nullptr;
+        return false;
+    }
+    
+    return true;
+}
+
+void TriangleApp::onResize(int width, int height)
+{
+    if (width == 0 || height == 0)
+        return;
+    
+    // Without back buffers there is nothing left to render to
+    if (!m_deviceManager->resizeSwapChain(width, height))
+    {
+        std::cerr << "Failed to resize the swap chain to " << width << "x" << height << ", closing" << std::endl;
+        glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+        return;
+    }
+    m_resizeCount++;
+}
+
+bool TriangleApp::beginFrame()
+{
+    // Handle window resize
+    if (m_windowResized)
+    {
+        onResize(m_windowWidth, m_windowHeight);
+        m_windowResized = false;
+    }
+    if (!m_deviceManager->getCurrentFramebuffer())
+        return false;
+    
+    // Skip rendering if window is minimized
+    if (m_windowWidth == 0 || m_windowHeight == 0)
+        return false;
+    
+    // Begin frame (acquires next swap chain image); a lost device that could not be
+    // recreated yet is retried next frame
+    m_deviceManager->beginFrame();
+    return !m_deviceManager->isDeviceLost();
+}
+
+void TriangleApp::render()
+{
+    if (!beginFrame())
+        return;
+    
+    // Background uploads are submitted and retired between frames
+    m_uploadService->update();
+    m_resourceAllocator->update();
+    if (m_bindlessTable)
+        m_bindlessTable->update();
+    
+    // Pipelines built on the render thread since the last frame show up as hitches
+    common::PipelineCache::Stats pipelineStats = m_pipelineCache->takeFrameStats();
+    if (pipelineStats.misses > 0)
+    {
+        std::cout << "Frame " << m_deviceManager->getFrameTracker().getCurrentFrameId() << ": "
+                  << pipelineStats.misses << " pipeline cache miss(es), "
+                  << pipelineStats.missTimeMs << " ms" << std::endl;
+    }
+    
+    // Begin recording commands
+    m_commandList->open();
+    
+    nvrhi::VertexBufferBinding vertexBuffer = nvrhi::VertexBufferBinding()
+        .setBuffer(m_vertexBuffer)
+        .setSlot(0)
+        .setOffset(0);
+    
+    // Per-frame vertex data is a pointer bump in the ring, read in place by the GPU
+    if (m_options.animate)
+    {
+        float angle = float(m_deviceManager->getFrameTracker().getCurrentFrameId()) * 0.01f;
+        float cosAngle = std::cos(angle);
+        float sinAngle = std::sin(angle);
+        
+        std::array<Vertex, 3> vertices = g_TriangleVertices;
+        for (Vertex& vertex : vertices)
+        {
+            float x = vertex.position[0];
+            float y = vertex.position[1];
+            vertex.position[0] = x * cosAngle - y * sinAngle;
+            vertex.position[1] = x * sinAngle + y * cosAngle;
+        }
+        
+        common::UploadRing::Allocation upload = m_uploadRing->upload(vertices.data(), sizeof(vertices));
+        if (upload)
+        {
+            vertexBuffer.setBuffer(upload.buffer).setOffset(upload.offset);
+        }
+    }
+    
+    // One pass per window, drawing into its back buffer; the graph batches the transitions
+    m_renderGraph.clear();
+    auto addWindowPass = [&](std::string name, nvrhi::ITexture* backBuffer, nvrhi::IFramebuffer* framebuffer,
+        uint32_t width, uint32_t height, const nvrhi::Color& clearColor)
+    {
+        nvrhi::ResourceStates presentState = backBuffer->getDesc().initialState;
+        common::RenderGraph::ResourceId target = m_renderGraph.importTexture(backBuffer, presentState, presentState);
+        common::RenderGraph::PassId pass = m_renderGraph.addPass(std::move(name),
+            [this, framebuffer, width, height, clearColor, vertexBuffer](nvrhi::ICommandList*, const common::RenderGraph&)
+            {
+                drawTriangle(framebuffer, width, height, clearColor, vertexBuffer);
+            });
+        m_renderGraph.write(pass, target, nvrhi::ResourceStates::RenderTarget);
+    };
+    
+    // Primary window on dark blue, extra windows on dark red. The primary window is skipped
+    // like the others when it has no back buffer this frame (e.g. a failed recreation).
+    if (m_deviceManager->isBackBufferAcquired() && m_deviceManager->getCurrentBackBuffer())
+    {
+        addWindowPass("Triangle", m_deviceManager->getCurrentBackBuffer(), m_deviceManager->getCurrentFramebuffer(),
+            m_deviceManager->getWindowWidth(), m_deviceManager->getWindowHeight(), nvrhi::Color(0.1f, 0.1f, 0.2f, 1.0f));
+    }
+    
+    // Extra windows share the command list; one that could not acquire this frame is skipped
+    for (size_t i = 0; i < m_extraWindows.size(); i++)
+    {
+        common::ISwapChain* swapChain = m_extraWindows[i].swapChain;
+        if (swapChain->isAcquired())
+        {
+            addWindowPass("Triangle.Window" + std::to_string(i + 1), swapChain->getCurrentBackBuffer(),
+                swapChain->getCurrentFramebuffer(), swapChain->getWidth(), swapChain->getHeight(),
+                nvrhi::Color(0.2f, 0.1f, 0.1f, 1.0f));
+        }
+    }
+    
+    if (m_renderGraph.compile(m_transientTextures->getRequirementsCallback()) &&
+        m_transientTextures->realize(m_renderGraph))
+    {
+        m_renderGraph.execute(m_commandList);
+    }
+    
+    // End recording
+    m_commandList->close();
+    
+    // Execute command list
+    m_deviceManager->executeCommandList(m_commandList);
+    
+    // Fault injection: the next present reports a lost device
+    if (m_options.deviceLostInterval > 0 &&
+        m_deviceManager->getFrameTracker().getCurrentFrameId() % m_options.deviceLostInterval == 0)
+    {
+        m_deviceManager->simulateDeviceLost();
+    }
+    
+    // Present
+    m_deviceManager->present();
+}
+
+void TriangleApp::drawTriangle(nvrhi::IFramebuffer* framebuffer, uint32_t width, uint32_t height,
+    const nvrhi::Color& clearColor, const nvrhi::VertexBufferBinding& vertexBuffer)
+{
+    nvrhi::utils::ClearColorAttachment(m_commandList, framebuffer, 0, clearColor);
+    
+    // Set up graphics state
+    nvrhi::GraphicsState state = {};
+    state.pipeline = m_pipeline;
+    state.framebuffer = framebuffer;
+    state.viewport.addViewportAndScissorRect(nvrhi::Viewport(static_cast<float>(width), static_cast<float>(height)));
+    if (m_bindlessTable)
+    {
+        state.bindings = { m_bindlessConstantsSet, m_bindlessTable->getDescriptorTable() };
+    }
+    else
+    {
+        state.addVertexBuffer(vertexBuffer);
+    }
+    m_commandList->setGraphicsState(state);
+    
+    // The same vertex data through the table: the ring for animated vertices, or the static buffer
+    if (m_bindlessTable)
+    {
+        BindlessConstants constants = {};
+        constants.vertexBufferIndex = vertexBuffer.buffer == m_uploadRing->getBuffer() ? m_uploadRingIndex : m_vertexBufferIndex;
+        constants.vertexOffset = static_cast<uint32_t>(vertexBuffer.offset);
+        m_commandList->setPushConstants(&constants, sizeof(constants));
+    }
+    
+    // Draw triangle
+    nvrhi::DrawArguments drawArgs = {};
+    drawArgs.vertexCount = static_cast<uint32_t>(g_TriangleVertices.size());
+    m_commandList->draw(drawArgs);
+}
+
+double TriangleApp::renderMultithreaded(common::ThreadPool& workers, uint32_t jobCount, uint32_t drawCount)
+{
+    if (!beginFrame())
+        return 0.0;
+    
+    auto recordStart = std::chrono::steady_clock::now();
+    
+    // Created here rather than with the device resources, and again after a device
+    // recovery dropped it. Lists from the previous frame were submitted, so they can be reopened.
+    if (!m_commandListPool)
+    {
+        m_commandListPool = std::make_unique<common::CommandListPool>(*m_deviceManager);
+    }
+    m_commandListPool->reset();
+    
+    // Slot 0 clears on the main thread; each job fills its own slot so the
+    // submission order does not depend on thread scheduling
+    std::vector<nvrhi::ICommandList*> commandLists(jobCount + 1, nullptr);
+    
+    m_commandList->open();
+    nvrhi::utils::ClearColorAttachment(m_commandList, m_deviceManager->getCurrentFramebuffer(), 0,
+        nvrhi::Color(0.1f, 0.1f, 0.2f, 1.0f));
+    m_commandList->close();
+    commandLists[0] = m_commandList;
+    
+    nvrhi::GraphicsState state = {};
+    state.pipeline = m_pipeline;
+    state.framebuffer = m_deviceManager->getCurrentFramebuffer();
+    state.viewport.addViewportAndScissorRect(nvrhi::Viewport(
+        static_cast<float>(m_deviceManager->getWindowWidth()),
+        static_cast<float>(m_deviceManager->getWindowHeight())));
+    BindlessConstants constants = {};
+    if (m_bindlessTable)
+    {
+        state.bindings = { m_bindlessConstantsSet, m_bindlessTable->getDescriptorTable() };
+        constants.vertexBufferIndex = m_vertexBufferIndex;
+    }
+    else
+    {
+        state.addVertexBuffer(nvrhi::VertexBufferBinding()
+            .setBuffer(m_vertexBuffer)
+            .setSlot(0)
+            .setOffset(0));
+    }
+    
+    uint32_t drawsPerJob = (drawCount + jobCount - 1) / jobCount;
+    for (uint32_t job = 0; job < jobCount; job++)
+    {
+        workers.submit([this, &commandLists, &state, &constants, job, drawsPerJob, drawCount]()
+        {
+            nvrhi::ICommandList* commandList = m_commandListPool->acquire();
+            if (!commandList)
+                return;
+            
+            commandList->open();
+            commandList->setGraphicsState(state);
+            if (m_bindlessTable)
+                commandList->setPushConstants(&constants, sizeof(constants));
+            
+            nvrhi::DrawArguments drawArgs = {};
+            drawArgs.vertexCount = static_cast<uint32_t>(g_TriangleVertices.size());
+            
+            uint32_t lastDraw = std::min(drawCount, (job + 1) * drawsPerJob);
+            for (uint32_t draw = job * drawsPerJob; draw < lastDraw; draw++)
+            {
+                commandList->draw(drawArgs);
+            }
+            
+            commandList->close();
+            commandLists[job + 1] = commandList;
+        });
+    }
+    workers.waitIdle();
+    
+    double recordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+    
+    // All lists go to the queue in one submission
+    std::erase(commandLists, nullptr);
+    m_deviceManager->executeCommandLists(commandLists);
+    m_deviceManager->present();
+    
+    return recordTime;
+}
+
+double TriangleApp::renderInstanced(uint32_t instanceCount, InstancingMode mode)
+{
+    if (!beginFrame())
+        return 0.0;
+    
+    // Rebuilt here after a device loss or resize; the frame is still presented if that fails
+    bool ready = createInstancingResources(instanceCount) &&
+        (mode != InstancingMode::Culled || createCullingResources(instanceCount));
+    m_resourceAllocator->update();
+    
+    auto recordStart = std::chrono::steady_clock::now();
+    
+    m_commandList->open();
+    
+    if (ready && mode == InstancingMode::Culled)
+    {
+        recordCulledInstances(instanceCount);
+        m_commandList->close();
+        
+        double recordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+        
+        m_deviceManager->executeCommandList(m_commandList);
+        m_deviceManager->present();
+        
+        return recordTime;
+    }
+    
+    bool indirect = mode == InstancingMode::Indirect;
+    InstancingConstants constants = {};
+    constants.time = float(m_deviceManager->getFrameTracker().getCurrentFrameId()) * 0.01f;
+    constants.vertexCount = static_cast<uint32_t>(g_TriangleVertices.size());
+    constants.instanceCount = instanceCount;
+    
+    // The GPU writes the draw's arguments; NVRHI turns the UAV write into indirect
+    // arguments with a barrier when the graphics state binds the buffer
+    if (ready && indirect)
+    {
+        nvrhi::ComputeState computeState;
+        computeState.pipeline = m_drawArgsPipeline;
+        computeState.bindings = { m_drawArgsSet };
+        m_commandList->setComputeState(computeState);
+        m_commandList->setPushConstants(&constants, sizeof(constants));
+        m_commandList->dispatch(1);
+    }
+    
+    nvrhi::utils::ClearColorAttachment(m_commandList, m_deviceManager->getCurrentFramebuffer(), 0,
+        nvrhi::Color(0.1f, 0.1f, 0.2f, 1.0f));
+    
+    if (ready)
+    {
+        nvrhi::GraphicsState state = {};
+        state.pipeline = m_instancedPipeline;
+        state.framebuffer = m_deviceManager->getCurrentFramebuffer();
+        state.viewport.addViewportAndScissorRect(nvrhi::Viewport(
+            static_cast<float>(m_deviceManager->getWindowWidth()),
+            static_cast<float>(m_deviceManager->getWindowHeight())));
+        state.bindings = { m_instancingSet };
+        state.addVertexBuffer(nvrhi::VertexBufferBinding()
+            .setBuffer(m_vertexBuffer)
+            .setSlot(0)
+            .setOffset(0));
+        if (indirect)
+            state.indirectParams = m_drawArgsBuffer;
+        m_commandList->setGraphicsState(state);
+        
+        if (indirect)
+        {
+            m_commandList->setPushConstants(&constants, sizeof(constants));
+            m_commandList->drawIndirect(0);
+        }
+        else
+        {
+            // The baseline: a constants update and a draw for every instance
+            nvrhi::DrawArguments drawArgs = {};
+            drawArgs.vertexCount = constants.vertexCount;
+            for (uint32_t instance = 0; instance < instanceCount; instance++)
+            {
+                constants.instanceOffset = instance;
+                m_commandList->setPushConstants(&constants, sizeof(constants));
+                m_commandList->draw(drawArgs);
+            }
+        }
+    }
+    
+    m_commandList->close();
+    
+    double recordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+    
+    m_deviceManager->executeCommandList(m_commandList);
+    m_deviceManager->present();
+    
+    return recordTime;
+}
+
+void TriangleApp::recordCulledInstances(uint32_t instanceCount)
+{
+    CullingResources& culling = m_culling;
+    
+    // An orthographic camera panning over the instance grid at 1.5x zoom, so that
+    // instances leave the frustum; depth is the instances' z
+    float time = float(m_deviceManager->getFrameTracker().getCurrentFrameId()) * 0.01f;
+    float zoom = 1.5f;
+    float centerX = 0.5f * std::sin(time * 0.5f);
+    float centerY = 0.5f * std::cos(time * 0.35f);
+    const float viewProj[16] = {
+        zoom, 0.0f, 0.0f, -centerX * zoom,
+        0.0f, zoom, 0.0f, -centerY * zoom,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    float prevViewProj[16];
+    std::memcpy(prevViewProj, culling.hiZValid ? culling.view.viewProj : viewProj, sizeof(prevViewProj));
+    culling.view.setMatrices(viewProj, prevViewProj);
+    if (culling.framesSinceReset == 0)
+        culling.firstView = culling.view;
+    
+    const nvrhi::TextureDesc& hiZDesc = culling.hiZTexture->getDesc();
+    CullingConstants constants = {};
+    std::memcpy(constants.viewProj, culling.view.viewProj, sizeof(constants.viewProj));
+    std::memcpy(constants.prevViewProj, culling.view.prevViewProj, sizeof(constants.prevViewProj));
+    std::memcpy(constants.frustumPlanes, culling.view.frustumPlanes, sizeof(constants.frustumPlanes));
+    constants.instanceCount = instanceCount;
+    constants.hiZMipCount = hiZDesc.mipLevels;
+    constants.hiZSize[0] = hiZDesc.width;
+    constants.hiZSize[1] = hiZDesc.height;
+    constants.occlusionEnabled = culling.hiZValid ? 1 : 0;
+    m_commandList->writeBuffer(culling.constantBuffer, &constants, sizeof(constants));
+    
+    // Zero the instance count, then every visible instance appends itself
+    InstancingConstants drawArgs = {};
+    drawArgs.vertexCount = static_cast<uint32_t>(g_TriangleVertices.size());
+    
+    nvrhi::ComputeState computeState;
+    computeState.pipeline = m_drawArgsPipeline;
+    computeState.bindings = { m_drawArgsSet };
+    m_commandList->setComputeState(computeState);
+    m_commandList->setPushConstants(&drawArgs, sizeof(drawArgs));
+    m_commandList->dispatch(1);
+    
+    computeState.pipeline = culling.cullingPipeline;
+    computeState.bindings = { culling.cullingSet };
+    m_commandList->setComputeState(computeState);
+    m_commandList->dispatch((instanceCount + 63) / 64);
+    
+    nvrhi::IFramebuffer* framebuffer = getDepthFramebuffer();
+    nvrhi::utils::ClearColorAttachment(m_commandList, framebuffer, 0, nvrhi::Color(0.1f, 0.1f, 0.2f, 1.0f));
+    nvrhi::utils::ClearDepthStencilAttachment(m_commandList, framebuffer, 1.0f, 0);
+    
+    nvrhi::GraphicsState state = {};
+    state.pipeline = culling.pipeline;
+    state.framebuffer = framebuffer;
+    state.viewport.addViewportAndScissorRect(nvrhi::Viewport(float(hiZDesc.width), float(hiZDesc.height)));
+    state.bindings = { culling.drawSet };
+    state.addVertexBuffer(nvrhi::VertexBufferBinding()
+        .setBuffer(m_vertexBuffer)
+        .setSlot(0)
+        .setOffset(0));
+    state.indirectParams = m_drawArgsBuffer;
+    m_commandList->setGraphicsState(state);
+    m_commandList->drawIndirect(0);
+    
+    // This frame's depth is the next frame's occlusion test
+    uint32_t sourceWidth = hiZDesc.width;
+    uint32_t sourceHeight = hiZDesc.height;
+    computeState.pipeline = culling.hiZPipeline;
+    for (uint32_t mip = 0; mip < hiZDesc.mipLevels; mip++)
+    {
+        HiZConstants hiZConstants = {};
+        hiZConstants.sourceSize[0] = sourceWidth;
+        hiZConstants.sourceSize[1] = sourceHeight;
+        hiZConstants.destSize[0] = std::max(1u, hiZDesc.width >> mip);
+        hiZConstants.destSize[1] = std::max(1u, hiZDesc.height >> mip);
+        
+        computeState.bindings = { culling.hiZSets[mip] };
+        m_commandList->setComputeState(computeState);
+        m_commandList->setPushConstants(&hiZConstants, sizeof(hiZConstants));
+        m_commandList->dispatch((hiZConstants.destSize[0] + 7) / 8, (hiZConstants.destSize[1] + 7) / 8);
+        
+        sourceWidth = hiZConstants.destSize[0];
+        sourceHeight = hiZConstants.destSize[1];
+    }
+    culling.hiZValid = true;
+    
+    // Arguments of the first frame at offset 0; later frames overwrite the last frame's at 16
+    uint32_t readbackOffset = culling.framesSinceReset == 0 ? 0 : sizeof(uint32_t) * 4;
+    m_commandList->copyBuffer(culling.readbackBuffer, readbackOffset, m_drawArgsBuffer, 0, sizeof(uint32_t) * 4);
+    culling.framesSinceReset++;
+}
+
+nvrhi::IFramebuffer* TriangleApp::getDepthFramebuffer()
+{
+    // Swap chain framebuffers have no depth, so each back buffer gets a second one
+    uint32_t index = m_deviceManager->getCurrentBackBufferIndex();
+    nvrhi::ITexture* backBuffer = m_deviceManager->getCurrentBackBuffer();
+    if (m_culling.framebuffers.size() <= index)
+        m_culling.framebuffers.resize(index + 1);
+    
+    // Resizing replaces the back buffers
+    nvrhi::FramebufferHandle& framebuffer = m_culling.framebuffers[index];
+    if (!framebuffer || framebuffer->getDesc().colorAttachments[0].texture != backBuffer)
+    {
+        framebuffer = m_deviceManager->getDevice()->createFramebuffer(nvrhi::FramebufferDesc()
+            .addColorAttachment(backBuffer)
+            .setDepthAttachment(m_culling.depthTexture));
+    }
+    return framebuffer;
+}
+
+void TriangleApp::updateWindowTitle()
+{
+    double currentTime = glfwGetTime();
+    m_frameCount++;
+    
+    // Update FPS every 0.5 seconds
+    double elapsed = currentTime - m_lastTitleUpdateTime;
+    if (elapsed >= 0.5)
+    {
+        m_fps = m_frameCount / elapsed;
+        m_frameCount = 0;
+        m_lastTitleUpdateTime = currentTime;
+        
+        // Build window title with API and FPS
+        std::ostringstream title;
+        title << "["  << m_deviceManager->getGraphicsAPIName() << "] "
+              << "NVRHI Triangle Demo - "
+              << std::fixed << std::setprecision(1) << m_fps << " FPS";
+        
+        glfwSetWindowTitle(m_window, title.str().c_str());
+    }
+}
+
+void TriangleApp::mainLoop()
+{
+    if (m_options.headless)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < m_options.headlessFrames; frame++)
+        {
+            render();
+        }
+        m_deviceManager->waitForIdle();
+        
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Rendered " << m_options.headlessFrames << " headless frames in "
+                  << std::fixed << std::setprecision(3) << elapsed * 1000.0 << " ms" << std::endl;
+        return;
+    }
+    
+    // Initialize timing
+    m_lastTime = glfwGetTime();
+    m_lastTitleUpdateTime = m_lastTime;
+    m_frameCount = 0;
+    
+    while (!glfwWindowShouldClose(m_window))
+    {
+        if(glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(m_window, true);
+        
+        // 1-3 switch the pixel shader permutation
+        for (uint32_t shadeMode = 0; shadeMode < 3; shadeMode++)
+        {
+            if (shadeMode != m_shadeMode && glfwGetKey(m_window, GLFW_KEY_1 + int(shadeMode)) == GLFW_PRESS)
+                setShadeMode(shadeMode);
+        }
+        glfwPollEvents();
+        updateExtraWindows();
+        render();
+        updateWindowTitle();
+    }
+    
+    // Wait for GPU before cleanup
+    m_deviceManager->waitForIdle();
+}
+
+ResizeStormStats TriangleApp::runResizeStormBenchmark(uint32_t frameCount)
+{
+    const int baseWidth = m_windowWidth;
+    const int baseHeight = m_windowHeight;
+    const uint32_t resizesBefore = m_resizeCount;
+    
+    double totalTime = 0.0;
+    double worstTime = 0.0;
+    uint32_t renderedFrames = 0;
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        // Sweep the size back and forth so every frame sees a new extent
+        int step = int(frame % 32);
+        int offset = (step < 16 ? step : 32 - step) * 16;
+        int width = baseWidth - offset;
+        int height = baseHeight - offset / 2;
+        
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwSetWindowSize(m_window, width, height);
+            glfwPollEvents();
+        }
+        else
+        {
+            m_windowWidth = width;
+            m_windowHeight = height;
+            m_windowResized = true;
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        render();
+        double frameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        
+        totalTime += frameTime;
+        worstTime = std::max(worstTime, frameTime);
+        renderedFrames++;
+    }
+    
+    m_deviceManager->waitForIdle();
+    
+    ResizeStormStats stats;
+    if (renderedFrames > 0)
+    {
+        stats.averageFrameTimeMs = totalTime / renderedFrames;
+        stats.worstFrameTimeMs = worstTime;
+        stats.resizeCount = m_resizeCount - resizesBefore;
+    }
+    return stats;
+}
+
+UploadStreamingStats TriangleApp::runUploadStreamingBenchmark(uint32_t textureCount, bool background)
+{
+    constexpr uint32_t textureSize = 1024;
+    const size_t rowPitch = textureSize * 4;
+    
+    nvrhi::TextureDesc textureDesc;
+    textureDesc.width = textureSize;
+    textureDesc.height = textureSize;
+    textureDesc.format = nvrhi::Format::RGBA8_UNORM;
+    textureDesc.initialState = background ? m_uploadService->getTextureState() : nvrhi::ResourceStates::ShaderResource;
+    textureDesc.keepInitialState = true;
+    textureDesc.debugName = "StreamedTexture";
+    
+    // Stand-in for decoded asset data
+    std::vector<uint8_t> pixels(rowPitch * textureSize);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = uint8_t(i * 7);
+    }
+    
+    std::vector<nvrhi::TextureHandle> textures;
+    std::atomic<uint64_t> lastTicket = 0;
+    std::atomic<bool> allQueued = false;
+    std::thread loader;
+    
+    if (background)
+    {
+        // Assets are created and queued from a loader thread, as a streaming system would
+        textures.resize(textureCount);
+        loader = std::thread([this, &textures, &textureDesc, &pixels, &lastTicket, &allQueued, rowPitch]()
+        {
+            for (nvrhi::TextureHandle& texture : textures)
+            {
+                texture = m_deviceManager->getDevice()->createTexture(textureDesc);
+                lastTicket = m_uploadService->uploadTexture(texture, pixels, rowPitch);
+            }
+            allQueued = true;
+        });
+    }
+    
+    double totalTime = 0.0;
+    double worstTime = 0.0;
+    uint32_t renderedFrames = 0;
+    double uploadTime = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    
+    for (;;)
+    {
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwPollEvents();
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        
+        if (!background && textures.size() < textureCount)
+        {
+            // The old path: one texture per frame on the graphics list, then drain the GPU
+            nvrhi::TextureHandle texture = m_deviceManager->getDevice()->createTexture(textureDesc);
+            m_commandList->open();
+            m_commandList->writeTexture(texture, 0, 0, pixels.data(), rowPitch);
+            m_commandList->close();
+            m_deviceManager->executeCommandList(m_commandList);
+            m_deviceManager->waitForIdle();
+            textures.push_back(texture);
+        }
+        
+        render();
+        
+        auto frameEnd = std::chrono::steady_clock::now();
+        double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        totalTime += frameTime;
+        worstTime = std::max(worstTime, frameTime);
+        renderedFrames++;
+        
+        bool done = background
+            ? allQueued && m_uploadService->isComplete(lastTicket)
+            : textures.size() == textureCount;
+        if (done)
+        {
+            uploadTime = std::chrono::duration<double, std::milli>(frameEnd - start).count();
+            break;
+        }
+    }
+    
+    if (loader.joinable())
+        loader.join();
+    m_uploadService->flush();
+    m_deviceManager->waitForIdle();
+    
+    UploadStreamingStats stats;
+    if (renderedFrames > 0)
+    {
+        stats.averageFrameTimeMs = totalTime / renderedFrames;
+        stats.worstFrameTimeMs = worstTime;
+        stats.uploadTimeMs = uploadTime;
+        stats.frameCount = renderedFrames;
+    }
+    return stats;
+}
+
+ResourceChurnStats TriangleApp::runResourceChurnBenchmark(uint32_t frameCount, bool deferred)
+{
+    common::DeletionQueue& deletionQueue = m_deviceManager->getDeletionQueue();
+    const common::DeletionQueue::Stats statsBefore = deletionQueue.getStats();
+    
+    nvrhi::BufferDesc bufferDesc = {};
+    bufferDesc.byteSize = sizeof(Vertex) * g_TriangleVertices.size();
+    bufferDesc.isVertexBuffer = true;
+    bufferDesc.canHaveRawViews = true;
+    bufferDesc.initialState = nvrhi::ResourceStates::VertexBuffer;
+    bufferDesc.keepInitialState = true;
+    bufferDesc.debugName = "ChurnVertexBuffer";
+    
+    ResourceChurnStats stats;
+    double totalTime = 0.0;
+    uint32_t renderedFrames = 0;
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwPollEvents();
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        
+        // A fresh buffer replaces the one the previous frames drew from
+        nvrhi::BufferHandle vertexBuffer = m_deviceManager->getDevice()->createBuffer(bufferDesc);
+        if (!vertexBuffer)
+            break;
+        m_commandList->open();
+        m_commandList->writeBuffer(vertexBuffer, g_TriangleVertices.data(), bufferDesc.byteSize);
+        m_commandList->close();
+        m_deviceManager->executeCommandList(m_commandList);
+        
+        if (deferred)
+        {
+            deletionQueue.release(m_vertexBuffer);
+        }
+        else
+        {
+            // The old path: nothing may be in flight when the last reference goes away
+            m_deviceManager->waitForIdle();
+        }
+        m_resourceAllocator->release(m_vertexBuffer);
+        m_vertexBuffer = vertexBuffer;
+        
+        // The table keeps the old buffer until the frames drawing from it retire
+        if (m_bindlessTable)
+        {
+            m_bindlessTable->release(m_vertexBufferIndex);
+            m_vertexBufferIndex = m_bindlessTable->addBuffer(m_vertexBuffer);
+        }
+        
+        render();
+        
+        double frameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        totalTime += frameTime;
+        stats.worstFrameTimeMs = std::max(stats.worstFrameTimeMs, frameTime);
+        renderedFrames++;
+        
+        common::DeletionQueue::Stats queueStats = deletionQueue.getStats();
+        stats.peakPendingObjects = std::max(stats.peakPendingObjects, queueStats.pendingObjects);
+        stats.peakPendingBytes = std::max(stats.peakPendingBytes, queueStats.pendingBytes);
+    }
+    
+    m_deviceManager->waitForIdle();
+    deletionQueue.update();
+    
+    if (renderedFrames > 0)
+    {
+        stats.averageFrameTimeMs = totalTime / renderedFrames;
+    }
+    stats.releasedObjects = deletionQueue.getStats().releasedObjects - statsBefore.releasedObjects;
+    return stats;
+}
+
+FramePacingStats TriangleApp::runFramePacingBenchmark(uint32_t frameCount)
+{
+    common::FrameTracker& frameTracker = m_deviceManager->getFrameTracker();
+    
+    // Frames whose GPU completion has not been observed yet
+    struct PendingFrame
+    {
+        uint64_t frameId;
+        double startTime;
+    };
+    std::vector<PendingFrame> pending;
+    
+    auto now = []()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    
+    double totalLatency = 0.0;
+    uint32_t completedFrames = 0;
+    
+    auto retireFrames = [&](bool wait)
+    {
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            bool retired = wait ? frameTracker.waitForFrame(it->frameId) : frameTracker.isFrameRetired(it->frameId);
+            if (!retired)
+            {
+                ++it;
+                continue;
+            }
+            
+            totalLatency += now() - it->startTime;
+            completedFrames++;
+            it = pending.erase(it);
+        }
+    };
+    
+    double benchmarkStart = now();
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwPollEvents();
+        }
+        
+        double frameStart = now();
+        render();
+        pending.push_back({ frameTracker.getCurrentFrameId(), frameStart });
+        
+        retireFrames(false);
+    }
+    
+    double elapsed = now() - benchmarkStart;
+    retireFrames(true);
+    m_deviceManager->waitForIdle();
+    
+    FramePacingStats stats;
+    if (completedFrames > 0 && elapsed > 0.0)
+    {
+        stats.averageFrameTimeMs = elapsed * 1000.0 / completedFrames;
+        stats.averageLatencyMs = totalLatency * 1000.0 / completedFrames;
+        stats.framesPerSecond = completedFrames / elapsed;
+    }
+    return stats;
+}
+
+DrawScalingStats TriangleApp::runDrawScalingBenchmark(uint32_t threadCount, uint32_t drawCount, uint32_t frameCount)
+{
+    common::ThreadPool workers(threadCount);
+    
+    double totalRecordTime = 0.0;
+    uint32_t renderedFrames = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwPollEvents();
+        }
+        
+        totalRecordTime += renderMultithreaded(workers, threadCount, drawCount);
+        renderedFrames++;
+    }
+    
+    m_deviceManager->waitForIdle();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    DrawScalingStats stats;
+    if (renderedFrames > 0 && elapsed > 0.0)
+    {
+        stats.averageRecordTimeMs = totalRecordTime * 1000.0 / renderedFrames;
+        stats.averageFrameTimeMs = elapsed * 1000.0 / renderedFrames;
+        stats.drawsPerSecond = double(drawCount) * renderedFrames / elapsed;
+    }
+    return stats;
+}
+
+InstancingStats TriangleApp::runInstancingBenchmark(uint32_t instanceCount, uint32_t frameCount, InstancingMode mode)
+{
+    InstancingStats stats;
+    stats.instanceCount = instanceCount;
+    stats.drawCount = mode == InstancingMode::DrawPerInstance ? instanceCount : 1;
+    stats.visibleCount = instanceCount;
+    if (!createInstancingResources(instanceCount))
+        return stats;
+    if (mode == InstancingMode::Culled)
+    {
+        if (!createCullingResources(instanceCount))
+            return stats;
+        m_culling.hiZValid = false;
+        m_culling.framesSinceReset = 0;
+    }
+    
+    double totalRecordTime = 0.0;
+    uint32_t renderedFrames = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        if (m_window)
+        {
+            if (glfwWindowShouldClose(m_window))
+                break;
+            glfwPollEvents();
+        }
+        
+        totalRecordTime += renderInstanced(instanceCount, mode);
+        renderedFrames++;
+    }
+    
+    m_deviceManager->waitForIdle();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (renderedFrames > 0 && elapsed > 0.0)
+    {
+        stats.averageRecordTimeMs = totalRecordTime * 1000.0 / renderedFrames;
+        stats.averageFrameTimeMs = elapsed * 1000.0 / renderedFrames;
+        stats.instancesPerSecond = double(instanceCount) * renderedFrames / elapsed;
+    }
+    
+    // The second word of the draw arguments is the visible count
+    if (mode == InstancingMode::Culled && m_culling.readbackBuffer && m_culling.framesSinceReset > 0)
+    {
+        nvrhi::IDevice* device = m_deviceManager->getDevice();
+        if (const uint32_t* counts = static_cast<const uint32_t*>(device->mapBuffer(m_culling.readbackBuffer, nvrhi::CpuAccessMode::Read)))
+        {
+            stats.firstFrameVisible = counts[1];
+            stats.visibleCount = m_culling.framesSinceReset > 1 ? counts[5] : counts[1];
+            device->unmapBuffer(m_culling.readbackBuffer);
+        }
+        
+        std::vector<InstanceData> instances = createInstanceGrid(instanceCount);
+        std::vector<common::BoundingSphere> spheres(instanceCount);
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            std::copy(std::begin(instances[i].position), std::end(instances[i].position), spheres[i].center);
+            spheres[i].radius = instances[i].radius;
+        }
+        std::vector<uint32_t> visible;
+        common::cullInstances(m_culling.firstView, nullptr, spheres, visible);
+        stats.referenceVisible = static_cast<uint32_t>(visible.size());
+    }
+    return stats;
+}
+
+bool TriangleApp::createDeviceResources()
+{
+    // Create command list
+    m_commandList = m_deviceManager->createCommandList();
+    if (!m_commandList)
+    {
+        std::cerr << "Failed to create command list" << std::endl;
+        return false;
+    }
+    
+    if (!loadShaders()) return false;
+    if (m_options.bindless && !createBindlessResources()) return false;
+    
+    // Pipeline creation is where a warm pipeline cache pays off
+    auto pipelineStart = std::chrono::steady_clock::now();
+    if (!createPipeline()) return false;
+    double pipelineMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - pipelineStart).count();
+    std::cout << "Pipeline creation: " << pipelineMs << " ms ("
+              << (m_deviceManager->isPipelineCacheWarm() ? "warm" : "cold") << " pipeline cache)" << std::endl;
+    
+    // Startup creation is not a frame hitch
+    m_pipelineCache->takeFrameStats();
+    
+    m_uploadRing = std::make_unique<common::UploadRing>(*m_deviceManager);
+    if (!m_uploadRing->getBuffer()) return false;
+    if (m_bindlessTable)
+    {
+        m_uploadRingIndex = m_bindlessTable->addBuffer(m_uploadRing->getBuffer());
+        if (m_uploadRingIndex == common::BindlessTable::InvalidIndex) return false;
+    }
+    
+    m_uploadService = std::make_unique<common::UploadService>(*m_deviceManager);
+    m_resourceAllocator = std::make_unique<common::ResourceAllocator>(*m_deviceManager);
+    m_transientTextures = std::make_unique<common::TransientTexturePool>(*m_deviceManager);
+    m_renderGraph.setTransientState(m_transientTextures->getTransientState());
+    
+    return createVertexBuffer();
+}
+
+void TriangleApp::releaseDeviceResources()
+{
+    m_commandListPool.reset();
+    m_culling = {};
+    m_instancingSet = nullptr;
+    m_drawArgsSet = nullptr;
+    m_instanceBuffer = nullptr;
+    m_drawArgsBuffer = nullptr;
+    m_instanceCapacity = 0;
+    m_instancedPipeline = nullptr;
+    m_drawArgsPipeline = nullptr;
+    m_instancingLayout = nullptr;
+    m_drawArgsLayout = nullptr;
+    m_vertexBuffer = nullptr;
+    m_renderGraph.clear();
+    m_transientTextures.reset();
+    m_resourceAllocator.reset();
+    m_vertexBufferIndex = common::BindlessTable::InvalidIndex;
+    m_uploadRingIndex = common::BindlessTable::InvalidIndex;
+    m_bindlessConstantsSet = nullptr;
+    m_bindlessConstantsLayout = nullptr;
+    m_bindlessTable.reset();
+    m_uploadService.reset();
+    m_uploadRing.reset();
+    m_prewarmThreads.reset();
+    m_pipelineCache.reset();
+    m_pipeline = nullptr;
+    m_inputLayout = nullptr;
+    m_pixelShader = nullptr;
+    m_vertexShader = nullptr;
+    m_shaderSets.clear();
+    m_shaderLibrary.reset();
+    m_commandList = nullptr;
+}
+
+void TriangleApp::cleanup()
+{
+    // Release everything created from the device, reporting pipeline cache usage first
+    if (m_pipelineCache)
+    {
+        common::PipelineCache::Stats pipelineStats = m_pipelineCache->getStats();
+        std::cout << "Pipeline cache: " << m_pipelineCache->getPipelineCount() << " pipelines, "
+                  << pipelineStats.hits << " hits, " << pipelineStats.misses << " misses, "
+                  << pipelineStats.prewarmed << " prewarmed" << std::endl;
+    }
+    releaseDeviceResources();
+    destroyExtraWindows();
+    
+    // Destroy device manager
+    if (m_deviceManager)
+    {
+        common::DeviceRecoveryStats recoveryStats = m_deviceManager->getDeviceRecoveryStats();
+        if (recoveryStats.deviceLostCount > 0)
+        {
+            std::cout << "Device lost " << recoveryStats.deviceLostCount << " times, recovered "
+                      << recoveryStats.recoveredCount << " times, average recovery "
+                      << (recoveryStats.recoveredCount > 0 ? recoveryStats.totalRecoveryTimeMs / recoveryStats.recoveredCount : 0.0)
+                      << " ms" << std::endl;
+        }
+        
+        common::FrameCapture& frameCapture = m_deviceManager->getFrameCapture();
+        frameCapture.flush();
+        if (frameCapture.getFramesWritten() > 0 || frameCapture.getFramesFailed() > 0)
+        {
+            std::cout << "Captured " << frameCapture.getFramesWritten() << " frames ("
+                      << frameCapture.getFramesFailed() << " failed)" << std::endl;
+        }
+        
+        m_deviceManager->destroyDevice();
+        m_deviceManager.reset();
+    }
+    
+    // Cleanup GLFW
+    if (m_window)
+    {
+        glfwDestroyWindow(m_window);
+        m_window = nullptr;
+        glfwTerminate();
+    }
+}
+
+// Parse command line arguments
+AppOptions parseCommandLine(int argc, char* argv[])
+{
+    AppOptions options;
+    
+    // Default to D3D12 on Windows, Vulkan otherwise
+#ifdef _WIN32
+    options.api = common::GraphicsAPI::D3D12;
+#else
+    options.api = common::GraphicsAPI::Vulkan;
+#endif
+    
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-d3d12" || arg == "--d3d12" || arg == "-dx12")
+        {
+            options.api = common::GraphicsAPI::D3D12;
+        }
+        else if (arg == "-vulkan" || arg == "--vulkan" || arg == "-vk")
+        {
+            options.api = common::GraphicsAPI::Vulkan;
+        }
+        else if (arg == "--frames-in-flight" && i + 1 < argc)
+        {
+            options.maxFramesInFlight = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--no-vsync")
+        {
+            options.presentMode = common::PresentMode::Immediate;
+        }
+        else if (arg == "--present-mode" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "fifo")
+                options.presentMode = common::PresentMode::Fifo;
+            else if (mode == "fifo-relaxed")
+                options.presentMode = common::PresentMode::FifoRelaxed;
+            else if (mode == "mailbox")
+                options.presentMode = common::PresentMode::Mailbox;
+            else if (mode == "immediate")
+                options.presentMode = common::PresentMode::Immediate;
+            else
+                std::cerr << "Unknown present mode " << mode << ", using fifo" << std::endl;
+        }
+        else if (arg == "--max-fps" && i + 1 < argc)
+        {
+            options.maxFrameRate = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--animate")
+        {
+            options.animate = true;
+        }
+        else if (arg == "--simulate-device-lost" && i + 1 < argc)
+        {
+            options.deviceLostInterval = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--bindless")
+        {
+            options.bindless = true;
+        }
+        else if (arg == "--windows" && i + 1 < argc)
+        {
+            options.windowCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            options.headlessFrames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--capture" && i + 1 < argc)
+        {
+            options.capturePath = argv[++i];
+        }
+        else if (arg == "--capture-sequence" && i + 1 < argc)
+        {
+            std::string pattern = argv[++i];
+            std::string path;
+            if (common::FrameCapture::formatSequencePath(pattern, 0, path))
+                options.captureSequencePattern = pattern;
+            else
+                std::cerr << "Capture sequence pattern needs exactly one %u or %d conversion, ignoring " << pattern << std::endl;
+        }
+        else if (arg == "--benchmark-frames-in-flight")
+        {
+            options.benchmarkFramesInFlight = true;
+        }
+        else if (arg == "--benchmark-resize")
+        {
+            options.benchmarkResize = true;
+        }
+        else if (arg == "--benchmark-upload" && i + 1 < argc)
+        {
+            options.benchmarkUploadMB = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--benchmark-churn")
+        {
+            options.benchmarkChurn = true;
+        }
+        else if (arg == "--benchmark-allocator")
+        {
+            options.benchmarkAllocator = true;
+        }
+        else if (arg == "--benchmark-instances" && i + 1 < argc)
+        {
+            options.benchmarkInstances = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--benchmark-culling")
+        {
+            options.benchmarkCulling = true;
+        }
+        else if (arg == "--benchmark-render-graph" && i + 1 < argc)
+        {
+            options.benchmarkRenderGraph = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--adapter" && i + 1 < argc)
+        {
+            options.adapter = argv[++i];
+        }
+        else if (arg == "--list-adapters")
+        {
+            options.listAdapters = true;
+        }
+        else if (arg == "--no-validation")
+        {
+            options.validation = false;
+        }
+        else if (arg == "--pipeline-cache-dir" && i + 1 < argc)
+        {
+            options.pipelineCacheDirectory = argv[++i];
+        }
+        else if (arg == "--no-pipeline-cache")
+        {
+            options.pipelineCacheDirectory.clear();
+        }
+        else if (arg == "--shader-cache-dir" && i + 1 < argc)
+        {
+            options.shaderCacheDirectory = argv[++i];
+        }
+        else if (arg == "--shade-mode" && i + 1 < argc)
+        {
+            options.shadeMode = static_cast<uint32_t>(std::clamp(std::atoi(argv[++i]), 0, 2));
+        }
+        else if (arg == "--compile-all-shaders")
+        {
+            options.compileAllShaders = true;
+        }
+        else if (arg == "--benchmark-threads" && i + 1 < argc)
+        {
+            options.benchmarkThreads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--benchmark-draws" && i + 1 < argc)
+        {
+            options.benchmarkDraws = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--benchmark-frames" && i + 1 < argc)
+        {
+            options.benchmarkFrames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
         }
         else if (arg == "-h" || arg == "--help")
         {
             std::cout << "NVRHI Triangle Demo" << std::endl;
             std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
             std::cout << "Options:" << std::endl;
-            std::cout << "  -d3d12, --d3d12, -dx12    Use D3D12 backend (Windows only)" << std::endl;
-            std::cout << "  -vulkan, --vulkan, -vk    Use Vulkan backend" << std::endl;
-            std::cout << "  -h, --help                Show this help message" << std::endl;
+            std::cout << "  -d3d12, --d3d12, -dx12         Use D3D12 backend (Windows only)" << std::endl;
+            std::cout << "  -vulkan, --vulkan, -vk         Use Vulkan backend" << std::endl;
+            std::cout << "  --frames-in-flight <n>         Frames the CPU may queue ahead of the GPU (default 2)" << std::endl;
+            std::cout << "  --no-vsync                     Disable vertical sync (same as --present-mode immediate)" << std::endl;
+            std::cout << "  --present-mode <mode>          fifo, fifo-relaxed, mailbox or immediate (default fifo)" << std::endl;
+            std::cout << "  --max-fps <n>                  Cap the frame rate, waiting for presentation where supported" << std::endl;
+            std::cout << "  --adapter <index|name>         GPU to use, by index or part of its name (e.g. llvmpipe)" << std::endl;
+            std::cout << "  --list-adapters                Print a JSON report of the available GPUs and exit" << std::endl;
+            std::cout << "  --headless                     Render offscreen without a window (Vulkan only)" << std::endl;
+            std::cout << "  --bindless                     Fetch vertices through a bindless descriptor table" << std::endl;
+            std::cout << "  --windows <n>                  Render to n windows sharing one device and present (default 1)" << std::endl;
+            std::cout << "  --frames <n>                   Frames rendered in headless mode (default 100)" << std::endl;
+            std::cout << "  --animate                      Rotate the triangle with per-frame vertex uploads" << std::endl;
+            std::cout << "  --simulate-device-lost <n>     Simulate a device loss every n frames and recover from it" << std::endl;
+            std::cout << "  --capture <file>               Write the first frame to a .png or .exr file" << std::endl;
+            std::cout << "  --capture-sequence <pattern>   Write every frame, e.g. capture/frame_%05u.png" << std::endl;
+            std::cout << "  --benchmark-frames-in-flight   Compare frame time and latency for 1..3 frames in flight" << std::endl;
+            std::cout << "  --benchmark-resize             Resize every frame and report average and worst frame time" << std::endl;
+            std::cout << "  --benchmark-upload <MB>        Compare streaming textures on the graphics and transfer queues" << std::endl;
+            std::cout << "  --benchmark-churn              Replace a buffer every frame, draining the GPU vs the deletion queue" << std::endl;
+            std::cout << "  --benchmark-allocator          Time the heap sub-allocator on the CPU, no GPU needed" << std::endl;
+            std::cout << "  --benchmark-instances <n>      Compare n triangle instances in one indirect draw to one draw each" << std::endl;
+            std::cout << "  --benchmark-culling            Time the CPU reference of GPU culling, no GPU needed" << std::endl;
+            std::cout << "  --benchmark-render-graph <n>   Time the render graph compiler on n passes, no GPU needed" << std::endl;
+            std::cout << "  --benchmark-threads <n>        Compare draw recording on 1..n threads" << std::endl;
+            std::cout << "  --benchmark-draws <n>          Draw calls per frame for --benchmark-threads (default 10000)" << std::endl;
+            std::cout << "  --benchmark-frames <n>         Frames rendered per benchmark run (default 1000)" << std::endl;
+            std::cout << "  --no-validation                Disable the NVRHI validation layer" << std::endl;
+            std::cout << "  --pipeline-cache-dir <dir>     Directory of the Vulkan pipeline cache (default cache)" << std::endl;
+            std::cout << "  --no-pipeline-cache            Start with a cold pipeline cache and do not save it" << std::endl;
+            std::cout << "  --shader-cache-dir <dir>       Directory of compiled shader binaries (default cache/shaders)" << std::endl;
+            std::cout << "  --shade-mode <n>               0 = vertex color, 1 = grayscale, 2 = inverted" << std::endl;
+            std::cout << "  --compile-all-shaders          Build every shader permutation in parallel at startup" << std::endl;
+            std::cout << "  -h, --help                     Show this help message" << std::endl;
             std::exit(0);
         }
     }
     
-    return defaultAPI;
+    return options;
 }
 
 int main(int argc, char* argv[])
 {
-    common::GraphicsAPI api = parseCommandLine(argc, argv);
+    AppOptions options = parseCommandLine(argc, argv);
+    
+    // Machine-readable output only, so scripts can parse stdout directly
+    if (options.listAdapters)
+    {
+        std::unique_ptr<common::IDeviceManager> deviceManager = common::createDeviceManager(options.api);
+        if (!deviceManager)
+            return -1;
+        common::writeAdapterReport(std::cout, options.api, deviceManager->enumerateAdapters());
+        return 0;
+    }
     
     std::cout << "NVRHI Triangle Demo" << std::endl;
-    std::cout << "Selected API: " << common::graphicsAPIToString(api) << std::endl;
+    
+    // CPU only, before any device is created
+    if (options.benchmarkAllocator)
+    {
+        return runAllocatorBenchmark();
+    }
+    if (options.benchmarkCulling)
+    {
+        return runCullingBenchmark();
+    }
+    if (options.benchmarkRenderGraph > 0)
+    {
+        return runRenderGraphBenchmark(options.benchmarkRenderGraph);
+    }
+    
+    std::cout << "Selected API: " << common::graphicsAPIToString(options.api) << std::endl;
+    
+    if (options.benchmarkFramesInFlight)
+    {
+        return runFramesInFlightBenchmark(options);
+    }
+    if (options.benchmarkThreads > 0)
+    {
+        return runDrawScalingBenchmark(options);
+    }
+    if (options.benchmarkResize)
+    {
+        return runResizeStormBenchmark(options);
+    }
+    if (options.benchmarkUploadMB > 0)
+    {
+        return runUploadStreamingBenchmark(options);
+    }
+    if (options.benchmarkChurn)
+    {
+        return runResourceChurnBenchmark(options);
+    }
+    if (options.benchmarkInstances > 0)
+    {
+        return runInstancingBenchmark(options);
+    }
     
     TriangleApp app;
     
-    if (!app.initialize(api))
+    if (!app.initialize(options))
     {
         std::cerr << "Failed to initialize application" << std::endl;
         return -1;
     }
     
-    std::cout << "Press Escape or close window to exit." << std::endl;
+    if (!options.headless)
+    {
+        std::cout << "Press Escape or close window to exit." << std::endl;
+    }
     
     app.mainLoop();
     app.cleanup();
@@ -0,0 +1,222 @@
+// InstanceCullingTests.cpp
+// Frustum and HiZ occlusion tests of the CPU culling reference, which the GPU pass mirrors
+
+#include "Tests.h"
+
+#include <InstanceCulling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace tests
+{
+
+static const char* const suiteName = "InstanceCulling";
+
+static common::BoundingSphere sphere(float x, float y, float z, float radius)
+{
+    return common::BoundingSphere{ { x, y, z }, radius };
+}
+
+// An orthographic camera: clip = world * zoom + pan, depth = z
+static void orthographic(float zoom, float panX, float panY, float* matrix)
+{
+    const float values[16] = {
+        zoom, 0.0f, 0.0f, panX,
+        0.0f, zoom, 0.0f, panY,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    std::copy(std::begin(values), std::end(values), matrix);
+}
+
+// With an identity camera the frustum is the box [-1, 1] x [-1, 1] x [0, 1]
+static bool testFrustum()
+{
+    float identity[16];
+    orthographic(1.0f, 0.0f, 0.0f, identity);
+    common::CullingView view;
+    view.setMatrices(identity, identity);
+    
+    if (!common::isInFrustum(view, sphere(0.0f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere at the center culled");
+    if (!common::isInFrustum(view, sphere(1.05f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere crossing the right plane culled");
+    if (common::isInFrustum(view, sphere(1.2f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere right of the frustum kept");
+    if (common::isInFrustum(view, sphere(0.0f, -1.2f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere below the frustum kept");
+    if (common::isInFrustum(view, sphere(0.0f, 0.0f, -0.2f, 0.1f)))
+        return fail(suiteName, "sphere in front of the near plane kept");
+    if (common::isInFrustum(view, sphere(0.0f, 0.0f, 1.2f, 0.1f)))
+        return fail(suiteName, "sphere behind the far plane kept");
+    return true;
+}
+
+// The far plane, with an occluder at depth 0.2 over the middle half of the screen
+static bool testOcclusion()
+{
+    float identity[16];
+    orthographic(1.0f, 0.0f, 0.0f, identity);
+    common::CullingView view;
+    view.setMatrices(identity, identity);
+    
+    const uint32_t size = 64;
+    std::vector<float> depth(size * size, 1.0f);
+    for (uint32_t y = size / 4; y < size * 3 / 4; y++)
+    {
+        std::fill(depth.begin() + y * size + size / 4, depth.begin() + y * size + size * 3 / 4, 0.2f);
+    }
+    common::HiZPyramid hiZ;
+    hiZ.build(depth.data(), size, size);
+    
+    if (hiZ.getMipCount() != 7 || hiZ.load(0, 0, 6) != 1.0f || hiZ.load(4, 4, 2) != 0.2f)
+        return fail(suiteName, "wrong pyramid levels");
+    if (!common::isOccluded(view, hiZ, sphere(0.0f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere behind the occluder kept");
+    if (common::isOccluded(view, hiZ, sphere(0.0f, 0.0f, 0.1f, 0.05f)))
+        return fail(suiteName, "sphere in front of the occluder culled");
+    if (common::isOccluded(view, hiZ, sphere(0.45f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere past the occluder's edge culled");
+    if (common::isOccluded(view, hiZ, sphere(-0.8f, 0.8f, 0.5f, 0.05f)))
+        return fail(suiteName, "sphere over the background culled");
+    if (common::isOccluded(view, hiZ, sphere(3.0f, 0.0f, 0.5f, 0.1f)))
+        return fail(suiteName, "sphere off screen culled");
+    
+    // cullInstances is both tests together, in ascending order
+    const common::BoundingSphere spheres[] = {
+        sphere(0.0f, 0.0f, 0.5f, 0.1f),     // Occluded
+        sphere(0.0f, 0.0f, 0.1f, 0.05f),    // Visible
+        sphere(1.2f, 0.0f, 0.5f, 0.1f),     // Outside the frustum
+        sphere(-0.8f, 0.8f, 0.5f, 0.05f),   // Visible
+    };
+    std::vector<uint32_t> visible;
+    common::cullInstances(view, &hiZ, spheres, visible);
+    if (visible != std::vector<uint32_t>{ 1, 3 })
+        return fail(suiteName, "cullInstances disagrees with the per-sphere tests");
+    
+    visible.clear();
+    common::cullInstances(view, nullptr, spheres, visible);
+    if (visible != std::vector<uint32_t>{ 0, 1, 3 })
+        return fail(suiteName, "cullInstances without a pyramid culled by occlusion");
+    return true;
+}
+
+// Random buffers of odd sizes, with occluder rectangles in front of the background: every
+// pyramid texel bounds the pixels under it, and a culled sphere is behind every pixel its
+// box covers
+static bool testRandomBuffers()
+{
+    // Fixed seed, so a failure reproduces
+    std::mt19937 random(12345);
+    auto uniform = [&](float low, float high)
+    {
+        return std::uniform_real_distribution<float>(low, high)(random);
+    };
+    
+    const uint32_t trials = 200;
+    const uint32_t spheresPerTrial = 1000;
+    std::vector<float> depth;
+    common::HiZPyramid hiZ;
+    common::CullingView view;
+    uint64_t pyramidTexels = 0;
+    uint64_t sphereCount = 0;
+    uint64_t culledCount = 0;
+    uint64_t hiddenCount = 0;  // Behind every pixel they cover, by brute force
+    
+    for (uint32_t trial = 0; trial < trials; trial++)
+    {
+        uint32_t width = 17 + random() % 300;
+        uint32_t height = 17 + random() % 300;
+        depth.assign(size_t(width) * height, 0.0f);
+        for (float& value : depth)
+        {
+            value = uniform(0.5f, 1.0f);
+        }
+        for (uint32_t rectangle = 0; rectangle < 8; rectangle++)
+        {
+            uint32_t x0 = random() % width;
+            uint32_t y0 = random() % height;
+            uint32_t x1 = x0 + random() % (width - x0);
+            uint32_t y1 = y0 + random() % (height - y0);
+            float occluderDepth = uniform(0.0f, 0.5f);
+            for (uint32_t y = y0; y <= y1; y++)
+            {
+                std::fill(depth.begin() + y * width + x0, depth.begin() + y * width + x1 + 1, occluderDepth);
+            }
+        }
+        hiZ.build(depth.data(), width, height);
+        
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                for (uint32_t mip = 0; mip < hiZ.getMipCount(); mip++)
+                {
+                    uint32_t texelX = std::min(x >> mip, hiZ.getWidth(mip) - 1);
+                    uint32_t texelY = std::min(y >> mip, hiZ.getHeight(mip) - 1);
+                    if (hiZ.load(texelX, texelY, mip) < depth[y * width + x])
+                        return fail(suiteName, "pyramid texel nearer than a pixel under it");
+                }
+            }
+        }
+        pyramidTexels += uint64_t(width) * height;
+        
+        float zoom = uniform(0.5f, 2.0f);
+        float panX = uniform(-0.5f, 0.5f);
+        float panY = uniform(-0.5f, 0.5f);
+        float matrix[16];
+        orthographic(zoom, panX, panY, matrix);
+        view.setMatrices(matrix, matrix);
+        
+        for (uint32_t i = 0; i < spheresPerTrial; i++)
+        {
+            common::BoundingSphere bounds = sphere(uniform(-1.5f, 1.5f), uniform(-1.5f, 1.5f), uniform(0.0f, 1.0f),
+                uniform(0.005f, 0.3f));
+            bool culled = common::isOccluded(view, hiZ, bounds);
+            sphereCount++;
+            
+            float ndcMinX = (bounds.center[0] - bounds.radius) * zoom + panX;
+            float ndcMaxX = (bounds.center[0] + bounds.radius) * zoom + panX;
+            float ndcMinY = (bounds.center[1] - bounds.radius) * zoom + panY;
+            float ndcMaxY = (bounds.center[1] + bounds.radius) * zoom + panY;
+            int x0 = std::max(0, int(std::floor((ndcMinX * 0.5f + 0.5f) * width)));
+            int x1 = std::min(int(width), int(std::ceil((ndcMaxX * 0.5f + 0.5f) * width)));
+            int y0 = std::max(0, int(std::floor((0.5f - ndcMaxY * 0.5f) * height)));
+            int y1 = std::min(int(height), int(std::ceil((0.5f - ndcMinY * 0.5f) * height)));
+            if (x0 >= x1 || y0 >= y1)
+            {
+                if (culled)
+                    return fail(suiteName, "sphere off screen culled");
+                continue;
+            }
+            
+            float minDepth = bounds.center[2] - bounds.radius;
+            bool hidden = true;
+            for (int y = y0; y < y1 && hidden; y++)
+            {
+                for (int x = x0; x < x1 && hidden; x++)
+                    hidden = depth[y * width + x] < minDepth;
+            }
+            
+            if (culled && !hidden)
+                return fail(suiteName, "culled sphere in front of a pixel it covers");
+            culledCount += culled;
+            hiddenCount += hidden;
+        }
+    }
+    
+    std::cout << "  " << pyramidTexels << " pyramid pixels, " << sphereCount << " random spheres ("
+              << culledCount << " of " << hiddenCount << " fully hidden ones culled)" << std::endl;
+    return true;
+}
+
+bool testInstanceCulling()
+{
+    return testFrustum() && testOcclusion() && testRandomBuffers();
+}
+
+} // namespace tests
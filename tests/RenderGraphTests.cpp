@@ -0,0 +1,369 @@
+// RenderGraphTests.cpp
+// Culling, barriers and transient aliasing of the render graph compiler, checked by brute force
+
+#include "Tests.h"
+
+#include <RenderGraph.h>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tests
+{
+
+static const char* const suiteName = "RenderGraph";
+
+using ResourceId = common::RenderGraph::ResourceId;
+using PassId = common::RenderGraph::PassId;
+
+// A small random graph for the brute-force checks: passes read any earlier target, so
+// lifetimes overlap arbitrarily; about a third composite into the back buffer, and compute
+// passes sometimes rewrite an earlier UAV in place, which needs a UAV barrier. Sizes are
+// tiny and varied so aliasing has to fit mismatched textures together.
+static void buildRandomGraph(common::RenderGraph& graph, uint32_t passCount, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    graph.clear();
+    ResourceId backBuffer = graph.importTexture(nullptr, nvrhi::ResourceStates::Present, nvrhi::ResourceStates::Present);
+    
+    std::vector<ResourceId> targets;
+    std::vector<ResourceId> uavs;
+    for (uint32_t i = 0; i < passCount; i++)
+    {
+        PassId pass = graph.addPass("Pass" + std::to_string(i));
+        uint32_t readCount = targets.empty() ? 0 : random() % 3;
+        for (uint32_t read = 0; read < readCount; read++)
+        {
+            graph.read(pass, targets[random() % targets.size()], nvrhi::ResourceStates::ShaderResource);
+        }
+        
+        if (random() % 3 == 0 || i == passCount - 1)
+        {
+            graph.write(pass, backBuffer, nvrhi::ResourceStates::RenderTarget);
+            continue;
+        }
+        
+        bool compute = random() % 2 == 0;
+        if (compute && !uavs.empty() && random() % 3 == 0)
+        {
+            graph.write(pass, uavs[random() % uavs.size()], nvrhi::ResourceStates::UnorderedAccess);
+            continue;
+        }
+        
+        nvrhi::TextureDesc desc;
+        desc.width = 64u << (random() % 3);
+        desc.height = 64u << (random() % 3);
+        desc.format = compute ? nvrhi::Format::RGBA16_FLOAT : nvrhi::Format::RGBA8_UNORM;
+        desc.isRenderTarget = !compute;
+        desc.isUAV = compute;
+        desc.debugName = "Target" + std::to_string(i);
+        
+        ResourceId target = graph.createTexture(desc);
+        graph.write(pass, target, compute ? nvrhi::ResourceStates::UnorderedAccess : nvrhi::ResourceStates::RenderTarget);
+        targets.push_back(target);
+        if (compute)
+            uavs.push_back(target);
+    }
+}
+
+// Check a compiled graph against brute force; returns what is wrong, or nothing. Imported
+// textures must start and end in importedState, and no pass may have side effects.
+static std::string validateGraph(const common::RenderGraph& graph, nvrhi::ResourceStates importedState)
+{
+    const uint32_t passCount = graph.getPassCount();
+    const uint32_t resourceCount = graph.getResourceCount();
+    
+    // Culling: keep passes writing imported textures, then the last earlier writer of
+    // everything a kept pass reads, until nothing changes
+    std::vector<bool> kept(passCount, false);
+    for (PassId pass = 0; pass < passCount; pass++)
+    {
+        for (const common::RenderGraph::Access& access : graph.getAccesses(pass))
+        {
+            if (access.write && !graph.isTransient(access.resource))
+                kept[pass] = true;
+        }
+    }
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (PassId pass = 0; pass < passCount; pass++)
+        {
+            if (!kept[pass])
+                continue;
+            for (const common::RenderGraph::Access& access : graph.getAccesses(pass))
+            {
+                if (access.write)
+                    continue;
+                for (PassId writer = pass; writer-- > 0;)
+                {
+                    auto accesses = graph.getAccesses(writer);
+                    bool writes = std::any_of(accesses.begin(), accesses.end(), [&](const common::RenderGraph::Access& other)
+                    {
+                        return other.write && other.resource == access.resource;
+                    });
+                    if (writes)
+                    {
+                        changed |= !kept[writer];
+                        kept[writer] = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    std::vector<PassId> order;
+    for (PassId pass = 0; pass < passCount; pass++)
+    {
+        if (kept[pass] == graph.isPassCulled(pass))
+            return graph.getPassName(pass) + (kept[pass] ? " culled but needed" : " kept but not needed");
+        if (kept[pass])
+            order.push_back(pass);
+    }
+    if (order != graph.getExecutionOrder())
+        return "execution order is not the declaration order";
+    
+    // Lifetimes in execution order
+    std::vector<uint32_t> firstUse(resourceCount, UINT32_MAX);
+    std::vector<uint32_t> lastUse(resourceCount, 0);
+    for (uint32_t index = 0; index < order.size(); index++)
+    {
+        for (const common::RenderGraph::Access& access : graph.getAccesses(order[index]))
+        {
+            firstUse[access.resource] = std::min(firstUse[access.resource], index);
+            lastUse[access.resource] = index;
+        }
+    }
+    
+    // Memory: aligned, inside the heap, and disjoint from every transient alive at the same time
+    std::vector<ResourceId> transients;
+    for (ResourceId id = 0; id < resourceCount; id++)
+    {
+        if (graph.isTransient(id) && firstUse[id] != UINT32_MAX)
+            transients.push_back(id);
+    }
+    auto overlapsInMemory = [&](ResourceId a, ResourceId b)
+    {
+        uint64_t offsetA = graph.getTransientOffset(a);
+        uint64_t offsetB = graph.getTransientOffset(b);
+        return graph.getHeapKind(a) == graph.getHeapKind(b) &&
+            offsetA < offsetB + graph.getRequirements(b).size && offsetB < offsetA + graph.getRequirements(a).size;
+    };
+    for (ResourceId a : transients)
+    {
+        const nvrhi::MemoryRequirements& requirements = graph.getRequirements(a);
+        uint64_t offset = graph.getTransientOffset(a);
+        if (offset % std::max<uint64_t>(requirements.alignment, 1) != 0 ||
+            offset + requirements.size > graph.getHeapSize(graph.getHeapKind(a)))
+            return graph.getTextureDesc(a).debugName + " is misplaced";
+        
+        for (ResourceId b : transients)
+        {
+            bool aliveTogether = firstUse[a] <= lastUse[b] && firstUse[b] <= lastUse[a];
+            if (a < b && aliveTogether && overlapsInMemory(a, b))
+                return graph.getTextureDesc(a).debugName + " and " + graph.getTextureDesc(b).debugName + " share memory";
+        }
+    }
+    
+    // Barriers: each starts from the state the last one left, none is redundant, and every
+    // pass finds its textures in the states it declared
+    std::vector<nvrhi::ResourceStates> states(resourceCount, nvrhi::ResourceStates::Unknown);
+    std::vector<std::vector<uint32_t>> aliasingBarriers(resourceCount);
+    for (ResourceId id = 0; id < resourceCount; id++)
+    {
+        if (!graph.isTransient(id))
+            states[id] = importedState;
+    }
+    auto applyBarriers = [&](std::span<const common::RenderGraph::Barrier> barriers, uint32_t index) -> std::string
+    {
+        for (const common::RenderGraph::Barrier& barrier : barriers)
+        {
+            if (barrier.before != states[barrier.resource])
+                return "a barrier starts from the wrong state";
+            if (barrier.before == barrier.after && (barrier.after & nvrhi::ResourceStates::UnorderedAccess) == 0)
+                return "a barrier changes nothing";
+            states[barrier.resource] = barrier.after;
+            if (barrier.aliasing)
+                aliasingBarriers[barrier.resource].push_back(index);
+        }
+        return {};
+    };
+    for (uint32_t index = 0; index < order.size(); index++)
+    {
+        std::string failure = applyBarriers(graph.getBarriers(index), index);
+        if (!failure.empty())
+            return failure;
+        for (const common::RenderGraph::Access& access : graph.getAccesses(order[index]))
+        {
+            if ((states[access.resource] & access.state) != access.state)
+                return graph.getPassName(order[index]) + " runs with a texture in the wrong state";
+        }
+    }
+    std::string failure = applyBarriers(graph.getFinalBarriers(), static_cast<uint32_t>(order.size()));
+    if (!failure.empty())
+        return failure;
+    for (ResourceId id = 0; id < resourceCount; id++)
+    {
+        if (!graph.isTransient(id) && firstUse[id] != UINT32_MAX && states[id] != importedState)
+            return "an imported texture does not end in its final state";
+    }
+    
+    // Aliasing: memory a transient takes over was given up by an aliasing barrier after
+    // the previous occupant's last use, directly or through an occupant in between
+    for (ResourceId a : transients)
+    {
+        for (ResourceId b : transients)
+        {
+            if (lastUse[a] >= firstUse[b] || !overlapsInMemory(a, b))
+                continue;
+            bool released = std::any_of(aliasingBarriers[a].begin(), aliasingBarriers[a].end(), [&](uint32_t index)
+            {
+                return index > lastUse[a] && index <= firstUse[b];
+            });
+            if (!released)
+                return graph.getTextureDesc(b).debugName + " takes over memory without an aliasing barrier";
+        }
+    }
+    return {};
+}
+
+// A chain of three same-sized targets into the back buffer, a pass writing a target
+// nothing reads, and a pass reading only that
+static bool testHandMadeGraph()
+{
+    common::RenderGraph graph;
+    graph.setTransientState(nvrhi::ResourceStates::CopyDest);
+    ResourceId backBuffer = graph.importTexture(nullptr, nvrhi::ResourceStates::Present, nvrhi::ResourceStates::Present);
+    nvrhi::TextureDesc targetDesc;
+    targetDesc.width = 256;
+    targetDesc.height = 256;
+    targetDesc.format = nvrhi::Format::RGBA8_UNORM;
+    targetDesc.isRenderTarget = true;
+    ResourceId targets[4];
+    for (ResourceId& target : targets)
+    {
+        target = graph.createTexture(targetDesc);
+    }
+    
+    PassId first = graph.addPass("First");
+    graph.write(first, targets[0], nvrhi::ResourceStates::RenderTarget);
+    PassId unused = graph.addPass("Unused");
+    graph.write(unused, targets[3], nvrhi::ResourceStates::RenderTarget);
+    PassId second = graph.addPass("Second");
+    graph.read(second, targets[0], nvrhi::ResourceStates::ShaderResource);
+    graph.write(second, targets[1], nvrhi::ResourceStates::RenderTarget);
+    PassId third = graph.addPass("Third");
+    graph.read(third, targets[1], nvrhi::ResourceStates::ShaderResource);
+    graph.write(third, targets[2], nvrhi::ResourceStates::RenderTarget);
+    PassId readsUnused = graph.addPass("ReadsUnused");
+    graph.read(readsUnused, targets[3], nvrhi::ResourceStates::ShaderResource);
+    PassId composite = graph.addPass("Composite");
+    graph.read(composite, targets[2], nvrhi::ResourceStates::ShaderResource);
+    graph.write(composite, backBuffer, nvrhi::ResourceStates::RenderTarget);
+    
+    if (!graph.compile())
+        return fail(suiteName, "the hand-made graph does not compile");
+    if (graph.getExecutionOrder() != std::vector<PassId>{ first, second, third, composite })
+        return fail(suiteName, "wrong passes culled");
+    if (graph.isResourceUsed(targets[3]))
+        return fail(suiteName, "a culled pass's target is placed");
+    
+    // Second: targets[0] to ShaderResource and targets[1] from Unknown to RenderTarget in one batch
+    std::span<const common::RenderGraph::Barrier> batch = graph.getBarriers(1);
+    if (batch.size() != 2 || batch[0].resource != targets[0] || batch[0].before != nvrhi::ResourceStates::RenderTarget ||
+        batch[0].after != nvrhi::ResourceStates::ShaderResource || batch[1].resource != targets[1] ||
+        batch[1].after != nvrhi::ResourceStates::RenderTarget)
+    {
+        return fail(suiteName, "wrong barriers before the second pass");
+    }
+    
+    // targets[0] is dead once the second pass ends, so the third target takes its memory
+    uint64_t targetSize = graph.getRequirements(targets[0]).size;
+    if (graph.getTransientOffset(targets[2]) != graph.getTransientOffset(targets[0]))
+        return fail(suiteName, "the third target does not alias the first");
+    if (graph.getHeapSize(common::RenderGraph::HeapKind::RenderTarget) != 2 * targetSize)
+        return fail(suiteName, "wrong heap size");
+    batch = graph.getBarriers(2);
+    bool aliased = std::any_of(batch.begin(), batch.end(), [&](const common::RenderGraph::Barrier& barrier)
+    {
+        return barrier.aliasing && barrier.resource == targets[0] && barrier.after == nvrhi::ResourceStates::CopyDest;
+    });
+    if (!aliased)
+        return fail(suiteName, "no aliasing barrier to the transient state before the third pass");
+    
+    batch = graph.getFinalBarriers();
+    if (batch.size() != 1 || batch[0].resource != backBuffer || batch[0].after != nvrhi::ResourceStates::Present)
+        return fail(suiteName, "the back buffer does not return to Present");
+    
+    std::string problem = validateGraph(graph, nvrhi::ResourceStates::Present);
+    if (!problem.empty())
+        return fail(suiteName, "the hand-made graph: " + problem);
+    return true;
+}
+
+// Two UAV writes in a row need a barrier between them even though the state stays
+static bool testUavBarriers()
+{
+    common::RenderGraph graph;
+    ResourceId output = graph.importTexture(nullptr, nvrhi::ResourceStates::UnorderedAccess);
+    for (int i = 0; i < 2; i++)
+    {
+        graph.write(graph.addPass("Dispatch" + std::to_string(i)), output, nvrhi::ResourceStates::UnorderedAccess);
+    }
+    if (!graph.compile() || graph.getBarriers(0).size() != 1 || graph.getBarriers(1).size() != 1)
+        return fail(suiteName, "no UAV barrier");
+    return true;
+}
+
+// Random graphs of 4 to 32 passes; the same graph compiles the same
+static bool testRandomGraphs()
+{
+    const uint32_t trials = 100;
+    common::RenderGraph graph;
+    common::RenderGraph other;
+    for (uint32_t trial = 0; trial < trials; trial++)
+    {
+        uint32_t seed = 1000 + trial;
+        std::string name = "random graph " + std::to_string(seed);
+        buildRandomGraph(graph, 4 + trial % 29, seed);
+        if (!graph.compile())
+            return fail(suiteName, name + " does not compile");
+        
+        std::string problem = validateGraph(graph, nvrhi::ResourceStates::Present);
+        if (!problem.empty())
+            return fail(suiteName, name + ": " + problem);
+        
+        buildRandomGraph(other, 4 + trial % 29, seed);
+        other.compile();
+        bool same = other.getExecutionOrder() == graph.getExecutionOrder();
+        for (uint32_t index = 0; same && index <= graph.getExecutionOrder().size(); index++)
+        {
+            std::span<const common::RenderGraph::Barrier> a = graph.getBarriers(index);
+            std::span<const common::RenderGraph::Barrier> b = other.getBarriers(index);
+            same = std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto& x, const auto& y)
+            {
+                return x.resource == y.resource && x.before == y.before && x.after == y.after && x.aliasing == y.aliasing;
+            });
+        }
+        for (ResourceId id = 0; same && id < graph.getResourceCount(); id++)
+        {
+            same = graph.getTransientOffset(id) == other.getTransientOffset(id);
+        }
+        if (!same)
+            return fail(suiteName, name + " compiles differently twice");
+    }
+    
+    std::cout << "  " << trials << " random graphs" << std::endl;
+    return true;
+}
+
+bool testRenderGraph()
+{
+    return testHandMadeGraph() && testUavBarriers() && testRandomGraphs();
+}
+
+} // namespace tests
@@ -0,0 +1,23 @@
+// Tests.h
+// CPU-only tests of the common library, one function per suite
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+namespace tests
+{
+    // Each suite prints what it checked and returns false on the first failure
+    bool testTlsfAllocator();
+    bool testInstanceCulling();
+    bool testRenderGraph();
+
+    // Report a failed check; returns false so a suite can return it directly
+    inline bool fail(const std::string& suite, const std::string& message)
+    {
+        std::cerr << "[" << suite << "] FAILED: " << message << std::endl;
+        return false;
+    }
+
+} // namespace tests
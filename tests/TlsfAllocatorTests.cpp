@@ -0,0 +1,157 @@
+// TlsfAllocatorTests.cpp
+// Alignment, disjointness and coalescing of the TLSF allocator
+
+#include "Tests.h"
+
+#include <TlsfAllocator.h>
+
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace tests
+{
+
+static const char* const suiteName = "TlsfAllocator";
+
+using Allocation = common::TlsfAllocator::Allocation;
+
+// Freeing everything must leave the block as one free range
+static bool checkEmpty(const common::TlsfAllocator& allocator, const char* when)
+{
+    common::TlsfAllocator::Stats stats = allocator.getStats();
+    if (!allocator.validate() || !allocator.isEmpty() || allocator.getUsedBytes() != 0 ||
+        stats.freeRangeCount != 1 || stats.largestFreeRange != allocator.getCapacity())
+    {
+        return fail(suiteName, std::string("block not restored ") + when);
+    }
+    return true;
+}
+
+// Filling the block exactly, running out, and merging freed neighbours
+static bool testFillAndMerge()
+{
+    const uint64_t granularity = 256;
+    common::TlsfAllocator allocator(16 * granularity, granularity);
+    
+    std::vector<Allocation> allocations;
+    for (int i = 0; i < 16; i++)
+    {
+        Allocation allocation = allocator.allocate(1);
+        if (!allocation || allocation.size != granularity)
+            return fail(suiteName, "sizes are not rounded up to the granularity");
+        allocations.push_back(allocation);
+    }
+    if (allocator.allocate(1))
+        return fail(suiteName, "allocated from a full block");
+    if (allocator.getFragmentation() != 0.0)
+        return fail(suiteName, "a full block reports fragmentation");
+    
+    // Every other range free: eight separate holes, none large enough for two granules
+    for (int i = 0; i < 16; i += 2)
+    {
+        allocator.free(allocations[i].handle);
+    }
+    if (allocator.getStats().freeRangeCount != 8 || allocator.allocate(2 * granularity))
+        return fail(suiteName, "freed ranges merged with allocated neighbours");
+    
+    // Freeing one range between two holes leaves one hole of three granules
+    allocator.free(allocations[1].handle);
+    if (allocator.getStats().freeRangeCount != 7 || allocator.getStats().largestFreeRange != 3 * granularity)
+        return fail(suiteName, "a freed range did not merge with both neighbours");
+    
+    Allocation merged = allocator.allocate(3 * granularity);
+    if (!merged || merged.offset != 0)
+        return fail(suiteName, "a merged range could not be reused");
+    allocator.free(merged.handle);
+    
+    for (int i = 3; i < 16; i += 2)
+    {
+        allocator.free(allocations[i].handle);
+    }
+    return checkEmpty(allocator, "after freeing a full block");
+}
+
+// Random operations: every allocation aligned, inside the block and disjoint from the
+// others, and every invariant holds along the way
+static bool testRandomOperations()
+{
+    // Fixed seed, so a failure reproduces
+    std::mt19937 random(12345);
+    
+    // Log-uniform sizes from 256 bytes to 1 MB and alignments up to 64 KB, like a mix of
+    // constant buffers, meshes and small textures
+    auto randomSize = [&]()
+    {
+        uint64_t base = 256ull << (random() % 12);
+        return base + random() % base;
+    };
+    auto randomAlignment = [&]()
+    {
+        return 1ull << (random() % 17);
+    };
+    
+    const uint64_t capacity = 256ull << 20;
+    const uint32_t operations = 200000;
+    common::TlsfAllocator allocator(capacity);
+    std::vector<Allocation> live;
+    std::map<uint64_t, uint64_t> ranges;  // Offset to end of each live allocation
+    uint32_t failedAllocations = 0;
+    
+    for (uint32_t op = 0; op < operations; op++)
+    {
+        if (live.empty() || random() % 5 < 3)
+        {
+            uint64_t alignment = randomAlignment();
+            Allocation allocation = allocator.allocate(randomSize(), alignment);
+            if (!allocation)
+            {
+                failedAllocations++;
+                continue;
+            }
+            
+            auto next = ranges.lower_bound(allocation.offset);
+            if (allocation.offset % alignment != 0)
+                return fail(suiteName, "misaligned allocation");
+            if (allocation.offset + allocation.size > capacity)
+                return fail(suiteName, "allocation outside the block");
+            if (next != ranges.end() && next->first < allocation.offset + allocation.size)
+                return fail(suiteName, "overlapping allocations");
+            if (next != ranges.begin() && std::prev(next)->second > allocation.offset)
+                return fail(suiteName, "overlapping allocations");
+            
+            ranges[allocation.offset] = allocation.offset + allocation.size;
+            live.push_back(allocation);
+        }
+        else
+        {
+            size_t index = random() % live.size();
+            allocator.free(live[index].handle);
+            ranges.erase(live[index].offset);
+            live[index] = live.back();
+            live.pop_back();
+        }
+        
+        if (op % 1000 == 0 && !allocator.validate())
+            return fail(suiteName, "invariants broken after operation " + std::to_string(op));
+    }
+    
+    for (const Allocation& allocation : live)
+    {
+        allocator.free(allocation.handle);
+    }
+    if (!checkEmpty(allocator, "after random operations"))
+        return false;
+    
+    std::cout << "  " << operations << " random operations, " << failedAllocations
+              << " allocations did not fit" << std::endl;
+    return true;
+}
+
+bool testTlsfAllocator()
+{
+    return testFillAndMerge() && testRandomOperations();
+}
+
+} // namespace tests
@@ -0,0 +1,44 @@
+// main.cpp
+// Runs the suite named on the command line, or every suite
+
+#include "Tests.h"
+
+#include <iostream>
+#include <string>
+
+struct Suite
+{
+    const char* name;
+    bool (*run)();
+};
+
+static const Suite suites[] = {
+    { "TlsfAllocator", tests::testTlsfAllocator },
+    { "InstanceCulling", tests::testInstanceCulling },
+    { "RenderGraph", tests::testRenderGraph },
+};
+
+int main(int argc, char* argv[])
+{
+    const char* selected = argc > 1 ? argv[1] : nullptr;
+    
+    bool found = false;
+    int failures = 0;
+    for (const Suite& suite : suites)
+    {
+        if (selected && std::string(selected) != suite.name)
+            continue;
+        
+        found = true;
+        std::cout << "[" << suite.name << "]" << std::endl;
+        if (!suite.run())
+            failures++;
+    }
+    
+    if (!found)
+    {
+        std::cerr << "Unknown test suite " << selected << std::endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}